@@ -1,5 +1,6 @@
 #include "dilithium2.hpp"
 #include "bench_helper.hpp"
+#include "runtime.hpp"
 #include <benchmark/benchmark.h>
 
 // Benchmark Dilithium2 key generation algorithm's performance
@@ -33,6 +34,59 @@ dilithium2_keygen(benchmark::State& state)
   state.SetItemsProcessed(state.iterations());
 }
 
+// Benchmark Dilithium2 key generation algorithm's performance, with given
+// masking order, so that overhead of masking can be compared against order 0
+// i.e. unmasked key generation
+template<size_t order>
+inline void
+dilithium2_keygen_masked(benchmark::State& state)
+{
+  using namespace dilithium2;
+
+  std::array<uint8_t, 32> seed{};
+  std::array<uint8_t, PubKeyLen> pubkey{};
+  std::array<uint8_t, SecKeyLen> seckey{};
+
+  prng::prng_t prng;
+  prng.read(seed);
+
+  for (auto _ : state) {
+    dilithium::keygen<k, l, d, η, order>(seed, pubkey, seckey);
+
+    benchmark::DoNotOptimize(seed);
+    benchmark::DoNotOptimize(pubkey);
+    benchmark::DoNotOptimize(seckey);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Benchmark Dilithium2 batch key generation routine's performance, where a
+// batch of N key pairs is generated, lane-sliced, on default thread pool
+inline void
+dilithium2_keygen_batch(benchmark::State& state)
+{
+  const size_t batch = state.range(0);
+
+  std::vector<uint8_t> seeds(batch * 32);
+  std::vector<uint8_t> pkeys(batch * dilithium2::PubKeyLen);
+  std::vector<uint8_t> skeys(batch * dilithium2::SecKeyLen);
+
+  prng::prng_t prng;
+  prng.read(seeds);
+
+  for (auto _ : state) {
+    dilithium2::keygen_batch(seeds, pkeys, skeys);
+
+    benchmark::DoNotOptimize(pkeys);
+    benchmark::DoNotOptimize(skeys);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(state.iterations() * batch);
+}
+
 // Benchmark Dilithium2 signing algorithm's performance
 inline void
 dilithium2_sign(benchmark::State& state)
@@ -74,6 +128,254 @@ dilithium2_sign(benchmark::State& state)
   assert(dilithium2::verify(_pkey, _msg, _sig));
 }
 
+// Benchmark Dilithium2 signing under a prepared secret key, either through
+// compile-time API ( runtime = false ) or through runtime dispatched signer
+// ( runtime = true ), so that overhead of dispatch can be read off their
+// difference. Same key and message is signed by both.
+template<bool runtime>
+inline void
+dilithium2_sign_prepared(benchmark::State& state)
+{
+  using namespace dilithium2;
+
+  const size_t mlen = state.range(0);
+
+  std::array<uint8_t, 32> seed{};
+  std::array<uint8_t, PubKeyLen> pkey{};
+  std::array<uint8_t, SecKeyLen> skey{};
+  std::array<uint8_t, SigLen> sig{};
+  std::vector<uint8_t> msg(mlen);
+
+  prng::prng_t prng(seed);
+  prng.read(seed);
+  prng.read(msg);
+
+  keygen(seed, pkey, skey);
+
+  auto prepared = std::make_unique<prepared_seckey_t>();
+  prepare_seckey(skey, *prepared);
+
+  const dilithium::signer_t signer(dilithium::level_t::dilithium2, skey);
+
+  for (auto _ : state) {
+    if constexpr (runtime) {
+      signer.sign(msg, sig, {});
+    } else {
+      sign(*prepared, msg, sig, {});
+    }
+
+    benchmark::DoNotOptimize(sig);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Benchmark Dilithium2 verification under a prepared public key, either
+// through compile-time API ( runtime = false ) or through runtime dispatched
+// verifier ( runtime = true ).
+template<bool runtime>
+inline void
+dilithium2_verify_prepared(benchmark::State& state)
+{
+  using namespace dilithium2;
+
+  const size_t mlen = state.range(0);
+
+  std::array<uint8_t, 32> seed{};
+  std::array<uint8_t, PubKeyLen> pkey{};
+  std::array<uint8_t, SecKeyLen> skey{};
+  std::array<uint8_t, SigLen> sig{};
+  std::vector<uint8_t> msg(mlen);
+
+  prng::prng_t prng(seed);
+  prng.read(seed);
+  prng.read(msg);
+
+  keygen(seed, pkey, skey);
+  sign(skey, msg, sig, {});
+
+  auto prepared = std::make_unique<prepared_pubkey_t>();
+  prepare_pubkey(pkey, *prepared);
+
+  const dilithium::verifier_t verifier(dilithium::level_t::dilithium2, pkey);
+
+  bool flg = true;
+  for (auto _ : state) {
+    if constexpr (runtime) {
+      flg &= verifier.verify(msg, sig);
+    } else {
+      flg &= verify(*prepared, msg, sig);
+    }
+
+    benchmark::DoNotOptimize(flg);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(state.iterations());
+  assert(flg);
+}
+
+// Benchmark Dilithium2 masked signing routine's performance, at given masking
+// order, where s1, s2, K, ρ' and y are split into order + 1 shares. Key pair
+// and messages are derived from a fixed seed, so that every order signs exactly
+// same messages, taking same number of attempts, while masks are fresh.
+// Masked secret key is prepared once, outside of the timed loop. Order 0 keeps
+// the secret as its only share, being the baseline of masked code path.
+template<size_t order>
+inline void
+dilithium2_sign_masked(benchmark::State& state)
+{
+  using namespace dilithium2;
+
+  const size_t mlen = state.range(0);
+  constexpr size_t msg_cnt = 64;
+
+  std::array<uint8_t, 32> seed{};
+  std::array<uint8_t, PubKeyLen> pkey{};
+  std::array<uint8_t, SecKeyLen> skey{};
+  std::array<uint8_t, SigLen> sig{};
+  std::vector<std::vector<uint8_t>> msgs(msg_cnt, std::vector<uint8_t>(mlen));
+
+  prng::prng_t prng(seed);
+  prng.read(seed);
+
+  for (auto& msg : msgs) {
+    prng.read(msg);
+  }
+
+  keygen(seed, pkey, skey);
+
+  auto masked = std::make_unique<masked_seckey_t<order>>();
+  prepare_masked_seckey<order>(skey, *masked);
+
+  size_t i = 0;
+  for (auto _ : state) {
+    sign(*masked, msgs[i], sig, {});
+
+    benchmark::DoNotOptimize(sig);
+    benchmark::ClobberMemory();
+
+    i = (i + 1) % msg_cnt;
+  }
+
+  state.SetItemsProcessed(state.iterations());
+  masked->wipe();
+}
+
+// Benchmark Dilithium2 speculative signing routine's performance, where a few
+// consecutive signing attempts are evaluated at once, on default thread pool.
+// Messages are varied across iterations, so that number of rejected attempts
+// varies too
+inline void
+dilithium2_sign_speculative(benchmark::State& state)
+{
+  const size_t mlen = state.range(0);
+  constexpr size_t msg_cnt = 64;
+
+  std::array<uint8_t, 32> seed{};
+  std::array<uint8_t, dilithium2::PubKeyLen> pkey{};
+  std::array<uint8_t, dilithium2::SecKeyLen> skey{};
+  std::array<uint8_t, dilithium2::SigLen> sig{};
+  std::vector<std::vector<uint8_t>> msgs(msg_cnt, std::vector<uint8_t>(mlen));
+
+  prng::prng_t prng;
+  prng.read(seed);
+
+  for (auto& msg : msgs) {
+    prng.read(msg);
+  }
+
+  dilithium2::keygen(seed, pkey, skey);
+
+  size_t i = 0;
+  for (auto _ : state) {
+    dilithium2::sign_speculative(skey, msgs[i], sig, {});
+
+    benchmark::DoNotOptimize(sig);
+    benchmark::ClobberMemory();
+
+    i = (i + 1) % msg_cnt;
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Benchmark Dilithium2 online signing routine's performance, where message
+// independent part of randomized signing attempts is precomputed by a
+// background thread
+inline void
+dilithium2_sign_online(benchmark::State& state)
+{
+  const size_t mlen = state.range(0);
+
+  std::array<uint8_t, 32> seed{};
+  std::array<uint8_t, dilithium2::PubKeyLen> pkey{};
+  std::array<uint8_t, dilithium2::SecKeyLen> skey{};
+  std::array<uint8_t, dilithium2::SigLen> sig{};
+  std::vector<uint8_t> msg(mlen);
+
+  prng::prng_t prng;
+  prng.read(seed);
+  prng.read(msg);
+
+  dilithium2::keygen(seed, pkey, skey);
+
+  auto prepared = std::make_shared<dilithium2::prepared_seckey_t>();
+  dilithium2::prepare_seckey(skey, *prepared);
+
+  dilithium2::presign_pool_t pool(prepared, 256);
+  pool.wait_ready(pool.capacity());
+
+  for (auto _ : state) {
+    pool.sign_online(msg, sig);
+
+    benchmark::DoNotOptimize(sig);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(state.iterations());
+  assert(dilithium2::verify(pkey, msg, sig));
+}
+
+// Benchmark Dilithium2 batch signing routine's performance, where a batch of N
+// messages is signed under one prepared secret key
+inline void
+dilithium2_sign_batch(benchmark::State& state)
+{
+  const size_t batch = state.range(0);
+  constexpr size_t mlen = 32;
+
+  std::array<uint8_t, 32> seed{};
+  std::array<uint8_t, dilithium2::PubKeyLen> pkey{};
+  std::array<uint8_t, dilithium2::SecKeyLen> skey{};
+  std::vector<std::array<uint8_t, mlen>> msgs(batch);
+  std::vector<std::span<const uint8_t>> msg_spans;
+  std::vector<uint8_t> sigs(batch * dilithium2::SigLen);
+
+  prng::prng_t prng;
+  prng.read(seed);
+
+  for (auto& msg : msgs) {
+    prng.read(msg);
+    msg_spans.push_back(msg);
+  }
+
+  dilithium2::keygen(seed, pkey, skey);
+
+  auto prepared = std::make_unique<dilithium2::prepared_seckey_t>();
+  dilithium2::prepare_seckey(skey, *prepared);
+
+  for (auto _ : state) {
+    dilithium2::sign_batch(*prepared, msg_spans, sigs);
+
+    benchmark::DoNotOptimize(sigs);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(state.iterations() * batch);
+}
+
 // Benchmark Dilithium2 signature verification routine's performance
 inline void
 dilithium2_verify(benchmark::State& state)
@@ -116,6 +418,160 @@ dilithium2_verify(benchmark::State& state)
   state.SetItemsProcessed(state.iterations());
 }
 
+// Benchmark Dilithium2 batch signature verification routine's performance,
+// where a batch of N signatures is spread across four public keys
+inline void
+dilithium2_verify_batch(benchmark::State& state)
+{
+  const size_t batch = state.range(0);
+  constexpr size_t mlen = 32;
+  constexpr size_t key_cnt = 4;
+
+  std::vector<std::array<uint8_t, dilithium2::PubKeyLen>> pkeys(key_cnt);
+  std::vector<std::array<uint8_t, dilithium2::SigLen>> sigs(batch);
+  std::vector<std::array<uint8_t, mlen>> msgs(batch);
+  std::vector<dilithium2::verify_job_t> jobs;
+
+  prng::prng_t prng;
+
+  for (size_t i = 0; i < key_cnt; i++) {
+    std::array<uint8_t, 32> seed{};
+    std::array<uint8_t, dilithium2::SecKeyLen> skey{};
+
+    prng.read(seed);
+    dilithium2::keygen(seed, pkeys[i], skey);
+
+    for (size_t j = i; j < batch; j += key_cnt) {
+      prng.read(msgs[j]);
+      dilithium2::sign(skey, msgs[j], sigs[j], {});
+    }
+  }
+
+  for (size_t j = 0; j < batch; j++) {
+    jobs.push_back({ pkeys[j % key_cnt], msgs[j], sigs[j] });
+  }
+
+  for (auto _ : state) {
+    auto bitmap = dilithium2::verify_batch(jobs);
+
+    benchmark::DoNotOptimize(bitmap);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(state.iterations() * batch);
+}
+
+// Benchmark lane-sliced verification of a batch of Dilithium2 signatures, each
+// under a distinct public key
+inline void
+dilithium2_verify_lanes(benchmark::State& state)
+{
+  const size_t batch = state.range(0);
+  constexpr size_t mlen = 32;
+
+  std::vector<uint8_t> pkeys(batch * dilithium2::PubKeyLen);
+  std::vector<uint8_t> sigs(batch * dilithium2::SigLen);
+  std::vector<std::array<uint8_t, mlen>> msgs(batch);
+  std::vector<std::span<const uint8_t>> msg_spans;
+  std::vector<uint8_t> results(batch);
+
+  prng::prng_t prng;
+
+  for (size_t i = 0; i < batch; i++) {
+    std::array<uint8_t, 32> seed{};
+    std::array<uint8_t, dilithium2::SecKeyLen> skey{};
+
+    auto pkey = std::span<uint8_t, dilithium2::PubKeyLen>(pkeys.data() + i * dilithium2::PubKeyLen,
+                                                            dilithium2::PubKeyLen);
+    auto sig = std::span<uint8_t, dilithium2::SigLen>(sigs.data() + i * dilithium2::SigLen, dilithium2::SigLen);
+
+    prng.read(seed);
+    prng.read(msgs[i]);
+
+    dilithium2::keygen(seed, pkey, skey);
+    dilithium2::sign(skey, msgs[i], sig, {});
+
+    msg_spans.push_back(msgs[i]);
+  }
+
+  for (auto _ : state) {
+    dilithium2::verify_lanes(pkeys, msg_spans, sigs, results);
+
+    benchmark::DoNotOptimize(results);
+    benchmark::ClobberMemory();
+  }
+
+  assert(std::all_of(results.begin(), results.end(), [](const auto v) { return v == 1; }));
+  state.SetItemsProcessed(state.iterations() * batch);
+}
+
 BENCHMARK(dilithium2_keygen)->ComputeStatistics("min", compute_min)->ComputeStatistics("max", compute_max);
+BENCHMARK_TEMPLATE(dilithium2_keygen_masked, 0)
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
+BENCHMARK_TEMPLATE(dilithium2_keygen_masked, 1)
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
+BENCHMARK_TEMPLATE(dilithium2_keygen_masked, 2)
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
+BENCHMARK(dilithium2_keygen_batch)
+  ->Arg(64)
+  ->UseRealTime()
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
 BENCHMARK(dilithium2_sign)->Arg(32)->ComputeStatistics("min", compute_min)->ComputeStatistics("max", compute_max);
+BENCHMARK_TEMPLATE(dilithium2_sign_masked, 0)
+  ->Arg(32)
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
+BENCHMARK_TEMPLATE(dilithium2_sign_masked, 1)
+  ->Arg(32)
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
+BENCHMARK_TEMPLATE(dilithium2_sign_masked, 2)
+  ->Arg(32)
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
+BENCHMARK_TEMPLATE(dilithium2_sign_masked, 3)
+  ->Arg(32)
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
+BENCHMARK(dilithium2_sign_online)->Arg(32)->ComputeStatistics("min", compute_min)->ComputeStatistics("max", compute_max);
 BENCHMARK(dilithium2_verify)->Arg(32)->ComputeStatistics("min", compute_min)->ComputeStatistics("max", compute_max);
+BENCHMARK_TEMPLATE(dilithium2_sign_prepared, false)
+  ->Arg(32)
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
+BENCHMARK_TEMPLATE(dilithium2_sign_prepared, true)
+  ->Arg(32)
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
+BENCHMARK_TEMPLATE(dilithium2_verify_prepared, false)
+  ->Arg(32)
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
+BENCHMARK_TEMPLATE(dilithium2_verify_prepared, true)
+  ->Arg(32)
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
+BENCHMARK(dilithium2_verify_batch)
+  ->Arg(64)
+  ->UseRealTime()
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
+BENCHMARK(dilithium2_verify_lanes)
+  ->Arg(64)
+  ->UseRealTime()
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
+BENCHMARK(dilithium2_sign_speculative)
+  ->Arg(32)
+  ->UseRealTime()
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
+BENCHMARK(dilithium2_sign_batch)
+  ->Arg(64)
+  ->UseRealTime()
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
@@ -0,0 +1,130 @@
+#include "bench_helper.hpp"
+#include "compact.hpp"
+#include "prng.hpp"
+#include "runtime.hpp"
+#include <benchmark/benchmark.h>
+
+// Security levels, a mixed-level deployment rotates through.
+constexpr std::array<dilithium::level_t, 3> LEVELS{ dilithium::level_t::dilithium2,
+                                                    dilithium::level_t::dilithium3,
+                                                    dilithium::level_t::dilithium5 };
+
+// Labels benchmark with build mode, so that results of fully specialized build
+// ( `make benchmark` ) and code-size-optimized one ( `make benchmark_compact`,
+// see `compact.hpp` ) can be told apart.
+static inline void
+label_build_mode(benchmark::State& state)
+{
+  state.SetLabel(compact::ENABLED ? "compact" : "specialized");
+}
+
+// Number of messages, cycled through, so that number of signing attempts
+// averages out, instead of being fixed by one message.
+constexpr size_t MSG_CNT = 64;
+
+// Key pairs of all three security levels and messages of given length, all
+// derived from a fixed seed, so that both build modes process same inputs.
+struct mixed_keys_t
+{
+  std::array<std::vector<uint8_t>, LEVELS.size()> pkeys;
+  std::array<std::vector<uint8_t>, LEVELS.size()> skeys;
+  std::vector<std::vector<uint8_t>> msgs;
+
+  explicit mixed_keys_t(const size_t mlen)
+    : msgs(MSG_CNT, std::vector<uint8_t>(mlen))
+  {
+    std::array<uint8_t, 32> seed{};
+    prng::prng_t prng(seed);
+
+    for (size_t i = 0; i < LEVELS.size(); i++) {
+      pkeys[i].resize(dilithium::pub_key_len(LEVELS[i]));
+      skeys[i].resize(dilithium::sec_key_len(LEVELS[i]));
+
+      prng.read(seed);
+      dilithium::keygen(LEVELS[i], seed, pkeys[i], skeys[i]);
+    }
+
+    for (auto& msg : msgs) {
+      prng.read(msg);
+    }
+  }
+};
+
+// Benchmark signing, under prepared secret keys of all three security levels,
+// switching level on every signature, as a gateway serving clients of different
+// levels does. Each iteration signs once at each level, so that whole pipeline
+// of each level competes for instruction cache.
+inline void
+mixed_levels_sign(benchmark::State& state)
+{
+  const mixed_keys_t keys(state.range(0));
+
+  std::vector<dilithium::signer_t> signers;
+  std::array<std::vector<uint8_t>, LEVELS.size()> sigs;
+
+  for (size_t i = 0; i < LEVELS.size(); i++) {
+    signers.emplace_back(LEVELS[i], keys.skeys[i]);
+    sigs[i].resize(dilithium::sig_len(LEVELS[i]));
+  }
+
+  size_t midx = 0;
+  for (auto _ : state) {
+    const auto& msg = keys.msgs[midx];
+
+    for (size_t i = 0; i < LEVELS.size(); i++) {
+      signers[i].sign(msg, sigs[i], {});
+      benchmark::DoNotOptimize(sigs[i]);
+    }
+
+    benchmark::ClobberMemory();
+    midx = (midx + 1) % MSG_CNT;
+  }
+
+  state.SetItemsProcessed(state.iterations() * LEVELS.size());
+  label_build_mode(state);
+}
+
+// Benchmark verification, under prepared public keys of all three security
+// levels, switching level on every signature, see `mixed_levels_sign`.
+inline void
+mixed_levels_verify(benchmark::State& state)
+{
+  const mixed_keys_t keys(state.range(0));
+
+  std::vector<dilithium::verifier_t> verifiers;
+  std::array<std::vector<uint8_t>, LEVELS.size()> sigs;
+
+  for (size_t i = 0; i < LEVELS.size(); i++) {
+    const size_t siglen = dilithium::sig_len(LEVELS[i]);
+
+    verifiers.emplace_back(LEVELS[i], keys.pkeys[i]);
+    sigs[i].resize(MSG_CNT * siglen);
+
+    const dilithium::signer_t signer(LEVELS[i], keys.skeys[i]);
+    for (size_t j = 0; j < MSG_CNT; j++) {
+      signer.sign(keys.msgs[j], std::span(sigs[i]).subspan(j * siglen, siglen), {});
+    }
+  }
+
+  size_t midx = 0;
+  bool flg = true;
+  for (auto _ : state) {
+    const auto& msg = keys.msgs[midx];
+
+    for (size_t i = 0; i < LEVELS.size(); i++) {
+      const size_t siglen = verifiers[i].sig_len();
+      flg &= verifiers[i].verify(msg, std::span(sigs[i]).subspan(midx * siglen, siglen));
+    }
+
+    benchmark::DoNotOptimize(flg);
+    benchmark::ClobberMemory();
+    midx = (midx + 1) % MSG_CNT;
+  }
+
+  state.SetItemsProcessed(state.iterations() * LEVELS.size());
+  label_build_mode(state);
+  assert(flg);
+}
+
+BENCHMARK(mixed_levels_sign)->Arg(32)->ComputeStatistics("min", compute_min)->ComputeStatistics("max", compute_max);
+BENCHMARK(mixed_levels_verify)->Arg(32)->ComputeStatistics("min", compute_min)->ComputeStatistics("max", compute_max);
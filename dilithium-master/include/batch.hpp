@@ -0,0 +1,931 @@
+#pragma once
+#include "dilithium.hpp"
+#include "keccak_xn.hpp"
+#include "lanes.hpp"
+#include "thread_pool.hpp"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Batched Dilithium operations, spread across a pool of worker threads
+namespace dilithium_batch {
+
+// One signature verification job i.e. public key, message and signature, whose
+// validity is to be checked. Referred byte arrays must outlive the batch
+// verification call.
+template<size_t k, size_t l, size_t d, uint32_t γ1, size_t ω>
+struct verify_job_t
+{
+  std::span<const uint8_t, dilithium_utils::pub_key_len<k, d>()> pubkey;
+  std::span<const uint8_t> msg;
+  std::span<const uint8_t, dilithium_utils::sig_len<k, l, γ1, ω>()> sig;
+};
+
+// Given a batch of signature verification jobs, this routine verifies all of
+// them, spreading the work across worker threads of given pool, returning a
+// bitmap s.t. i -th bit is set only when i -th signature is successfully
+// verified.
+//
+// Jobs are grouped by their public key, so that each distinct public key is
+// prepared ( see `dilithium::prepare_pubkey` ) only once per batch, instead of
+// once per job. Groups are verified in parallel and large groups are further
+// split across workers, sharing the prepared public key read-only. Public key
+// of a group is prepared only if at least one of its signatures passes cheap
+// checks of `dilithium::decode_signature`, which run once per signature, with
+// the decoded signature being reused for verifying it.
+template<size_t k, size_t l, size_t d, uint32_t γ1, uint32_t γ2, uint32_t τ, uint32_t β, size_t ω>
+static inline std::vector<bool>
+verify_batch(std::span<const verify_job_t<k, l, d, γ1, ω>> jobs,
+             thread_pool::pool_t& pool = thread_pool::default_pool())
+  requires(dilithium_params::check_verify_params(k, l, d, γ1, γ2, τ, β, ω))
+{
+  using prepared_t = dilithium::prepared_pubkey_t<k, l, d>;
+
+  // Groups having more jobs than this are verified by more than one worker.
+  constexpr size_t split_at = 8;
+
+  std::unordered_map<std::string_view, size_t> group_of;
+  std::vector<std::vector<size_t>> groups;
+
+  for (size_t i = 0; i < jobs.size(); i++) {
+    const auto pk = jobs[i].pubkey;
+    const auto key = std::string_view(reinterpret_cast<const char*>(pk.data()), pk.size());
+
+    const auto [it, inserted] = group_of.try_emplace(key, groups.size());
+    if (inserted) {
+      groups.emplace_back();
+    }
+
+    groups[it->second].push_back(i);
+  }
+
+  std::vector<uint8_t> results(jobs.size(), 0);
+
+  pool.parallel_for(groups.size(), [&](const size_t gidx) {
+    using workspace_t = dilithium::workspace_t<k, l, γ2>;
+
+    const auto& group = groups[gidx];
+
+    // Decodes signature of j -th job of the group into the workspace and, if it
+    // passes cheap checks, verifies it. So each signature is decoded only once.
+    auto verify_one = [&](const prepared_t& prepared, const size_t j, workspace_t& ws) {
+      const auto& job = jobs[group[j]];
+      if (dilithium::decode_signature<k, l, γ1, β, ω>(job.sig, ws.z, ws.h)) {
+        results[group[j]] = dilithium::verify_decoded<k, l, d, γ1, γ2, τ, β, ω>(prepared, job.msg, job.sig, ws);
+      }
+    };
+
+    // Public key is prepared only once first signature passing cheap checks is
+    // found, which is then verified using the very decoding.
+    auto ws = std::make_unique<workspace_t>();
+
+    size_t first = 0;
+    while (first < group.size() && !dilithium::decode_signature<k, l, γ1, β, ω>(jobs[group[first]].sig, ws->z, ws->h)) {
+      first++;
+    }
+
+    if (first == group.size()) {
+      return;
+    }
+
+    auto prepared = std::make_unique<prepared_t>();
+    dilithium::prepare_pubkey<k, l, d>(jobs[group[first]].pubkey, *prepared);
+
+    const auto& job = jobs[group[first]];
+    results[group[first]] = dilithium::verify_decoded<k, l, d, γ1, γ2, τ, β, ω>(*prepared, job.msg, job.sig, *ws);
+
+    const size_t rest = group.size() - first - 1;
+
+    if (rest > split_at) {
+      pool.parallel_for(rest, [&](const size_t j) {
+        auto ws = std::make_unique<workspace_t>();
+        verify_one(*prepared, first + 1 + j, *ws);
+      });
+    } else {
+      for (size_t j = first + 1; j < group.size(); j++) {
+        verify_one(*prepared, j, *ws);
+      }
+    }
+  });
+
+  std::vector<bool> bitmap(jobs.size());
+  for (size_t i = 0; i < jobs.size(); i++) {
+    bitmap[i] = static_cast<bool>(results[i]);
+  }
+
+  return bitmap;
+}
+
+// Lane-sliced verification of L signatures, each under its own public key, in
+// lockstep, one signature per lane. Caller loads verification jobs into lanes
+// ( see `load` ), which decodes each signature once, running cheap checks of
+// `dilithium::decode_signature`, so that a lane is only ever occupied by a
+// signature which has passed them, and then verifies all lanes at once ( see
+// `verify` ), recomputing their challenges.
+//
+// Its buffers are fully overwritten by `load`, `pad` and `verify`, so they carry
+// no initializers, same as `dilithium::workspace_t`, and a verifier can be
+// allocated using `std::make_unique_for_overwrite`.
+template<size_t k, size_t l, size_t d, uint32_t γ1, uint32_t γ2, uint32_t τ, uint32_t β, size_t ω, size_t L>
+struct lane_verifier_t
+{
+  static constexpr size_t pklen = dilithium_utils::pub_key_len<k, d>();
+  static constexpr size_t siglen = dilithium_utils::sig_len<k, l, γ1, ω>();
+
+  static constexpr size_t t1_bw = std::bit_width(field::Q) - d;
+  static constexpr uint32_t α = γ2 << 1;
+  static constexpr uint32_t m = (field::Q - 1u) / α;
+  static constexpr size_t w1bw = std::bit_width(m - 1u);
+
+  static constexpr size_t sigoff0 = 0;
+  static constexpr size_t sigoff1 = sigoff0 + 32;
+
+  static constexpr size_t hash_in_len = 64 + (k * w1bw * 32);
+
+  std::array<field::zq_t, k * l * ntt::N * L> A;
+  std::array<field::zq_t, k * ntt::N * L> t1;
+  std::array<field::zq_t, l * ntt::N * L> z;
+  std::array<field::zq_t, k * ntt::N * L> h;
+  std::array<field::zq_t, ntt::N * L> c;
+  std::array<field::zq_t, k * ntt::N * L> w;
+  std::array<field::zq_t, k * ntt::N * L> w1;
+  std::array<field::zq_t, ntt::N * L> polys;
+
+  std::array<std::span<const uint8_t>, L> pubkeys;
+  std::array<std::span<const uint8_t>, L> msgs;
+  std::array<std::span<const uint8_t>, L> sigs;
+
+  // Decodes signature `sig` ( see `dilithium::decode_signature` ) and public key
+  // `pubkey` of a verification job into j -th lane, returning truth value of
+  // cheap checks of the signature. Lane is left untouched, when they fail.
+  // Referred byte arrays must outlive `verify`.
+  inline bool load(const size_t j,
+                   std::span<const uint8_t, pklen> pubkey,
+                   std::span<const uint8_t> msg,
+                   std::span<const uint8_t, siglen> sig)
+  {
+    std::array<field::zq_t, l * ntt::N> z_one{};
+    std::array<field::zq_t, k * ntt::N> h_one{};
+
+    if (!dilithium::decode_signature<k, l, γ1, β, ω>(sig, z_one, h_one)) {
+      return false;
+    }
+
+    std::array<field::zq_t, k * ntt::N> t1_one{};
+
+    polyvec::decode<k, t1_bw>(pubkey.template subspan<32, pklen - 32>(), t1_one);
+    polyvec::shl<k, d>(t1_one);
+
+    lanes::scatter<l, L>(z_one, z, j);
+    lanes::scatter<k, L>(h_one, h, j);
+    lanes::scatter<k, L>(t1_one, t1, j);
+
+    pubkeys[j] = pubkey;
+    msgs[j] = msg;
+    sigs[j] = sig;
+
+    return true;
+  }
+
+  // Fills lanes [cnt, L) with copies of lane cnt - 1 ( cnt > 0 ), so that a
+  // partially loaded verifier can be run, discarding results of those lanes.
+  inline void pad(const size_t cnt)
+  {
+    const size_t src = cnt - 1;
+
+    for (size_t j = cnt; j < L; j++) {
+      for (size_t i = 0; i < l * ntt::N; i++) {
+        z[i * L + j] = z[i * L + src];
+      }
+      for (size_t i = 0; i < k * ntt::N; i++) {
+        h[i * L + j] = h[i * L + src];
+        t1[i * L + j] = t1[i * L + src];
+      }
+
+      pubkeys[j] = pubkeys[src];
+      msgs[j] = msgs[src];
+      sigs[j] = sigs[src];
+    }
+  }
+
+  // Verifies signatures of all L ( loaded ) lanes, writing 1 to results[j], only
+  // when signature in j -th lane is valid.
+  inline void verify(std::span<uint8_t, L> results)
+  {
+    // tr = H(pk) and then μ = H(tr || M)
+    std::array<uint8_t, 32 * L> tr{};
+    std::array<uint8_t, 64 * L> mu{};
+
+    {
+      std::array<std::array<std::span<const uint8_t>, 1>, L> in{};
+      for (size_t j = 0; j < L; j++) {
+        in[j] = { pubkeys[j] };
+      }
+
+      keccak_xn::shake256_xn_t<L> hasher;
+      hasher.absorb_finalize(in);
+      hasher.squeeze(tr, 32);
+    }
+
+    {
+      std::array<std::array<std::span<const uint8_t>, 2>, L> in{};
+      for (size_t j = 0; j < L; j++) {
+        in[j] = { std::span<const uint8_t>(tr).subspan(j * 32, 32), msgs[j] };
+      }
+
+      keccak_xn::shake256_xn_t<L> hasher;
+      hasher.absorb_finalize(in);
+      hasher.squeeze(mu, 64);
+    }
+
+    {
+      std::array<uint8_t, 32 * L> rhos{};
+      for (size_t j = 0; j < L; j++) {
+        std::copy_n(pubkeys[j].begin(), 32, rhos.begin() + j * 32);
+      }
+
+      sampling::expand_a_xn<k, l, L>(rhos, A);
+    }
+
+    sample_in_ball();
+
+    lanes::ntt<L>(c);
+    lanes::ntt<l, L>(z);
+    lanes::ntt<k, L>(t1);
+
+    std::fill(w.begin(), w.end(), field::zq_t::zero());
+    lanes::matrix_multiply<k, l, L>(A, z, w);
+    lanes::mul_by_poly<k, L>(c, t1, t1);
+    lanes::sub_from<k, L>(t1, w);
+    lanes::intt<k, L>(w);
+    lanes::use_hint<k, α, L>(h, w, w1);
+
+    // Recompute challenge hash H(μ || w1) and compare it with the one in
+    // signature
+    std::array<uint8_t, hash_in_len * L> hash_in{};
+    std::array<uint8_t, 32 * L> hash_out{};
+
+    {
+      std::array<field::zq_t, k * ntt::N> w1_one{};
+      auto _hash_in = std::span(hash_in);
+
+      for (size_t j = 0; j < L; j++) {
+        auto dst = std::span<uint8_t, hash_in_len>(_hash_in.subspan(j * hash_in_len, hash_in_len));
+
+        lanes::gather<k, L>(w1, w1_one, j);
+        std::copy_n(mu.begin() + j * 64, 64, dst.begin());
+        polyvec::encode<k, w1bw>(w1_one, dst.template subspan<64, hash_in_len - 64>());
+      }
+
+      std::array<std::array<std::span<const uint8_t>, 1>, L> in{};
+      for (size_t j = 0; j < L; j++) {
+        in[j] = { _hash_in.subspan(j * hash_in_len, hash_in_len) };
+      }
+
+      keccak_xn::shake256_xn_t<L> hasher;
+      hasher.absorb_finalize(in);
+      hasher.squeeze(hash_out, 32);
+    }
+
+    for (size_t j = 0; j < L; j++) {
+      bool flg = false;
+      for (size_t i = 0; i < 32; i++) {
+        flg |= static_cast<bool>(sigs[j][sigoff0 + i] ^ hash_out[j * 32 + i]);
+      }
+
+      results[j] = !flg;
+    }
+  }
+
+private:
+  // Lane-sliced `sampling::sample_in_ball`, hashing challenge seed of each lane
+  // to a polynomial with τ coefficients set to ±1.
+  inline void sample_in_ball()
+  {
+    constexpr size_t blen = shake256::RATE / 8;
+
+    std::array<uint8_t, 8 * L> tau_bits{};
+    std::array<uint8_t, blen * L> buf{};
+    auto _buf = std::span(buf);
+
+    std::array<std::array<std::span<const uint8_t>, 1>, L> in{};
+    for (size_t j = 0; j < L; j++) {
+      in[j] = { sigs[j].template subspan<sigoff0, sigoff1 - sigoff0>() };
+    }
+
+    keccak_xn::shake256_xn_t<L> hasher;
+    hasher.absorb_finalize(in);
+    hasher.squeeze(tau_bits, 8);
+
+    std::fill(polys.begin(), polys.end(), field::zq_t::zero());
+
+    std::array<size_t, L> i{};
+    i.fill(ntt::N - τ);
+
+    bool pending = true;
+    while (pending) {
+      hasher.squeeze(buf, blen);
+
+      pending = false;
+      for (size_t j = 0; j < L; j++) {
+        auto poly = std::span<field::zq_t, ntt::N>(std::span(polys).subspan(j * ntt::N, ntt::N));
+        auto bits = std::span<const uint8_t, 8>(std::span<const uint8_t>(tau_bits).subspan(j * 8, 8));
+
+        i[j] = sampling::ball_step<τ>(bits, _buf.subspan(j * blen, blen), poly, i[j]);
+        pending |= i[j] < ntt::N;
+      }
+    }
+
+    for (size_t j = 0; j < L; j++) {
+      for (size_t idx = 0; idx < ntt::N; idx++) {
+        c[idx * L + j] = polys[j * ntt::N + idx];
+      }
+    }
+  }
+};
+
+// Given n signature verification jobs, as contiguous arrays of n public keys
+// ( each of `pub_key_len` -bytes ) and n signatures ( each of `sig_len` -bytes ),
+// along with n messages, this routine verifies all of them, writing 1 to
+// results[i] only when i -th signature is valid, otherwise 0 is written.
+//
+// Instead of vectorizing arithmetic inside one polynomial, signatures are
+// verified L at a time, one per lane ( see `lanes.hpp` ), including their
+// Keccak work, which runs on a L -lane SHAKE sponge ( see `keccak_xn.hpp` ).
+// Jobs are split into chunks, a few per worker thread of the pool, each a
+// multiple of L jobs, which are spread across the workers. Each chunk's signatures are decoded once, straight into lanes of a
+// verifier ( see `lane_verifier_t::load` ), and ones failing cheap checks of
+// `dilithium::decode_signature` never occupy a lane. Last, partially filled,
+// group of a chunk is padded by repeating its last lane, whose padded results
+// are discarded.
+//
+// Throws `std::invalid_argument` if lengths of public keys, signatures or
+// results don't match number of messages.
+//
+// This is useful for bulk verification of signatures under many different
+// public keys, where public key preparation can't be shared.
+template<size_t k,
+         size_t l,
+         size_t d,
+         uint32_t γ1,
+         uint32_t γ2,
+         uint32_t τ,
+         uint32_t β,
+         size_t ω,
+         size_t L = lanes::DEFAULT_LANES>
+static inline void
+verify_lanes(std::span<const uint8_t> pubkeys,
+             std::span<const std::span<const uint8_t>> msgs,
+             std::span<const uint8_t> sigs,
+             std::span<uint8_t> results,
+             thread_pool::pool_t& pool = thread_pool::default_pool())
+  requires(dilithium_params::check_verify_params(k, l, d, γ1, γ2, τ, β, ω))
+{
+  using verifier_t = lane_verifier_t<k, l, d, γ1, γ2, τ, β, ω, L>;
+
+  constexpr size_t pklen = verifier_t::pklen;
+  constexpr size_t siglen = verifier_t::siglen;
+
+  const size_t n = msgs.size();
+  if ((pubkeys.size() != n * pklen) || (sigs.size() != n * siglen) || (results.size() != n)) {
+    throw std::invalid_argument("dilithium: public keys, signatures or results don't match number of messages");
+  }
+
+  std::fill(results.begin(), results.end(), 0);
+
+  // A few chunks per thread, each being a multiple of L jobs
+  const size_t chunk = std::max<size_t>(n / ((pool.size() + 1) * 4) / L, 1) * L;
+  const size_t chunk_cnt = (n + chunk - 1) / chunk;
+
+  pool.parallel_for(chunk_cnt, [&](const size_t ci) {
+    auto verifier = std::make_unique_for_overwrite<verifier_t>();
+
+    std::array<size_t, L> idx{};
+    std::array<uint8_t, L> res{};
+    size_t cnt = 0;
+
+    auto flush = [&]() {
+      verifier->pad(cnt);
+      verifier->verify(res);
+
+      for (size_t j = 0; j < cnt; j++) {
+        results[idx[j]] = res[j];
+        metrics::on_verify<k, l>(res[j] != 0);
+      }
+
+      cnt = 0;
+    };
+
+    const size_t end = std::min(n, (ci + 1) * chunk);
+    for (size_t i = ci * chunk; i < end; i++) {
+      const auto pk = std::span<const uint8_t, pklen>(pubkeys.subspan(i * pklen, pklen));
+      const auto sig = std::span<const uint8_t, siglen>(sigs.subspan(i * siglen, siglen));
+
+      if (verifier->load(cnt, pk, msgs[i], sig)) {
+        idx[cnt++] = i;
+        if (cnt == L) {
+          flush();
+        }
+      }
+    }
+
+    if (cnt > 0) {
+      flush();
+    }
+  });
+}
+
+// Given a prepared Dilithium secret key and message, this routine computes
+// deterministic ( default ) or randomized signature, evaluating `width` -many
+// consecutive signing attempts ( i.e. with nonces κ, κ + l, κ + 2l ... ) at once,
+// across worker threads of the pool, instead of one after another. Once a round
+// of attempts finishes, lowest κ attempt, which got accepted, is released as
+// signature, so that output is byte-identical to the one of `dilithium::sign`.
+//
+// Number of rejected attempts before an accepted one is geometrically
+// distributed, so evaluating them speculatively flattens tail of signing
+// latency. Attempts with κ larger than an already accepted one are skipped, if
+// they haven't started yet. If `width` is 0, one attempt per worker thread and
+// one for the calling thread is evaluated in each round.
+//
+// Rejections are reported to `sign_profile` hooks ( and so to metrics and USDT
+// probes ), on calling thread, only for attempts with κ lower than the accepted
+// one, as if they were made one after another, while attempts evaluated past
+// it are discarded silently.
+template<size_t k,
+         size_t l,
+         size_t d,
+         uint32_t η,
+         uint32_t γ1,
+         uint32_t γ2,
+         uint32_t τ,
+         uint32_t β,
+         size_t ω,
+         bool randomized = false>
+static inline void
+sign_speculative(const dilithium::prepared_seckey_t<k, l>& seckey,
+                 std::span<const uint8_t> msg,
+                 std::span<uint8_t, dilithium_utils::sig_len<k, l, γ1, ω>()> sig,
+                 std::span<const uint8_t, 64 * randomized> seed,
+                 thread_pool::pool_t& pool = thread_pool::default_pool(),
+                 const size_t width = 0)
+  requires(dilithium_params::check_signing_params(k, l, d, η, γ1, γ2, τ, β, ω))
+{
+  std::array<uint8_t, 64> mu{};
+  std::array<uint8_t, 64> rho_prime{};
+
+  dilithium::derive_signing_seeds<k, l, randomized>(seckey, msg, seed, mu, rho_prime);
+
+  const size_t cnt = (width == 0) ? (pool.size() + 1) : width;
+  std::vector<dilithium::workspace_t<k, l, γ2>> attempts(cnt);
+  std::vector<std::optional<sign_profile::reject_t>> rejections(cnt);
+
+  uint16_t kappa = 0;
+
+  while (true) {
+    std::atomic<size_t> best{ cnt };
+
+    pool.parallel_for(cnt, [&](const size_t i) {
+      if (i > best.load(std::memory_order_relaxed)) {
+        return;
+      }
+
+      auto& at = attempts[i];
+      const uint16_t kappa_i = static_cast<uint16_t>(kappa + i * l);
+      const sign_profile::defer_t defer(rejections[i]);
+
+      const bool accepted = dilithium::sign_attempt<k, l, γ1, γ2, τ, β, ω>(
+        seckey.A, seckey.s1, seckey.s2, seckey.t0, mu, rho_prime, kappa_i, at);
+
+      if (accepted) {
+        size_t cur = best.load(std::memory_order_relaxed);
+        while ((i < cur) && !best.compare_exchange_weak(cur, i, std::memory_order_relaxed)) {
+        }
+      }
+    });
+
+    const size_t idx = best.load(std::memory_order_relaxed);
+
+    // every attempt below `idx` got evaluated and rejected
+    for (size_t i = 0; i < idx; i++) {
+      sign_profile::on_reject<k, l, γ1, γ2, τ, β, ω>(*rejections[i]);
+    }
+
+    if (idx < cnt) {
+      auto& at = attempts[idx];
+      dilithium::encode_signature<k, l, γ1, ω>(at.c_tilde, at.z, at.h, sig);
+      sign_profile::on_signature<k, l, γ1, γ2, τ, β, ω>(kappa / l + idx + 1);
+
+      for (auto& ws : attempts) {
+        ws.wipe();
+      }
+      return;
+    }
+
+    kappa = static_cast<uint16_t>(kappa + cnt * l);
+  }
+}
+
+// Given a serialized Dilithium secret key and message, this routine prepares
+// the secret key and signs the message, see `sign_speculative` ( above ).
+template<size_t k,
+         size_t l,
+         size_t d,
+         uint32_t η,
+         uint32_t γ1,
+         uint32_t γ2,
+         uint32_t τ,
+         uint32_t β,
+         size_t ω,
+         bool randomized = false>
+static inline void
+sign_speculative(std::span<const uint8_t, dilithium_utils::sec_key_len<k, l, η, d>()> seckey,
+                 std::span<const uint8_t> msg,
+                 std::span<uint8_t, dilithium_utils::sig_len<k, l, γ1, ω>()> sig,
+                 std::span<const uint8_t, 64 * randomized> seed,
+                 thread_pool::pool_t& pool = thread_pool::default_pool(),
+                 const size_t width = 0)
+  requires(dilithium_params::check_signing_params(k, l, d, η, γ1, γ2, τ, β, ω))
+{
+  auto prepared = std::make_unique<dilithium::prepared_seckey_t<k, l>>();
+  dilithium::prepare_seckey<k, l, d, η>(seckey, *prepared);
+
+  sign_speculative<k, l, d, η, γ1, γ2, τ, β, ω, randomized>(*prepared, msg, sig, seed, pool, width);
+}
+
+// Given a prepared Dilithium secret key and n messages, this routine signs all
+// of them, writing i -th signature to sigs[i * sig_len, (i + 1) * sig_len). For
+// randomized signing, n 64 -bytes seeds must be provided ( concatenated ),
+// otherwise `seeds` must be empty. Produced signatures are same as the ones
+// `dilithium::sign` produces. Throws `std::invalid_argument` if lengths of
+// signatures or seeds don't match number of messages.
+//
+// Messages are signed L at a time, spread across worker threads of the pool,
+// sharing the prepared secret key read-only. Keccak work of each group i.e.
+// computing μ, ρ' and sampling masking vectors of signing attempts, runs on a
+// L -lane SHAKE256 sponge ( see `keccak_xn.hpp` ), while all not-yet-signed
+// messages of the group make their next attempt together.
+template<size_t k,
+         size_t l,
+         size_t d,
+         uint32_t η,
+         uint32_t γ1,
+         uint32_t γ2,
+         uint32_t τ,
+         uint32_t β,
+         size_t ω,
+         bool randomized = false,
+         size_t L = keccak_xn::DEFAULT_LANES>
+static inline void
+sign_batch(const dilithium::prepared_seckey_t<k, l>& seckey,
+           std::span<const std::span<const uint8_t>> msgs,
+           std::span<uint8_t> sigs,
+           std::span<const uint8_t> seeds,
+           thread_pool::pool_t& pool = thread_pool::default_pool())
+  requires(dilithium_params::check_signing_params(k, l, d, η, γ1, γ2, τ, β, ω))
+{
+  using commitment_t = dilithium::commitment_t<k, l, γ2>;
+  constexpr size_t siglen = dilithium_utils::sig_len<k, l, γ1, ω>();
+
+  const size_t n = msgs.size();
+  if ((sigs.size() != n * siglen) || (seeds.size() != n * 64 * randomized)) {
+    throw std::invalid_argument("dilithium: signatures or seeds don't match number of messages");
+  }
+
+  const size_t group_cnt = (n + L - 1) / L;
+
+  pool.parallel_for(group_cnt, [&](const size_t g) {
+    const size_t cnt = std::min(L, n - g * L);
+
+    std::array<size_t, L> idx{};
+    for (size_t j = 0; j < L; j++) {
+      idx[j] = std::min(g * L + j, n - 1);
+    }
+
+    // μ = H(tr || M) and ρ' = H(K || μ) ( or provided seed )
+    std::array<uint8_t, 64 * L> mu{};
+    std::array<uint8_t, 64 * L> rho_prime{};
+    auto _mu = std::span(mu);
+    auto _rho_prime = std::span(rho_prime);
+
+    {
+      std::array<std::array<std::span<const uint8_t>, 2>, L> in{};
+      for (size_t j = 0; j < L; j++) {
+        in[j] = { seckey.tr, msgs[idx[j]] };
+      }
+
+      keccak_xn::shake256_xn_t<L> hasher;
+      hasher.absorb_finalize(in);
+      hasher.squeeze(_mu, 64);
+    }
+
+    if constexpr (randomized) {
+      for (size_t j = 0; j < L; j++) {
+        std::copy_n(seeds.begin() + idx[j] * 64, 64, _rho_prime.begin() + j * 64);
+      }
+    } else {
+      std::array<std::array<std::span<const uint8_t>, 2>, L> in{};
+      for (size_t j = 0; j < L; j++) {
+        in[j] = { seckey.key, _mu.subspan(j * 64, 64) };
+      }
+
+      keccak_xn::shake256_xn_t<L> hasher;
+      hasher.absorb_finalize(in);
+      hasher.squeeze(_rho_prime, 64);
+    }
+
+    auto cms = std::make_unique<std::array<commitment_t, L>>();
+
+    std::array<std::span<field::zq_t>, L> y_spans{};
+    std::array<uint16_t, L> kappa{};
+    std::array<bool, L> done{};
+
+    for (size_t j = 0; j < L; j++) {
+      y_spans[j] = (*cms)[j].y;
+      done[j] = j >= cnt;
+    }
+
+    auto ws = std::make_unique<dilithium::workspace_t<k, l, γ2>>();
+
+    size_t pending = cnt;
+    while (pending > 0) {
+      sampling::expand_mask_xn<γ1, l, L>(rho_prime, kappa, y_spans);
+
+      for (size_t j = 0; j < cnt; j++) {
+        if (done[j]) {
+          continue;
+        }
+
+        auto& cm = (*cms)[j];
+        auto lane_mu = std::span<const uint8_t, 64>(_mu.subspan(j * 64, 64));
+
+        dilithium::commit_mask<k, l, γ2>(seckey.A, cm, *ws);
+        if (dilithium::respond<k, l, γ1, γ2, τ, β, ω>(seckey.s1, seckey.s2, seckey.t0, lane_mu, cm, *ws)) {
+          auto sig = std::span<uint8_t, siglen>(sigs.subspan(idx[j] * siglen, siglen));
+          dilithium::encode_signature<k, l, γ1, ω>(ws->c_tilde, ws->z, ws->h, sig);
+          sign_profile::on_signature<k, l, γ1, γ2, τ, β, ω>(kappa[j] / l + 1);
+
+          done[j] = true;
+          pending--;
+        } else {
+          kappa[j] = static_cast<uint16_t>(kappa[j] + l);
+        }
+      }
+    }
+
+    for (auto& cm : *cms) {
+      cm.wipe();
+    }
+    ws->wipe();
+    dilithium_utils::wipe(_rho_prime);
+  });
+}
+
+// Lane-sliced key generation of L Dilithium key pairs, from L independent
+// 32 -bytes seeds, in lockstep, one key pair per lane. All Keccak work i.e.
+// seed hashing, sampling of A, s1, s2 and hashing of public key, runs on a
+// L -lane SHAKE sponge ( see `keccak_xn.hpp` ), while NTTs and matrix-vector
+// multiplication run lane-sliced ( see `lanes.hpp` ). Key pairs are same as the
+// ones `dilithium::keygen` generates, though unlike it, computation of t isn't
+// masked ( see `dilithium::expand_seed` ).
+template<size_t k, size_t l, size_t d, uint32_t η, size_t L>
+struct lane_keygen_t
+{
+  static constexpr size_t pklen = dilithium_utils::pub_key_len<k, d>();
+  static constexpr size_t sklen = dilithium_utils::sec_key_len<k, l, η, d>();
+
+  static constexpr size_t t1_bw = std::bit_width(field::Q) - d;
+  static constexpr size_t eta_bw = std::bit_width(2 * η);
+  static constexpr uint32_t t0_rng = 1u << (d - 1);
+
+  static constexpr size_t pkoff0 = 0;
+  static constexpr size_t pkoff1 = pkoff0 + 32;
+  static constexpr size_t pkoff2 = pklen;
+
+  static constexpr size_t skoff0 = 0;
+  static constexpr size_t skoff1 = skoff0 + 32;
+  static constexpr size_t skoff2 = skoff1 + 32;
+  static constexpr size_t skoff3 = skoff2 + 32;
+  static constexpr size_t skoff4 = skoff3 + l * eta_bw * 32;
+  static constexpr size_t skoff5 = skoff4 + k * eta_bw * 32;
+  static constexpr size_t skoff6 = sklen;
+
+  std::array<field::zq_t, k * l * ntt::N * L> A{};
+  std::array<field::zq_t, l * ntt::N * L> s1_hat{};
+  std::array<field::zq_t, k * ntt::N * L> t_hat{};
+  std::array<field::zq_t, l * ntt::N * L> s1{};
+  std::array<field::zq_t, k * ntt::N * L> s2{};
+  std::array<uint8_t, 32 * L> rho{};
+  std::array<uint8_t, 64 * L> rho_prime{};
+  std::array<uint8_t, 32 * L> key{};
+
+  // Generates L key pairs, where j -th lane writes key pair, generated from
+  // `seeds[j]` ( of 32 -bytes ), to `pubkeys[j]` ( of `pklen` -bytes ) and
+  // `seckeys[j]` ( of `sklen` -bytes ).
+  inline void keygen(const std::array<std::span<const uint8_t>, L>& seeds,
+                     const std::array<std::span<uint8_t>, L>& pubkeys,
+                     const std::array<std::span<uint8_t>, L>& seckeys)
+  {
+    // (ρ, ρ', K) = H(ζ)
+    {
+      std::array<uint8_t, 128 * L> seed_hash{};
+
+      std::array<std::array<std::span<const uint8_t>, 1>, L> in{};
+      for (size_t j = 0; j < L; j++) {
+        in[j] = { seeds[j] };
+      }
+
+      keccak_xn::shake256_xn_t<L> hasher;
+      hasher.absorb_finalize(in);
+      hasher.squeeze(seed_hash, 128);
+
+      for (size_t j = 0; j < L; j++) {
+        const auto src = seed_hash.begin() + j * 128;
+
+        std::copy_n(src, 32, rho.begin() + j * 32);
+        std::copy_n(src + 32, 64, rho_prime.begin() + j * 64);
+        std::copy_n(src + 96, 32, key.begin() + j * 32);
+      }
+
+      dilithium_utils::wipe(std::span(seed_hash));
+    }
+
+    sampling::expand_a_xn<k, l, L>(rho, A);
+
+    {
+      std::array<std::span<field::zq_t>, L> s1_spans{};
+      std::array<std::span<field::zq_t>, L> s2_spans{};
+
+      for (size_t j = 0; j < L; j++) {
+        s1_spans[j] = std::span(s1).subspan(j * l * ntt::N, l * ntt::N);
+        s2_spans[j] = std::span(s2).subspan(j * k * ntt::N, k * ntt::N);
+      }
+
+      sampling::expand_s_xn<η, l, 0, L>(rho_prime, s1_spans);
+      sampling::expand_s_xn<η, k, l, L>(rho_prime, s2_spans);
+    }
+
+    for (size_t j = 0; j < L; j++) {
+      lanes::scatter<l, L>(s1_of(j), s1_hat, j);
+    }
+
+    // t = NTT^-1(A * NTT(s1))
+    lanes::ntt<l, L>(s1_hat);
+    std::fill(t_hat.begin(), t_hat.end(), field::zq_t::zero());
+    lanes::matrix_multiply<k, l, L>(A, s1_hat, t_hat);
+    lanes::intt<k, L>(t_hat);
+
+    std::array<field::zq_t, k * ntt::N> t{};
+    std::array<field::zq_t, k * ntt::N> t1{};
+    std::array<field::zq_t, k * ntt::N> t0{};
+
+    for (size_t j = 0; j < L; j++) {
+      auto pk = std::span<uint8_t, pklen>(pubkeys[j]);
+      auto sk = std::span<uint8_t, sklen>(seckeys[j]);
+
+      lanes::gather<k, L>(t_hat, t, j);
+      polyvec::add_to<k>(s2_of(j), t);
+      polyvec::power2round<k, d>(t, t1, t0);
+
+      std::copy_n(rho.begin() + j * 32, 32, pk.begin());
+      polyvec::encode<k, t1_bw>(t1, pk.template subspan<pkoff1, pkoff2 - pkoff1>());
+
+      polyvec::sub_from_x<k, t0_rng>(t0);
+      polyvec::encode<k, d>(t0, sk.template subspan<skoff5, skoff6 - skoff5>());
+    }
+
+    // tr = H(pk)
+    std::array<uint8_t, 32 * L> tr{};
+
+    {
+      std::array<std::array<std::span<const uint8_t>, 1>, L> in{};
+      for (size_t j = 0; j < L; j++) {
+        in[j] = { pubkeys[j] };
+      }
+
+      keccak_xn::shake256_xn_t<L> hasher;
+      hasher.absorb_finalize(in);
+      hasher.squeeze(tr, 32);
+    }
+
+    for (size_t j = 0; j < L; j++) {
+      auto sk = std::span<uint8_t, sklen>(seckeys[j]);
+
+      std::copy_n(rho.begin() + j * 32, 32, sk.begin() + skoff0);
+      std::copy_n(key.begin() + j * 32, 32, sk.begin() + skoff1);
+      std::copy_n(tr.begin() + j * 32, 32, sk.begin() + skoff2);
+
+      polyvec::sub_from_x<l, η>(s1_of(j));
+      polyvec::sub_from_x<k, η>(s2_of(j));
+
+      polyvec::encode<l, eta_bw>(s1_of(j), sk.template subspan<skoff3, skoff4 - skoff3>());
+      polyvec::encode<k, eta_bw>(s2_of(j), sk.template subspan<skoff4, skoff5 - skoff4>());
+    }
+
+    dilithium_utils::wipe(std::span(t0));
+  }
+
+  // Zeroes secret intermediates, left behind by last key generation.
+  inline void wipe()
+  {
+    dilithium_utils::wipe(std::span(s1_hat));
+    dilithium_utils::wipe(std::span(s1));
+    dilithium_utils::wipe(std::span(s2));
+    dilithium_utils::wipe(std::span(rho_prime));
+    dilithium_utils::wipe(std::span(key));
+  }
+
+private:
+  // Secret vector s1 of j -th lane, in standard layout.
+  inline std::span<field::zq_t, l * ntt::N> s1_of(const size_t j)
+  {
+    return std::span<field::zq_t, l * ntt::N>(std::span(s1).subspan(j * l * ntt::N, l * ntt::N));
+  }
+
+  // Secret vector s2 of j -th lane, in standard layout.
+  inline std::span<field::zq_t, k * ntt::N> s2_of(const size_t j)
+  {
+    return std::span<field::zq_t, k * ntt::N>(std::span(s2).subspan(j * k * ntt::N, k * ntt::N));
+  }
+};
+
+// Given n 32 -bytes seeds ( concatenated ), this routine generates n Dilithium
+// key pairs, writing i -th public key to pubkeys[i * pub_key_len, (i + 1) *
+// pub_key_len) and i -th secret key to seckeys[i * sec_key_len, (i + 1) *
+// sec_key_len). Key pairs are same as the ones `dilithium::keygen` generates.
+//
+// Seeds are processed L at a time, one per lane ( see `lane_keygen_t` ), and
+// groups of L seeds are further spread across worker threads of the pool. Last
+// group is padded by repeating last seed, whose padded lanes just generate the
+// same key pair again.
+//
+// Throws `std::invalid_argument` if seeds aren't a multiple of 32 -bytes or
+// lengths of public keys or secret keys don't match number of seeds.
+//
+// This is useful for bulk provisioning of key pairs, say for a fleet of devices.
+template<size_t k, size_t l, size_t d, uint32_t η, size_t L = lanes::DEFAULT_LANES>
+static inline void
+keygen_batch(std::span<const uint8_t> seeds,
+             std::span<uint8_t> pubkeys,
+             std::span<uint8_t> seckeys,
+             thread_pool::pool_t& pool = thread_pool::default_pool())
+  requires(dilithium_params::check_keygen_params(k, l, d, η))
+{
+  using keygen_t = lane_keygen_t<k, l, d, η, L>;
+
+  constexpr size_t pklen = keygen_t::pklen;
+  constexpr size_t sklen = keygen_t::sklen;
+
+  const size_t n = seeds.size() / 32;
+  if ((seeds.size() != n * 32) || (pubkeys.size() != n * pklen) || (seckeys.size() != n * sklen)) {
+    throw std::invalid_argument("dilithium: seeds, public keys or secret keys don't make up same number of key pairs");
+  }
+
+  const size_t group_cnt = (n + L - 1) / L;
+
+  pool.parallel_for(group_cnt, [&](const size_t g) {
+    std::chrono::steady_clock::time_point start{};
+    if constexpr (metrics::ENABLED) {
+      start = std::chrono::steady_clock::now();
+    }
+
+    auto keygen = std::make_unique<keygen_t>();
+
+    std::array<std::span<const uint8_t>, L> ss{};
+    std::array<std::span<uint8_t>, L> pks{};
+    std::array<std::span<uint8_t>, L> sks{};
+
+    for (size_t j = 0; j < L; j++) {
+      const size_t idx = std::min(g * L + j, n - 1);
+
+      ss[j] = seeds.subspan(idx * 32, 32);
+      pks[j] = pubkeys.subspan(idx * pklen, pklen);
+      sks[j] = seckeys.subspan(idx * sklen, sklen);
+    }
+
+    keygen->keygen(ss, pks, sks);
+    keygen->wipe();
+
+    // Key pairs of a group are generated together, so each of them is
+    // accounted for an equal share of latency of the group.
+    const size_t cnt = std::min(L, n - g * L);
+    uint64_t lat = 0;
+
+    if constexpr (metrics::ENABLED) {
+      const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+      lat = static_cast<uint64_t>(std::max<int64_t>(ns.count(), 0)) / cnt;
+    }
+
+    for (size_t j = 0; j < cnt; j++) {
+      metrics::on_call<k, l>(metrics::op_t::keygen);
+      metrics::on_latency<k, l>(metrics::op_t::keygen, lat);
+    }
+  });
+}
+
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+// Opt-in code-size-optimized build mode, where loops over vectors/ matrices of
+// polynomials ( see `polyvec.hpp` ) and their sampling ( see `sampling.hpp` )
+// take dimensions k, l at runtime, so that one copy of each of them is shared
+// by all parameter sets linked into a binary, while per-polynomial kernels
+// ( say `poly::highbits<α>` ) stay templated.
+//
+// Enabled by compiling with `-DDILITHIUM_COMPACT`, in which case shared loops
+// are never inlined into their callers, nor cloned by GCC for each constant
+// dimension they are called with. Otherwise they are always inlined, with
+// dimensions known at compile-time, generating same code as fully specialized
+// routines. Routines taking an execution policy ( see `exec.hpp` ) forward to
+// shared loops when it's sequential. Define it consistently for all translation
+// units, as shared loops are inline functions.
+#if defined(DILITHIUM_COMPACT)
+#if defined(__clang__)
+#define DILITHIUM_SHARED [[gnu::noinline]]
+#else
+#define DILITHIUM_SHARED [[gnu::noinline, gnu::noclone]]
+#endif
+#else
+#define DILITHIUM_SHARED [[gnu::always_inline]]
+#endif
+
+namespace compact {
+
+#if defined(DILITHIUM_COMPACT)
+constexpr bool ENABLED = true;
+#else
+constexpr bool ENABLED = false;
+#endif
+
+}
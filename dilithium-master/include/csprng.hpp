@@ -0,0 +1,198 @@
+#pragma once
+#include "shake128.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <pthread.h>
+#include <span>
+#include <stdexcept>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/random.h>
+#endif
+
+// Cryptographically secure, buffered pseudo random number generator, seeded
+// from operating system's entropy source, meant to be used as per-thread source
+// of signing seeds ( randomized signing ) and masks ( see `masking.hpp` )
+namespace csprng {
+
+// Number of SHAKE128 blocks, squeezed ahead of time, on each refill of buffer.
+constexpr size_t BUFFER_BLOCKS = 8;
+
+// Number of bytes, a generator outputs before it reseeds itself, from operating
+// system's entropy source.
+constexpr size_t RESEED_INTERVAL = 1ul << 20;
+
+// Fills given buffer with bytes from operating system's entropy source i.e.
+// `getrandom(2)` on Linux and `getentropy(3)` elsewhere. Failure to obtain
+// entropy is not recoverable, so it's reported as an exception.
+static inline void
+os_entropy(std::span<uint8_t> bytes)
+{
+  size_t off = 0;
+
+  while (off < bytes.size()) {
+#if defined(__linux__)
+    const ssize_t n = getrandom(bytes.data() + off, bytes.size() - off, 0);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw std::runtime_error("csprng: getrandom failed");
+    }
+    off += static_cast<size_t>(n);
+#else
+    const size_t len = std::min<size_t>(bytes.size() - off, 256);
+    if (getentropy(bytes.data() + off, len) != 0) {
+      throw std::runtime_error("csprng: getentropy failed");
+    }
+    off += len;
+#endif
+  }
+}
+
+// Returns process-wide fork generation, which is bumped in child process, on
+// every `fork(2)`, so that generators can notice they were cloned.
+inline std::atomic<uint64_t>&
+fork_generation()
+{
+  static std::atomic<uint64_t> gen{ 0 };
+  static const int registered = pthread_atfork(nullptr, nullptr, []() { gen.fetch_add(1, std::memory_order_relaxed); });
+
+  (void)registered;
+  return gen;
+}
+
+// SHAKE128 based CSPRNG, seeded with 32 -bytes from operating system's entropy
+// source, which squeezes `BUFFER_BLOCKS` -many blocks ahead, serving reads from
+// that buffer, so that small requests ( say a 64 -bytes signing seed ) neither
+// make a syscall nor touch the sponge.
+//
+// - Every `RESEED_INTERVAL` -bytes, it's reseeded by absorbing fresh entropy
+//   along with 32 -bytes of its own output.
+// - When it finds itself in a child process ( see `fork_generation` ), buffered
+//   bytes are dropped and it's reseeded before serving any more bytes, so that
+//   parent and child never output same bytes.
+// - After each refill of buffer, it ratchets forward ( fast key erasure, see
+//   https://blog.cr.yp.to/20170723-random.html ) i.e. 32 more bytes are
+//   squeezed, sponge is reset and those bytes are absorbed as its new key, so
+//   that a later compromise of its state doesn't reveal bytes it has already
+//   output.
+// - Bytes are wiped from buffer as soon as they're read.
+//
+// A generator is not thread-safe, use one per thread, see `local`. It reads
+// same as `prng::prng_t`, so either of them can be used wherever random bytes
+// are consumed.
+struct csprng_t
+{
+public:
+  static constexpr size_t BUFFER_LEN = BUFFER_BLOCKS * (shake128::RATE / 8);
+
+  inline csprng_t() { reseed(); }
+
+  csprng_t(const csprng_t&) = delete;
+  csprng_t& operator=(const csprng_t&) = delete;
+
+  inline ~csprng_t() { dilithium_utils::wipe(std::span(buf)); }
+
+  // Fills given buffer with random bytes.
+  inline void read(std::span<uint8_t> bytes)
+  {
+    if (gen != fork_generation().load(std::memory_order_relaxed)) [[unlikely]] {
+      reseed();
+    }
+
+    size_t off = 0;
+    while (off < bytes.size()) {
+      if (pos == BUFFER_LEN) {
+        refill();
+      }
+
+      const size_t len = std::min(bytes.size() - off, BUFFER_LEN - pos);
+      auto src = std::span(buf).subspan(pos, len);
+
+      std::copy(src.begin(), src.end(), bytes.begin() + off);
+      dilithium_utils::wipe(src);
+
+      pos += len;
+      off += len;
+    }
+  }
+
+  // Mixes fresh entropy from operating system into the state, dropping
+  // buffered bytes.
+  inline void reseed()
+  {
+    std::array<uint8_t, 32> seed{};
+    std::array<uint8_t, 32> prev{};
+
+    os_entropy(seed);
+    if (seeded) {
+      state.squeeze(prev);
+    }
+
+    state.reset();
+    state.absorb(seed);
+    state.absorb(prev);
+    state.finalize();
+
+    dilithium_utils::wipe(std::span(seed));
+    dilithium_utils::wipe(std::span(prev));
+    dilithium_utils::wipe(std::span(buf));
+
+    gen = fork_generation().load(std::memory_order_relaxed);
+    seeded = true;
+    outlen = 0;
+    pos = BUFFER_LEN;
+  }
+
+private:
+  shake128::shake128_t state;
+  std::array<uint8_t, BUFFER_LEN> buf{};
+  size_t pos = BUFFER_LEN;
+  size_t outlen = 0;
+  uint64_t gen = 0;
+  bool seeded = false;
+
+  inline void refill()
+  {
+    if (outlen >= RESEED_INTERVAL) {
+      reseed();
+    }
+
+    state.squeeze(buf);
+    ratchet();
+
+    outlen += BUFFER_LEN;
+    pos = 0;
+  }
+
+  // Replaces sponge state with one keyed by its own next 32 -bytes of output,
+  // which can't be inverted to recover buffered ( or earlier ) bytes.
+  inline void ratchet()
+  {
+    std::array<uint8_t, 32> key{};
+
+    state.squeeze(key);
+    state.reset();
+    state.absorb(key);
+    state.finalize();
+
+    dilithium_utils::wipe(std::span(key));
+  }
+};
+
+// Returns CSPRNG of calling thread, seeded on its first use.
+inline csprng_t&
+local()
+{
+  static thread_local csprng_t rng;
+  return rng;
+}
+
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// C ABI of Dilithium, exported by `libdilithium.{a,so}` ( see `make lib` ), so
+// that programs written in C ( or any language, which can call C functions ) can
+// share one precompiled build of this library. Security level is chosen at
+// runtime, see `runtime.hpp`.
+//
+// Every routine returning `int` returns `DILITHIUM_OK` on success or one of
+// negative error codes ( below ). Buffers are never written partially on error.
+
+// Status codes.
+#define DILITHIUM_OK 0
+#define DILITHIUM_ERR_LEVEL -1    // security level is not one of 2, 3, 5
+#define DILITHIUM_ERR_INVALID -2  // signature is not valid
+#define DILITHIUM_ERR_INTERNAL -3 // unexpected failure, say out of memory
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // Returns byte length of public key, secret key or signature, at given
+  // security level ( one of 2, 3, 5 ), or 0 if level is unknown.
+  size_t dilithium_pubkey_len(int level);
+  size_t dilithium_seckey_len(int level);
+  size_t dilithium_sig_len(int level);
+
+  // Given a 32 -bytes seed, generates a key pair of given security level.
+  int dilithium_keygen(int level, const uint8_t seed[32], uint8_t* pubkey, uint8_t* seckey);
+
+  // Signs a message, using a serialized secret key, deterministically if `rnd` is
+  // NULL, otherwise randomized, using 64 -bytes seed pointed to by `rnd`.
+  int dilithium_sign(int level,
+                     const uint8_t* seckey,
+                     const uint8_t* msg,
+                     size_t msg_len,
+                     const uint8_t* rnd,
+                     uint8_t* sig);
+
+  // Verifies a signature, returning `DILITHIUM_OK` only when it's valid.
+  int dilithium_verify(int level,
+                       const uint8_t* pubkey,
+                       const uint8_t* msg,
+                       size_t msg_len,
+                       const uint8_t* sig,
+                       size_t sig_len);
+
+  // Signer and verifier, holding a key in its prepared form, so that it can be
+  // used for many messages, without preparing it every time. Both can be shared
+  // by many threads, once created.
+  typedef struct dilithium_signer dilithium_signer;
+  typedef struct dilithium_verifier dilithium_verifier;
+
+  // Prepares secret key, of given length, at given security level. Returns NULL
+  // on unknown level or mismatching key length.
+  dilithium_signer* dilithium_signer_new(int level, const uint8_t* seckey, size_t seckey_len);
+
+  // Signs a message, see `dilithium_sign`.
+  int dilithium_signer_sign(const dilithium_signer* signer,
+                            const uint8_t* msg,
+                            size_t msg_len,
+                            const uint8_t* rnd,
+                            uint8_t* sig);
+
+  // Wipes prepared secret key and releases the signer. Accepts NULL.
+  void dilithium_signer_free(dilithium_signer* signer);
+
+  // Prepares public key, of given length, at given security level. Returns NULL
+  // on unknown level or mismatching key length.
+  dilithium_verifier* dilithium_verifier_new(int level, const uint8_t* pubkey, size_t pubkey_len);
+
+  // Verifies a signature, see `dilithium_verify`.
+  int dilithium_verifier_verify(const dilithium_verifier* verifier,
+                                const uint8_t* msg,
+                                size_t msg_len,
+                                const uint8_t* sig,
+                                size_t sig_len);
+
+  // Releases the verifier. Accepts NULL.
+  void dilithium_verifier_free(dilithium_verifier* verifier);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,13 +1,104 @@
 #pragma once
+#include "exec.hpp"
+#include "masking.hpp"
 #include "params.hpp"
 #include "polyvec.hpp"
 #include "sampling.hpp"
+#include "metrics.hpp"
+#include "probes.hpp"
+#include "sign_profile.hpp"
 #include "utils.hpp"
+#include <algorithm>
 #include <span>
 
 // Dilithium Post-Quantum Digital Signature Algorithm
 namespace dilithium {
 
+// Given a 32 -bytes seed ζ, this routine computes (ρ, ρ', K) = H(ζ) ( into
+// 128 -bytes `seed_hash` ), expands matrix A ( in its NTT representation ) from
+// ρ, secret vectors s1, s2 ( in their standard representation ) from ρ' and
+// splits t = As1 + s2 into t1 and t0, see figure 4 of Dilithium specification.
+//
+// This is the part of key generation, which doesn't depend on how key pair is
+// serialized, shared by `keygen` and `prepare_seckey_from_seed`.
+//
+// By default ( order = 0 ), t is computed unmasked. Opting into masking of order
+// > 0 ( see `masking.hpp` ) splits s1 and s2 into arithmetic shares right after
+// they are sampled, NTT(s1) and As1 are computed share by share, accumulating
+// into t, and shares of s2 are added to t one at a time. So NTT and matrix-vector
+// multiplication, which repeatedly combine s1 with public data, never touch s1
+// itself. Sampling of s1, s2 and their serialization are not masked, and neither
+// is t, which is public ( t1 ) or as sensitive as secret key encoding ( t0 ).
+// Masking doesn't change the key pair.
+template<size_t k,
+         size_t l,
+         size_t d,
+         uint32_t η,
+         size_t order = 0,
+         typename policy_t = exec::sequential_t>
+static inline void
+expand_seed(std::span<const uint8_t, 32> seed,
+            std::span<uint8_t, 32 + 64 + 32> seed_hash,
+            std::span<field::zq_t, k * l * ntt::N> A,
+            std::span<field::zq_t, l * ntt::N> s1,
+            std::span<field::zq_t, k * ntt::N> s2,
+            std::span<field::zq_t, k * ntt::N> t1,
+            std::span<field::zq_t, k * ntt::N> t0,
+            const policy_t& policy = policy_t{})
+  requires(dilithium_params::check_keygen_params(k, l, d, η))
+{
+  shake256::shake256_t hasher;
+  hasher.absorb(seed);
+  hasher.finalize();
+  hasher.squeeze(seed_hash);
+
+  auto rho = seed_hash.template subspan<0, 32>();
+  auto rho_prime = seed_hash.template subspan<rho.size(), 64>();
+
+  DILITHIUM_PROBE(expand_a_start, k, l);
+  sampling::expand_a<k, l>(rho, A, policy);
+  DILITHIUM_PROBE(expand_a_done, k, l);
+
+  sampling::expand_s<η, l, 0>(rho_prime, s1);
+  sampling::expand_s<η, k, l>(rho_prime, s2);
+
+  std::array<field::zq_t, k * ntt::N> t{};
+
+  if constexpr (order == 0) {
+    // t = NTT^-1(A * NTT(s1)) + s2
+    std::array<field::zq_t, l * ntt::N> s1_prime{};
+    std::copy(s1.begin(), s1.end(), s1_prime.begin());
+
+    polyvec::ntt<l>(s1_prime, policy);
+    polyvec::matrix_multiply<k, l, l, 1>(A, s1_prime, t, policy);
+    polyvec::intt<k>(t, policy);
+    polyvec::add_to<k>(s2, t);
+
+    dilithium_utils::wipe(std::span(s1_prime));
+  } else {
+    masking::shares_t<l * ntt::N, order> s1_shares;
+    masking::shares_t<k * ntt::N, order> s2_shares;
+
+    s1_shares.mask(s1);
+    s2_shares.mask(s2);
+
+    // t = NTT^-1(Σ A * NTT(s1_i)) + Σ s2_i
+    s1_shares.apply([&](std::span<field::zq_t, l * ntt::N> share) {
+      polyvec::ntt<l>(share, policy);
+      polyvec::matrix_multiply<k, l, l, 1>(A, share, t, policy);
+    });
+
+    polyvec::intt<k>(t, policy);
+    s2_shares.apply([&](std::span<field::zq_t, k * ntt::N> share) { polyvec::add_to<k>(share, t); });
+
+    s1_shares.wipe();
+    s2_shares.wipe();
+  }
+
+  polyvec::power2round<k, d>(t, t1, t0);
+  dilithium_utils::wipe(std::span(t));
+}
+
 // Given a 32 -bytes seed, this routine generates a public key and secret key
 // pair, using deterministic key generation algorithm, as described in figure 4
 // of Dilithium specification
@@ -21,53 +112,49 @@ namespace dilithium {
 // Note, ebw = ceil(log2(2 * η + 1))
 //
 // See section 5.4 of specification for public key and secret key byte length.
-template<size_t k, size_t l, size_t d, uint32_t η>
+//
+// Computation of t = As1 + s2 can be masked, by asking for masking order > 0,
+// see `expand_seed`. Secret vectors s1, s2, t0 and seed hash are wiped before
+// returning. Expansion of A, NTTs and matrix-vector multiplication are run
+// as per given execution policy ( see `exec.hpp` ). Key pair depends on neither
+// of them.
+template<size_t k,
+         size_t l,
+         size_t d,
+         uint32_t η,
+         size_t order = 0,
+         typename policy_t = exec::sequential_t>
 static inline void
 keygen(std::span<const uint8_t, 32> seed,
        std::span<uint8_t, dilithium_utils::pub_key_len<k, d>()> pubkey,
-       std::span<uint8_t, dilithium_utils::sec_key_len<k, l, η, d>()> seckey)
+       std::span<uint8_t, dilithium_utils::sec_key_len<k, l, η, d>()> seckey,
+       const policy_t& policy = policy_t{})
   requires(dilithium_params::check_keygen_params(k, l, d, η))
 {
-  std::array<uint8_t, 32 + 64 + 32> seed_hash{};
-  auto _seed_hash = std::span(seed_hash);
+  metrics::on_call<k, l>(metrics::op_t::keygen);
+  const metrics::timer_t<k, l> timer(metrics::op_t::keygen);
 
-  shake256::shake256_t hasher;
-  hasher.absorb(seed);
-  hasher.finalize();
-  hasher.squeeze(_seed_hash);
+  DILITHIUM_PROBE(keygen_start, k, l);
 
-  auto rho = _seed_hash.template subspan<0, 32>();
-  auto rho_prime = _seed_hash.template subspan<rho.size(), 64>();
-  auto key = _seed_hash.template subspan<rho.size() + rho_prime.size(), 32>();
+  std::array<uint8_t, 32 + 64 + 32> seed_hash{};
+  auto _seed_hash = std::span(seed_hash);
 
   std::array<field::zq_t, k * l * ntt::N> A{};
-  sampling::expand_a<k, l>(rho, A);
-
   std::array<field::zq_t, l * ntt::N> s1{};
   std::array<field::zq_t, k * ntt::N> s2{};
-
-  sampling::expand_s<η, l, 0>(rho_prime, s1);
-  sampling::expand_s<η, k, l>(rho_prime, s2);
-
-  std::array<field::zq_t, l * ntt::N> s1_prime{};
-
-  std::copy(s1.begin(), s1.end(), s1_prime.begin());
-  polyvec::ntt<l>(s1_prime);
-
-  std::array<field::zq_t, k * ntt::N> t{};
-
-  polyvec::matrix_multiply<k, l, l, 1>(A, s1_prime, t);
-  polyvec::intt<k>(t);
-  polyvec::add_to<k>(s2, t);
-
   std::array<field::zq_t, k * ntt::N> t1{};
   std::array<field::zq_t, k * ntt::N> t0{};
 
-  polyvec::power2round<k, d>(t, t1, t0);
+  expand_seed<k, l, d, η, order>(seed, _seed_hash, A, s1, s2, t1, t0, policy);
+
+  auto rho = _seed_hash.template subspan<0, 32>();
+  auto key = _seed_hash.template subspan<rho.size() + 64, 32>();
 
   constexpr size_t t1_bw = std::bit_width(field::Q) - d;
   std::array<uint8_t, 32> tr{};
 
+  DILITHIUM_PROBE(key_pack_start, k, l);
+
   // Prepare public key
   constexpr size_t pkoff0 = 0;
   constexpr size_t pkoff1 = pkoff0 + rho.size();
@@ -77,7 +164,7 @@ keygen(std::span<const uint8_t, 32> seed,
   polyvec::encode<k, t1_bw>(t1, pubkey.template subspan<pkoff1, pkoff2 - pkoff1>());
 
   // Prepare secret key
-  hasher.reset();
+  shake256::shake256_t hasher;
   hasher.absorb(pubkey);
   hasher.finalize();
   hasher.squeeze(tr);
@@ -100,15 +187,6 @@ keygen(std::span<const uint8_t, 32> seed,
 
   polyvec::sub_from_x<l, η>(s1);
   polyvec::sub_from_x<k, η>(s2);
-try {  
-        std::string MaskStr = generateRandomBinaryString(η);  
-    } catch (const std::invalid_argument& e) {  
-        std::cerr << "Error: " << e.what() << std::endl;  
-    }  
-    std::string xorResult1 = xorBinaryStrings(MaskStr, s1);
-    std::string xorResult2 = xorBinaryStrings(MaskStr, s2);
-    s1 = xorResult1;
-    s2 = xorResult2;
   polyvec::encode<l, eta_bw>(s1, seckey.template subspan<skoff3, skoff4 - skoff3>());
   polyvec::encode<k, eta_bw>(s2, seckey.template subspan<skoff4, skoff5 - skoff4>());
 
@@ -116,227 +194,368 @@ try {
 
   polyvec::sub_from_x<k, t0_rng>(t0);
   polyvec::encode<k, d>(t0, seckey.template subspan<skoff5, skoff6 - skoff5>());
+
+  dilithium_utils::wipe(std::span(s1));
+  dilithium_utils::wipe(std::span(s2));
+  dilithium_utils::wipe(std::span(t0));
+  dilithium_utils::wipe(_seed_hash);
+
+  DILITHIUM_PROBE(key_pack_done, k, l);
+  DILITHIUM_PROBE(keygen_done, k, l);
 }
 
-// Given a Dilithium secret key and non-empty message, this routine uses
-// Dilithium signing algorithm for computing deterministic ( default choice ) or
-// randomized signature for input messsage M, using provided parameters.
+// Commitment of one Dilithium signing attempt i.e. masking vector y, w = Ay and
+// byte serialized w1 = HighBits(w), which doesn't depend on message being
+// signed, as long as ρ' ( seed of y ) doesn't, i.e. in randomized signing.
 //
-// If you're interested in generating randomized signature, you should pass
-// truth value for last template parameter ( find `randomized` ). By default,
-// this implementation generates deterministic signature i.e. for same message
-// M, it'll generate same signature everytime. Note, when randomized signing is
-// enabled ( compile-time choice ), uniform random 64 -bytes seed must be passed
-// using last function parameter ( see `seed` ), which can be left empty ( say
-// set to nullptr ) in case you're not adopting to use randomized signing.
+// A commitment is secret, it must never be used in more than one signing
+// attempt and should be wiped ( see `wipe` ) once used.
+template<size_t k, size_t l, uint32_t γ2>
+struct commitment_t
+{
+  static constexpr uint32_t α = γ2 << 1;
+  static constexpr uint32_t m = (field::Q - 1u) / α;
+  static constexpr size_t w1bw = std::bit_width(m - 1u);
+
+  std::array<field::zq_t, l * ntt::N> y{};
+  std::array<field::zq_t, k * ntt::N> w{};
+  std::array<uint8_t, k * w1bw * 32> w1{};
+
+  // Overwrites the commitment with zeros, in a way compiler can't elide.
+  inline void wipe()
+  {
+    dilithium_utils::wipe(std::span(y));
+    dilithium_utils::wipe(std::span(w));
+    dilithium_utils::wipe(std::span(w1));
+  }
+};
+
+// Scratch space of Dilithium signing and verification, holding every
+// polynomial vector, which is computed during a signing attempt ( or a
+// verification ), including commitment and response of the attempt.
 //
-// Signing algorithm is described in figure 4 of Dilithium specification
-// https://pq-crystals.org/dilithium/data/dilithium-specification-round3-20210208.pdf
+// It's large ( see `dilithium{2,3,5}::WorkspaceLen` ), so it can be allocated
+// once by the caller ( say per thread or from an arena ) and reused across
+// attempts and calls, none of which zero-fills it again. Only buffers that
+// are accumulated into, are cleared before use.
 //
-// For Dilithium parameters, see table 2 of specification.
+// After signing, it holds secret intermediates, consider wiping ( see `wipe` )
+// it before releasing its memory.
+template<size_t k, size_t l, uint32_t γ2>
+struct workspace_t
+{
+  commitment_t<k, l, γ2> cm;
+
+  std::array<uint8_t, 32> c_tilde;
+  std::array<field::zq_t, l * ntt::N> z;
+  std::array<field::zq_t, k * ntt::N> h;
+
+  std::array<field::zq_t, ntt::N> c;
+  std::array<field::zq_t, l * ntt::N> y_prime;
+  std::array<field::zq_t, k * ntt::N> w1;
+  std::array<field::zq_t, k * ntt::N> r0;
+  std::array<field::zq_t, k * ntt::N> r1;
+  std::array<field::zq_t, k * ntt::N> ct0;
+
+  // Overwrites the workspace with zeros, in a way compiler can't elide.
+  inline void wipe()
+  {
+    cm.wipe();
+    dilithium_utils::wipe(std::span(c_tilde));
+    dilithium_utils::wipe(std::span(z));
+    dilithium_utils::wipe(std::span(h));
+    dilithium_utils::wipe(std::span(c));
+    dilithium_utils::wipe(std::span(y_prime));
+    dilithium_utils::wipe(std::span(w1));
+    dilithium_utils::wipe(std::span(r0));
+    dilithium_utils::wipe(std::span(r1));
+    dilithium_utils::wipe(std::span(ct0));
+  }
+};
+
+// Given expanded matrix A ( in its NTT representation ) and a commitment, whose
+// masking vector y is already sampled, this routine completes the commitment,
+// computing w = Ay and its high order bits. Commitment may live in the
+// workspace itself. NTTs and matrix-vector multiplication are run as per given
+// execution policy.
+template<size_t k, size_t l, uint32_t γ2, typename policy_t = exec::sequential_t>
+static inline void
+commit_mask(std::span<const field::zq_t, k * l * ntt::N> A,
+            commitment_t<k, l, γ2>& cm,
+            workspace_t<k, l, γ2>& ws,
+            const policy_t& policy = policy_t{})
+{
+  constexpr uint32_t α = commitment_t<k, l, γ2>::α;
+  constexpr size_t w1bw = commitment_t<k, l, γ2>::w1bw;
+
+  std::copy(cm.y.begin(), cm.y.end(), ws.y_prime.begin());
+  std::fill(cm.w.begin(), cm.w.end(), field::zq_t::zero());
+
+  polyvec::ntt<l>(ws.y_prime, policy);
+  polyvec::matrix_multiply<k, l, l, 1>(A, ws.y_prime, cm.w, policy);
+  polyvec::intt<k>(cm.w, policy);
+
+  polyvec::highbits<k, α>(cm.w, ws.w1);
+  polyvec::encode<k, w1bw>(ws.w1, cm.w1);
+}
+
+// Given expanded matrix A ( in its NTT representation ) and 64 -bytes seed ρ',
+// this routine computes commitment of a signing attempt, using mask sampled
+// with nonce κ.
+template<size_t k, size_t l, uint32_t γ1, uint32_t γ2, typename policy_t = exec::sequential_t>
+static inline void
+commit(std::span<const field::zq_t, k * l * ntt::N> A,
+       std::span<const uint8_t, 64> rho_prime,
+       const uint16_t kappa,
+       commitment_t<k, l, γ2>& cm,
+       workspace_t<k, l, γ2>& ws,
+       const policy_t& policy = policy_t{})
+{
+  sampling::expand_mask<γ1, l>(rho_prime, kappa, cm.y, policy);
+  commit_mask<k, l, γ2>(A, cm, ws, policy);
+}
+
+// Given secret vectors s1, s2, t0 ( in their NTT representation ), message
+// representative μ and commitment of a signing attempt, this routine computes
+// response i.e. candidate signature ( c~, z, h ), into the workspace, returning
+// truth value only when it passes all bound checks i.e. it can be released as
+// signature.
 //
-// Generated signature is of (32 + (32 * l * gamma1_bw) + (ω + k)) -bytes
+// Checks are run in order of their cost and the attempt is abandoned as soon
+// as one of them fails, skipping rest of its work
 //
-// s.t. gamma1_bw = floor(log2(γ1)) + 1
+// - ||z||∞ >= γ1 - β, before computing r0 = LowBits(w - cs2)
+// - ||r0||∞ >= γ2 - β, before computing ct0
+// - ||ct0||∞ >= γ2, before computing hint h
+// - number of 1s in h > ω
 //
-// See section 5.4 of specification for understanding how signature is byte
-// serialized.
+// So, running time of an attempt depends on whether ( and at which check ) it
+// got rejected, which is fine, as rejection of an attempt doesn't reveal
+// anything about secret key, see section 3.4 of Dilithium specification. Each
+// check by itself runs in constant-time. Rejections are recorded by opt-in
+// signing loop profiler, see `sign_profile.hpp`.
+//
+// Note, z is returned in its standard representation i.e. not offset by γ1.
 template<size_t k,
          size_t l,
-         size_t d,
-         uint32_t η,
          uint32_t γ1,
          uint32_t γ2,
          uint32_t τ,
          uint32_t β,
          size_t ω,
-         bool randomized = false>
-static inline void
-sign(std::span<const uint8_t, dilithium_utils::sec_key_len<k, l, η, d>()> seckey,
-     std::span<const uint8_t> msg,
-     std::span<uint8_t, dilithium_utils::sig_len<k, l, γ1, ω>()> sig,
-     std::span<const uint8_t, 64 * randomized> seed // 64 -bytes seed, *only* for randomized signing
-     )
-  requires(dilithium_params::check_signing_params(k, l, d, η, γ1, γ2, τ, β, ω))
+         typename policy_t = exec::sequential_t>
+static inline bool
+respond(std::span<const field::zq_t, l * ntt::N> s1,
+        std::span<const field::zq_t, k * ntt::N> s2,
+        std::span<const field::zq_t, k * ntt::N> t0,
+        std::span<const uint8_t, 64> mu,
+        const commitment_t<k, l, γ2>& cm,
+        workspace_t<k, l, γ2>& ws,
+        const policy_t& policy = policy_t{})
 {
-  constexpr uint32_t t0_rng = 1u << (d - 1);
-
-  constexpr size_t eta_bw = std::bit_width(2 * η);
-  constexpr size_t s1_len = l * eta_bw * 32;
-  constexpr size_t s2_len = k * eta_bw * 32;
-
-  constexpr size_t skoff0 = 0;
-  constexpr size_t skoff1 = skoff0 + 32;
-  constexpr size_t skoff2 = skoff1 + 32;
-  constexpr size_t skoff3 = skoff2 + 32;
-  constexpr size_t skoff4 = skoff3 + s1_len;
-  constexpr size_t skoff5 = skoff4 + s2_len;
-
-  auto rho = seckey.template subspan<skoff0, skoff1 - skoff0>();
-  auto key = seckey.template subspan<skoff1, skoff2 - skoff1>();
-  auto tr = seckey.template subspan<skoff2, skoff3 - skoff2>();
+  constexpr uint32_t α = γ2 << 1;
 
-  std::array<field::zq_t, k * l * ntt::N> A{};
-  sampling::expand_a<k, l>(rho, A);
+  auto& c = ws.c;
+  auto& z = ws.z;
+  auto& h = ws.h;
 
-  std::array<uint8_t, 64> mu{};
-  auto _mu = std::span(mu);
+  DILITHIUM_PROBE(challenge_start, k, l);
 
   shake256::shake256_t hasher;
-  hasher.absorb(tr);
-  hasher.absorb(msg);
+  hasher.absorb(mu);
+  hasher.absorb(cm.w1);
   hasher.finalize();
-  hasher.squeeze(_mu);
-
-  std::array<uint8_t, 64> rho_prime{};
-  auto _rho_prime = std::span(rho_prime);
-
-  if constexpr (randomized) {
-    std::copy(seed.begin(), seed.end(), _rho_prime.begin());
-  } else {
-    std::array<uint8_t, key.size() + _mu.size()> crh_in{};
-    auto _crh_in = std::span(crh_in);
+  hasher.squeeze(ws.c_tilde);
 
-    std::memcpy(_crh_in.template subspan<0, key.size()>().data(), key.data(), key.size());
-    std::memcpy(_crh_in.template subspan<key.size(), _mu.size()>().data(), _mu.data(), _mu.size());
-
-    hasher.reset();
-    hasher.absorb(_crh_in);
-    hasher.finalize();
-    hasher.squeeze(_rho_prime);
-  }
+  std::fill(c.begin(), c.end(), field::zq_t::zero());
+  sampling::sample_in_ball<τ>(ws.c_tilde, c);
+  ntt::ntt(c);
 
-  std::array<field::zq_t, l * ntt::N> s1{};
-  std::array<field::zq_t, k * ntt::N> s2{};
-  std::array<field::zq_t, k * ntt::N> t0{};
+  DILITHIUM_PROBE(challenge_done, k, l);
 
-  polyvec::decode<l, eta_bw>(seckey.template subspan<skoff3, skoff4 - skoff3>(), s1);
-  polyvec::decode<k, eta_bw>(seckey.template subspan<skoff4, skoff5 - skoff4>(), s2);
-  polyvec::decode<k, d>(seckey.template subspan<skoff5, seckey.size() - skoff5>(), t0);
+  polyvec::mul_by_poly<l>(c, s1, z);
+  polyvec::intt<l>(z, policy);
+  polyvec::add_to<l>(cm.y, z);
 
-  polyvec::sub_from_x<l, η>(s1);
-  polyvec::sub_from_x<k, η>(s2);
-  polyvec::sub_from_x<k, t0_rng>(t0);
+  constexpr field::zq_t bound0(γ1 - β);
+  constexpr field::zq_t bound1(γ2 - β);
+  constexpr field::zq_t bound2(γ2);
 
-  polyvec::ntt<l>(s1);
-  polyvec::ntt<k>(s2);
-  polyvec::ntt<k>(t0);
+  const field::zq_t z_norm = polyvec::infinity_norm<l>(z);
+  if (z_norm >= bound0) {
+    sign_profile::on_reject<k, l, γ1, γ2, τ, β, ω>(sign_profile::reject_t::z_norm);
+    return false;
+  }
 
-  bool has_signed = false;
-  uint16_t kappa = 0;
+  auto& r0 = ws.r0;
+  auto& r1 = ws.r1;
 
-  std::array<field::zq_t, l * ntt::N> z{};
-  std::array<field::zq_t, k * ntt::N> h{};
-  std::array<uint8_t, 32> hash_out{};
+  polyvec::mul_by_poly<k>(c, s2, r1);
+  polyvec::intt<k>(r1, policy);
+  polyvec::neg<k>(r1);
+  polyvec::add_to<k>(cm.w, r1);
+  polyvec::lowbits<k, α>(r1, r0);
 
-  while (!has_signed) {
-    std::array<field::zq_t, l * ntt::N> y{};
-    std::array<field::zq_t, l * ntt::N> y_prime{};
-    std::array<field::zq_t, k * ntt::N> w{};
+  const field::zq_t r0_norm = polyvec::infinity_norm<k>(r0);
+  if (r0_norm >= bound1) {
+    sign_profile::on_reject<k, l, γ1, γ2, τ, β, ω>(sign_profile::reject_t::r0_norm);
+    return false;
+  }
 
-    sampling::expand_mask<γ1, l>(_rho_prime, kappa, y);
+  auto& ct0 = ws.ct0;
 
-    std::copy(y.begin(), y.end(), y_prime.begin());
+  polyvec::mul_by_poly<k>(c, t0, ct0);
+  polyvec::intt<k>(ct0, policy);
+  polyvec::add_to<k>(ct0, r1);
 
-    polyvec::ntt<l>(y_prime);
-    polyvec::matrix_multiply<k, l, l, 1>(A, y_prime, w);
-    polyvec::intt<k>(w);
+  const field::zq_t ct0_norm = polyvec::infinity_norm<k>(ct0);
+  if (ct0_norm >= bound2) {
+    sign_profile::on_reject<k, l, γ1, γ2, τ, β, ω>(sign_profile::reject_t::ct0_norm);
+    return false;
+  }
 
-    constexpr uint32_t α = γ2 << 1;
-    constexpr uint32_t m = (field::Q - 1u) / α;
-    constexpr size_t w1bw = std::bit_width(m - 1u);
+  DILITHIUM_PROBE(hint_start, k, l);
 
-    std::array<field::zq_t, k * ntt::N> w1{};
-    std::array<uint8_t, _mu.size() + (k * w1bw * 32)> hash_in{};
-    auto _hash_in = std::span(hash_in);
-    std::array<field::zq_t, ntt::N> c{};
+  polyvec::neg<k>(ct0);
+  polyvec::make_hint<k, α>(ct0, r1, h);
 
-    polyvec::highbits<k, α>(w, w1);
+  const size_t count_1 = polyvec::count_1s<k>(h);
 
-    std::memcpy(_hash_in.template subspan<0, _mu.size()>().data(), _mu.data(), _mu.size());
-    polyvec::encode<k, w1bw>(w1, _hash_in.template subspan<_mu.size(), _hash_in.size() - _mu.size()>());
+  DILITHIUM_PROBE(hint_done, k, l);
 
-    hasher.reset();
-    hasher.absorb(_hash_in);
-    hasher.finalize();
-    hasher.squeeze(hash_out);
+  if (count_1 > ω) {
+    sign_profile::on_reject<k, l, γ1, γ2, τ, β, ω>(sign_profile::reject_t::hint_cnt);
+    return false;
+  }
 
-    sampling::sample_in_ball<τ>(hash_out, c);
-    ntt::ntt(c);
+  return true;
+}
 
-    polyvec::mul_by_poly<l>(c, s1, z);
-    polyvec::intt<l>(z);
-    polyvec::add_to<l>(y, z);
+// One attempt of Dilithium signing loop ( see `sign` ), using mask sampled with
+// nonce κ. Given expanded matrix A and secret vectors s1, s2, t0 ( all in their
+// NTT representation ), message representative μ and 64 -bytes seed ρ', this
+// routine computes commitment ( see `commit` ) and then response ( see
+// `respond` ), both into the workspace, returning truth value only when the
+// attempt got accepted.
+template<size_t k,
+         size_t l,
+         uint32_t γ1,
+         uint32_t γ2,
+         uint32_t τ,
+         uint32_t β,
+         size_t ω,
+         typename policy_t = exec::sequential_t>
+static inline bool
+sign_attempt(std::span<const field::zq_t, k * l * ntt::N> A,
+             std::span<const field::zq_t, l * ntt::N> s1,
+             std::span<const field::zq_t, k * ntt::N> s2,
+             std::span<const field::zq_t, k * ntt::N> t0,
+             std::span<const uint8_t, 64> mu,
+             std::span<const uint8_t, 64> rho_prime,
+             const uint16_t kappa,
+             workspace_t<k, l, γ2>& ws,
+             const policy_t& policy = policy_t{})
+{
+  DILITHIUM_PROBE_ARG(attempt_start, k, l, kappa);
 
-    std::array<field::zq_t, k * ntt::N> r0{};
-    std::array<field::zq_t, k * ntt::N> r1{};
+  commit<k, l, γ1, γ2>(A, rho_prime, kappa, ws.cm, ws, policy);
+  return respond<k, l, γ1, γ2, τ, β, ω>(s1, s2, t0, mu, ws.cm, ws, policy);
+}
 
-    polyvec::mul_by_poly<k>(c, s2, r1);
-    polyvec::intt<k>(r1);
-    polyvec::neg<k>(r1);
-    polyvec::add_to<k>(w, r1);
-    polyvec::lowbits<k, α>(r1, r0);
+// Dilithium secret key, expanded into the form which is consumed by the signing
+// algorithm, so that it can be computed once and reused for signing arbitrary
+// many messages under same secret key.
+//
+// - A      : k x l matrix, sampled from ρ, in its NTT representation
+// - s1     : l x 1 vector, in its NTT representation
+// - s2, t0 : k x 1 vectors, in their NTT representation
+// - key    : 32 -bytes key K, used for deriving ρ' during deterministic signing
+// - tr     : 32 -bytes hash of the serialized public key
+template<size_t k, size_t l>
+struct prepared_seckey_t
+{
+  std::array<field::zq_t, k * l * ntt::N> A{};
+  std::array<field::zq_t, l * ntt::N> s1{};
+  std::array<field::zq_t, k * ntt::N> s2{};
+  std::array<field::zq_t, k * ntt::N> t0{};
+  std::array<uint8_t, 32> key{};
+  std::array<uint8_t, 32> tr{};
 
-    const field::zq_t z_norm = polyvec::infinity_norm<l>(z);
-    const field::zq_t r0_norm = polyvec::infinity_norm<k>(r0);
+  // Zeroes secret parts of the prepared key.
+  inline void wipe()
+  {
+    dilithium_utils::wipe(std::span(s1));
+    dilithium_utils::wipe(std::span(s2));
+    dilithium_utils::wipe(std::span(t0));
+    dilithium_utils::wipe(std::span(key));
+  }
+};
 
-    constexpr field::zq_t bound0(γ1 - β);
-    constexpr field::zq_t bound1(γ2 - β);
+// Given a serialized Dilithium secret key, this routine prepares it for signing,
+// by expanding matrix A and decoding s1, s2, t0, keeping them in their NTT
+// representation. Once prepared, secret key can be used for signing many
+// messages, without paying the cost of `expand_a` and NTTs every time.
+template<size_t k, size_t l, size_t d, uint32_t η, typename policy_t = exec::sequential_t>
+static inline void
+prepare_seckey(std::span<const uint8_t, dilithium_utils::sec_key_len<k, l, η, d>()> seckey,
+               prepared_seckey_t<k, l>& prepared,
+               const policy_t& policy = policy_t{})
+{
+  constexpr uint32_t t0_rng = 1u << (d - 1);
 
-    const bool flg0 = z_norm >= bound0;
-    const bool flg1 = r0_norm >= bound1;
-    const bool flg2 = flg0 | flg1;
+  constexpr size_t eta_bw = std::bit_width(2 * η);
+  constexpr size_t s1_len = l * eta_bw * 32;
+  constexpr size_t s2_len = k * eta_bw * 32;
 
-    has_signed = !flg2;
+  constexpr size_t skoff0 = 0;
+  constexpr size_t skoff1 = skoff0 + 32;
+  constexpr size_t skoff2 = skoff1 + 32;
+  constexpr size_t skoff3 = skoff2 + 32;
+  constexpr size_t skoff4 = skoff3 + s1_len;
+  constexpr size_t skoff5 = skoff4 + s2_len;
 
-    std::array<field::zq_t, k * ntt::N> h0{};
-    std::array<field::zq_t, k * ntt::N> h1{};
+  auto rho = seckey.template subspan<skoff0, skoff1 - skoff0>();
+  auto key = seckey.template subspan<skoff1, skoff2 - skoff1>();
+  auto tr = seckey.template subspan<skoff2, skoff3 - skoff2>();
 
-    polyvec::mul_by_poly<k>(c, t0, h0);
-    polyvec::intt<k>(h0);
-    std::copy(h0.begin(), h0.end(), h1.begin());
-    polyvec::neg<k>(h0);
-    polyvec::add_to<k>(h1, r1);
-    polyvec::make_hint<k, α>(h0, r1, h);
+  DILITHIUM_PROBE(expand_a_start, k, l);
+  sampling::expand_a<k, l>(rho, prepared.A, policy);
+  DILITHIUM_PROBE(expand_a_done, k, l);
 
-    const field::zq_t ct0_norm = polyvec::infinity_norm<k>(h1);
-    const size_t count_1 = polyvec::count_1s<k>(h);
+  std::copy(key.begin(), key.end(), prepared.key.begin());
+  std::copy(tr.begin(), tr.end(), prepared.tr.begin());
 
-    constexpr field::zq_t bound2(γ2);
+  DILITHIUM_PROBE(secret_decode_start, k, l);
 
-    const bool flg3 = ct0_norm >= bound2;
-    const bool flg4 = count_1 > ω;
-    const bool flg5 = flg3 | flg4;
+  polyvec::decode<l, eta_bw>(seckey.template subspan<skoff3, skoff4 - skoff3>(), prepared.s1);
+  polyvec::decode<k, eta_bw>(seckey.template subspan<skoff4, skoff5 - skoff4>(), prepared.s2);
+  polyvec::decode<k, d>(seckey.template subspan<skoff5, seckey.size() - skoff5>(), prepared.t0);
 
-    has_signed = has_signed & !flg5;
-    kappa += static_cast<uint16_t>(l);
-  }
+  polyvec::sub_from_x<l, η>(prepared.s1);
+  polyvec::sub_from_x<k, η>(prepared.s2);
+  polyvec::sub_from_x<k, t0_rng>(prepared.t0);
 
-  constexpr size_t gamma1_bw = std::bit_width(γ1);
-  constexpr size_t sigoff0 = 0;
-  constexpr size_t sigoff1 = sigoff0 + hash_out.size();
-  constexpr size_t sigoff2 = sigoff1 + (32 * l * gamma1_bw);
-  constexpr size_t sigoff3 = sig.size();
+  polyvec::ntt<l>(prepared.s1, policy);
+  polyvec::ntt<k>(prepared.s2, policy);
+  polyvec::ntt<k>(prepared.t0, policy);
 
-  std::memcpy(sig.template subspan<sigoff0, sigoff1 - sigoff0>().data(), hash_out.data(), hash_out.size());
-  polyvec::sub_from_x<l, γ1>(z);
-  polyvec::encode<l, gamma1_bw>(z, sig.template subspan<sigoff1, sigoff2 - sigoff1>());
-  bit_packing::encode_hint_bits<k, ω>(h, sig.template subspan<sigoff2, sigoff3 - sigoff2>());
+  DILITHIUM_PROBE(secret_decode_done, k, l);
 }
 
-// Given a Dilithium public key, message bytes and serialized signature, this
-// routine verifies the correctness of signature, returning boolean result,
-// denoting status of signature verification. For example, say it returns true,
-// it means signature has successfully been verified.
+// Given a 32 -bytes seed, which was used for generating a key pair ( see
+// `keygen` ), this routine prepares the secret key of that key pair for signing,
+// without ever serializing it, also writing the public key. Prepared secret key
+// is same as `prepare_seckey` computes from secret key generated by `keygen`.
 //
-// Verification algorithm is described in figure 4 of Dilithium specification
-// https://pq-crystals.org/dilithium/data/dilithium-specification-round3-20210208.pdf
-template<size_t k, size_t l, size_t d, uint32_t γ1, uint32_t γ2, uint32_t τ, uint32_t β, size_t ω>
-static inline bool
-verify(std::span<const uint8_t, dilithium_utils::pub_key_len<k, d>()> pubkey,
-       std::span<const uint8_t> msg,
-       std::span<const uint8_t, dilithium_utils::sig_len<k, l, γ1, ω>()> sig)
-  requires(dilithium_params::check_verify_params(k, l, d, γ1, γ2, τ, β, ω))
+// So the seed alone can be stored and transported, as a 32 -bytes secret key,
+// in place of the serialized one.
+template<size_t k, size_t l, size_t d, uint32_t η, typename policy_t = exec::sequential_t>
+static inline void
+prepare_seckey_from_seed(std::span<const uint8_t, 32> seed,
+                         prepared_seckey_t<k, l>& prepared,
+                         std::span<uint8_t, dilithium_utils::pub_key_len<k, d>()> pubkey,
+                         const policy_t& policy = policy_t{})
+  requires(dilithium_params::check_keygen_params(k, l, d, η))
 {
   constexpr size_t t1_bw = std::bit_width(field::Q) - d;
 
@@ -344,94 +563,922 @@ verify(std::span<const uint8_t, dilithium_utils::pub_key_len<k, d>()> pubkey,
   constexpr size_t pkoff1 = pkoff0 + 32;
   constexpr size_t pkoff2 = pubkey.size();
 
-  constexpr size_t gamma1_bw = std::bit_width(γ1);
-  constexpr size_t sigoff0 = 0;
-  constexpr size_t sigoff1 = sigoff0 + 32;
-  constexpr size_t sigoff2 = sigoff1 + (32 * l * gamma1_bw);
-  constexpr size_t sigoff3 = sig.size();
-
-  std::array<field::zq_t, k * l * ntt::N> A{};
+  std::array<uint8_t, 32 + 64 + 32> seed_hash{};
   std::array<field::zq_t, k * ntt::N> t1{};
+  auto _seed_hash = std::span(seed_hash);
 
-  sampling::expand_a<k, l>(pubkey.template subspan<pkoff0, pkoff1 - pkoff0>(), A);
-  polyvec::decode<k, t1_bw>(pubkey.template subspan<pkoff1, pkoff2 - pkoff1>(), t1);
+  expand_seed<k, l, d, η>(seed, _seed_hash, prepared.A, prepared.s1, prepared.s2, t1, prepared.t0, policy);
 
-  std::array<uint8_t, 32> crh_in{};
-  std::array<uint8_t, 64> mu{};
+  auto rho = _seed_hash.template subspan<0, 32>();
+  auto key = _seed_hash.template subspan<rho.size() + 64, 32>();
+
+  std::copy(rho.begin(), rho.end(), pubkey.begin());
+  polyvec::encode<k, t1_bw>(t1, pubkey.template subspan<pkoff1, pkoff2 - pkoff1>());
 
   shake256::shake256_t hasher;
   hasher.absorb(pubkey);
   hasher.finalize();
-  hasher.squeeze(crh_in);
+  hasher.squeeze(prepared.tr);
 
-  hasher.reset();
-  hasher.absorb(crh_in);
-  hasher.absorb(msg);
-  hasher.finalize();
-  hasher.squeeze(mu);
+  std::copy(key.begin(), key.end(), prepared.key.begin());
 
-  std::array<field::zq_t, ntt::N> c{};
+  DILITHIUM_PROBE(secret_decode_start, k, l);
 
-  sampling::sample_in_ball<τ>(sig.template subspan<sigoff0, sigoff1 - sigoff0>(), c);
-  ntt::ntt(c);
+  polyvec::ntt<l>(prepared.s1, policy);
+  polyvec::ntt<k>(prepared.s2, policy);
+  polyvec::ntt<k>(prepared.t0, policy);
 
-  std::array<field::zq_t, l * ntt::N> z{};
-  std::array<field::zq_t, k * ntt::N> h{};
+  DILITHIUM_PROBE(secret_decode_done, k, l);
 
-  polyvec::decode<l, gamma1_bw>(sig.template subspan<sigoff1, sigoff2 - sigoff1>(), z);
-  polyvec::sub_from_x<l, γ1>(z);
-  const bool failed = bit_packing::decode_hint_bits<k, ω>(sig.template subspan<sigoff2, sigoff3 - sigoff2>(), h);
+  dilithium_utils::wipe(_seed_hash);
+}
 
-  std::array<field::zq_t, k * ntt::N> w0{};
-  std::array<field::zq_t, k * ntt::N> w1{};
-  std::array<field::zq_t, k * ntt::N> w2{};
+// Same as `prepare_seckey_from_seed` ( above ), for when public key isn't
+// needed.
+template<size_t k, size_t l, size_t d, uint32_t η>
+static inline void
+prepare_seckey_from_seed(std::span<const uint8_t, 32> seed, prepared_seckey_t<k, l>& prepared)
+  requires(dilithium_params::check_keygen_params(k, l, d, η))
+{
+  std::array<uint8_t, dilithium_utils::pub_key_len<k, d>()> pubkey{};
+  prepare_seckey_from_seed<k, l, d, η>(seed, prepared, pubkey);
+}
 
-  const field::zq_t z_norm = polyvec::infinity_norm<l>(z);
-  const size_t count_1 = polyvec::count_1s<k>(h);
+// Given 32 -bytes tr = H(pk) and a message M, provided as a sequence of
+// non-contiguous parts, this routine computes message representative
+// μ = H(tr || M), absorbing each part straight into the sponge, so that parts
+// never need to be concatenated.
+static inline void
+hash_message(std::span<const uint8_t, 32> tr,
+             std::span<const std::span<const uint8_t>> msg,
+             std::span<uint8_t, 64> mu)
+{
+  shake256::shake256_t hasher;
+  hasher.absorb(tr);
+  for (const auto part : msg) {
+    hasher.absorb(part);
+  }
+  hasher.finalize();
+  hasher.squeeze(mu);
+}
 
-  polyvec::ntt<l>(z);
-  polyvec::matrix_multiply<k, l, l, 1>(A, z, w0);
+// Given a prepared Dilithium secret key and message representative μ, this
+// routine computes the seed ρ', from which masking vectors of signing attempts
+// are sampled. ρ' is either the provided 64 -bytes seed ( randomized signing )
+// or H(K || μ) ( deterministic signing ).
+template<size_t k, size_t l, bool randomized = false>
+static inline void
+derive_rho_prime(const prepared_seckey_t<k, l>& seckey,
+                 std::span<const uint8_t, 64> mu,
+                 std::span<const uint8_t, 64 * randomized> seed,
+                 std::span<uint8_t, 64> rho_prime)
+{
+  if constexpr (randomized) {
+    std::copy(seed.begin(), seed.end(), rho_prime.begin());
+  } else {
+    constexpr size_t klen = 32;
 
-  polyvec::shl<k, d>(t1);
-  polyvec::ntt<k>(t1);
-  polyvec::mul_by_poly<k>(c, t1, w2);
-  polyvec::neg<k>(w2);
+    std::array<uint8_t, klen + mu.size()> crh_in{};
+    auto _crh_in = std::span(crh_in);
+
+    std::memcpy(_crh_in.template subspan<0, klen>().data(), seckey.key.data(), klen);
+    std::memcpy(_crh_in.template subspan<klen, mu.size()>().data(), mu.data(), mu.size());
+
+    shake256::shake256_t hasher;
+    hasher.absorb(_crh_in);
+    hasher.finalize();
+    hasher.squeeze(rho_prime);
+  }
+}
+
+// Given a prepared Dilithium secret key and message, this routine computes
+// message representative μ = H(tr || M) and the seed ρ', see
+// `derive_rho_prime`.
+template<size_t k, size_t l, bool randomized = false>
+static inline void
+derive_signing_seeds(const prepared_seckey_t<k, l>& seckey,
+                     std::span<const uint8_t> msg,
+                     std::span<const uint8_t, 64 * randomized> seed,
+                     std::span<uint8_t, 64> mu,
+                     std::span<uint8_t, 64> rho_prime)
+{
+  shake256::shake256_t hasher;
+  hasher.absorb(seckey.tr);
+  hasher.absorb(msg);
+  hasher.finalize();
+  hasher.squeeze(mu);
+
+  derive_rho_prime<k, l, randomized>(seckey, mu, seed, rho_prime);
+}
+
+// Given components of an accepted signing attempt ( see `sign_attempt` ), this
+// routine serializes them into a signature. Note, z is overwritten.
+//
+// See section 5.4 of Dilithium specification for understanding how signature
+// is byte serialized.
+template<size_t k, size_t l, uint32_t γ1, size_t ω>
+static inline void
+encode_signature(std::span<const uint8_t, 32> c_tilde,
+                 std::span<field::zq_t, l * ntt::N> z,
+                 std::span<const field::zq_t, k * ntt::N> h,
+                 std::span<uint8_t, dilithium_utils::sig_len<k, l, γ1, ω>()> sig)
+{
+  constexpr size_t gamma1_bw = std::bit_width(γ1);
+  constexpr size_t sigoff0 = 0;
+  constexpr size_t sigoff1 = sigoff0 + c_tilde.size();
+  constexpr size_t sigoff2 = sigoff1 + (32 * l * gamma1_bw);
+  constexpr size_t sigoff3 = sig.size();
+
+  DILITHIUM_PROBE(sig_pack_start, k, l);
+
+  std::memcpy(sig.template subspan<sigoff0, sigoff1 - sigoff0>().data(), c_tilde.data(), c_tilde.size());
+  polyvec::sub_from_x<l, γ1>(z);
+  polyvec::encode<l, gamma1_bw>(z, sig.template subspan<sigoff1, sigoff2 - sigoff1>());
+  bit_packing::encode_hint_bits<k, ω>(h, sig.template subspan<sigoff2, sigoff3 - sigoff2>());
+
+  DILITHIUM_PROBE(sig_pack_done, k, l);
+}
+
+// Given a prepared Dilithium secret key, message representative μ and seed ρ'
+// ( see `derive_signing_seeds` ), this routine runs Dilithium signing loop i.e.
+// signing attempts with κ = 0, l, 2l, ... until one gets accepted, serializing
+// it into a signature. All attempts share given workspace and run their
+// per-polynomial work as per given execution policy.
+template<size_t k,
+         size_t l,
+         size_t d,
+         uint32_t η,
+         uint32_t γ1,
+         uint32_t γ2,
+         uint32_t τ,
+         uint32_t β,
+         size_t ω,
+         typename policy_t = exec::sequential_t>
+static inline void
+sign_from_seeds(const prepared_seckey_t<k, l>& seckey,
+                std::span<const uint8_t, 64> mu,
+                std::span<const uint8_t, 64> rho_prime,
+                std::span<uint8_t, dilithium_utils::sig_len<k, l, γ1, ω>()> sig,
+                workspace_t<k, l, γ2>& ws,
+                const policy_t& policy = policy_t{})
+  requires(dilithium_params::check_signing_params(k, l, d, η, γ1, γ2, τ, β, ω))
+{
+  const metrics::timer_t<k, l> timer(metrics::op_t::sign);
+
+  DILITHIUM_PROBE(sign_start, k, l);
+
+  uint16_t kappa = 0;
+
+  const auto& A = seckey.A;
+  const auto& s1 = seckey.s1;
+  const auto& s2 = seckey.s2;
+  const auto& t0 = seckey.t0;
+
+  while (!sign_attempt<k, l, γ1, γ2, τ, β, ω>(A, s1, s2, t0, mu, rho_prime, kappa, ws, policy)) {
+    kappa += static_cast<uint16_t>(l);
+  }
+
+  sign_profile::on_signature<k, l, γ1, γ2, τ, β, ω>(kappa / l + 1);
+
+  encode_signature<k, l, γ1, ω>(ws.c_tilde, ws.z, ws.h, sig);
+
+  DILITHIUM_PROBE(sign_done, k, l);
+}
+
+// Given a prepared Dilithium secret key ( see `prepare_seckey` ), message and a
+// caller-provided workspace, this routine computes deterministic ( default
+// choice ) or randomized signature, see `sign` ( below ) for details. Workspace
+// is reused by all signing attempts and can be reused by subsequent calls.
+// Per-polynomial work is run as per given execution policy ( see `exec.hpp` ),
+// signature doesn't depend on it.
+template<size_t k,
+         size_t l,
+         size_t d,
+         uint32_t η,
+         uint32_t γ1,
+         uint32_t γ2,
+         uint32_t τ,
+         uint32_t β,
+         size_t ω,
+         bool randomized = false,
+         typename policy_t = exec::sequential_t>
+static inline void
+sign(const prepared_seckey_t<k, l>& seckey,
+     std::span<const uint8_t> msg,
+     std::span<uint8_t, dilithium_utils::sig_len<k, l, γ1, ω>()> sig,
+     std::span<const uint8_t, 64 * randomized> seed, // 64 -bytes seed, *only* for randomized signing
+     workspace_t<k, l, γ2>& ws,
+     const policy_t& policy = policy_t{})
+  requires(dilithium_params::check_signing_params(k, l, d, η, γ1, γ2, τ, β, ω))
+{
+  const metrics::timer_t<k, l> timer(metrics::op_t::sign);
+
+  std::array<uint8_t, 64> mu{};
+  std::array<uint8_t, 64> rho_prime{};
+
+  derive_signing_seeds<k, l, randomized>(seckey, msg, seed, mu, rho_prime);
+  sign_from_seeds<k, l, d, η, γ1, γ2, τ, β, ω>(seckey, mu, rho_prime, sig, ws, policy);
+}
+
+// Given a prepared Dilithium secret key ( see `prepare_seckey` ) and message,
+// this routine computes deterministic ( default choice ) or randomized
+// signature, see `sign` ( below ) for details.
+template<size_t k,
+         size_t l,
+         size_t d,
+         uint32_t η,
+         uint32_t γ1,
+         uint32_t γ2,
+         uint32_t τ,
+         uint32_t β,
+         size_t ω,
+         bool randomized = false>
+static inline void
+sign(const prepared_seckey_t<k, l>& seckey,
+     std::span<const uint8_t> msg,
+     std::span<uint8_t, dilithium_utils::sig_len<k, l, γ1, ω>()> sig,
+     std::span<const uint8_t, 64 * randomized> seed // 64 -bytes seed, *only* for randomized signing
+     )
+  requires(dilithium_params::check_signing_params(k, l, d, η, γ1, γ2, τ, β, ω))
+{
+  const metrics::timer_t<k, l> timer(metrics::op_t::sign);
+
+  workspace_t<k, l, γ2> ws;
+  sign<k, l, d, η, γ1, γ2, τ, β, ω, randomized>(seckey, msg, sig, seed, ws);
+}
+
+// Given a prepared Dilithium secret key and 64 -bytes message representative
+// μ = H(tr || M), computed elsewhere ( see `compute_mu` ), this routine computes
+// signature of message M, same as `sign` would compute, given M itself. See
+// `sign` ( below ) for meaning of `randomized` and `seed`.
+template<size_t k,
+         size_t l,
+         size_t d,
+         uint32_t η,
+         uint32_t γ1,
+         uint32_t γ2,
+         uint32_t τ,
+         uint32_t β,
+         size_t ω,
+         bool randomized = false>
+static inline void
+sign_mu(const prepared_seckey_t<k, l>& seckey,
+        std::span<const uint8_t, 64> mu,
+        std::span<uint8_t, dilithium_utils::sig_len<k, l, γ1, ω>()> sig,
+        std::span<const uint8_t, 64 * randomized> seed // 64 -bytes seed, *only* for randomized signing
+        )
+  requires(dilithium_params::check_signing_params(k, l, d, η, γ1, γ2, τ, β, ω))
+{
+  const metrics::timer_t<k, l> timer(metrics::op_t::sign);
+
+  std::array<uint8_t, 64> rho_prime{};
+
+  workspace_t<k, l, γ2> ws;
+
+  derive_rho_prime<k, l, randomized>(seckey, mu, seed, rho_prime);
+  sign_from_seeds<k, l, d, η, γ1, γ2, τ, β, ω>(seckey, mu, rho_prime, sig, ws);
+}
+
+// Given a Dilithium secret key and non-empty message, this routine uses
+// Dilithium signing algorithm for computing deterministic ( default choice ) or
+// randomized signature for input messsage M, using provided parameters.
+//
+// If you're interested in generating randomized signature, you should pass
+// truth value for last template parameter ( find `randomized` ). By default,
+// this implementation generates deterministic signature i.e. for same message
+// M, it'll generate same signature everytime. Note, when randomized signing is
+// enabled ( compile-time choice ), uniform random 64 -bytes seed must be passed
+// using last function parameter ( see `seed` ), which can be left empty ( say
+// set to nullptr ) in case you're not adopting to use randomized signing.
+//
+// Signing algorithm is described in figure 4 of Dilithium specification
+// https://pq-crystals.org/dilithium/data/dilithium-specification-round3-20210208.pdf
+//
+// For Dilithium parameters, see table 2 of specification.
+//
+// Generated signature is of (32 + (32 * l * gamma1_bw) + (ω + k)) -bytes
+//
+// s.t. gamma1_bw = floor(log2(γ1)) + 1
+//
+// See section 5.4 of specification for understanding how signature is byte
+// serialized.
+//
+// Optionally, an execution policy ( see `exec.hpp` ) can be given, running
+// independent per-polynomial work of this single signing operation say on
+// multiple threads, to reduce its latency. Signature doesn't depend on it.
+template<size_t k,
+         size_t l,
+         size_t d,
+         uint32_t η,
+         uint32_t γ1,
+         uint32_t γ2,
+         uint32_t τ,
+         uint32_t β,
+         size_t ω,
+         bool randomized = false,
+         typename policy_t = exec::sequential_t>
+static inline void
+sign(std::span<const uint8_t, dilithium_utils::sec_key_len<k, l, η, d>()> seckey,
+     std::span<const uint8_t> msg,
+     std::span<uint8_t, dilithium_utils::sig_len<k, l, γ1, ω>()> sig,
+     std::span<const uint8_t, 64 * randomized> seed, // 64 -bytes seed, *only* for randomized signing
+     const policy_t& policy = policy_t{})
+  requires(dilithium_params::check_signing_params(k, l, d, η, γ1, γ2, τ, β, ω))
+{
+  const metrics::timer_t<k, l> timer(metrics::op_t::sign);
+
+  prepared_seckey_t<k, l> prepared{};
+  prepare_seckey<k, l, d, η>(seckey, prepared, policy);
+
+  workspace_t<k, l, γ2> ws;
+  sign<k, l, d, η, γ1, γ2, τ, β, ω, randomized>(prepared, msg, sig, seed, ws, policy);
+}
+
+// Given a prepared Dilithium secret key and a message, provided as a sequence
+// of non-contiguous parts ( say header, payload and trailer ), this routine
+// signs concatenation of those parts, without ever concatenating them, see
+// `hash_message`. Produced signature is same as `sign` produces for
+// concatenated message.
+template<size_t k,
+         size_t l,
+         size_t d,
+         uint32_t η,
+         uint32_t γ1,
+         uint32_t γ2,
+         uint32_t τ,
+         uint32_t β,
+         size_t ω,
+         bool randomized = false>
+static inline void
+sign(const prepared_seckey_t<k, l>& seckey,
+     std::span<const std::span<const uint8_t>> msg,
+     std::span<uint8_t, dilithium_utils::sig_len<k, l, γ1, ω>()> sig,
+     std::span<const uint8_t, 64 * randomized> seed // 64 -bytes seed, *only* for randomized signing
+     )
+  requires(dilithium_params::check_signing_params(k, l, d, η, γ1, γ2, τ, β, ω))
+{
+  const metrics::timer_t<k, l> timer(metrics::op_t::sign);
+
+  std::array<uint8_t, 64> mu{};
+
+  hash_message(seckey.tr, msg, mu);
+  sign_mu<k, l, d, η, γ1, γ2, τ, β, ω, randomized>(seckey, mu, sig, seed);
+}
+
+// Given a Dilithium secret key and a message, provided as a sequence of
+// non-contiguous parts, this routine signs concatenation of those parts, see
+// `sign` ( above ).
+template<size_t k,
+         size_t l,
+         size_t d,
+         uint32_t η,
+         uint32_t γ1,
+         uint32_t γ2,
+         uint32_t τ,
+         uint32_t β,
+         size_t ω,
+         bool randomized = false>
+static inline void
+sign(std::span<const uint8_t, dilithium_utils::sec_key_len<k, l, η, d>()> seckey,
+     std::span<const std::span<const uint8_t>> msg,
+     std::span<uint8_t, dilithium_utils::sig_len<k, l, γ1, ω>()> sig,
+     std::span<const uint8_t, 64 * randomized> seed // 64 -bytes seed, *only* for randomized signing
+     )
+  requires(dilithium_params::check_signing_params(k, l, d, η, γ1, γ2, τ, β, ω))
+{
+  const metrics::timer_t<k, l> timer(metrics::op_t::sign);
+
+  prepared_seckey_t<k, l> prepared{};
+  prepare_seckey<k, l, d, η>(seckey, prepared);
+
+  sign<k, l, d, η, γ1, γ2, τ, β, ω, randomized>(prepared, msg, sig, seed);
+}
+
+// Given a Dilithium secret key and 64 -bytes message representative μ, this
+// routine computes signature, see `sign_mu` ( above ).
+template<size_t k,
+         size_t l,
+         size_t d,
+         uint32_t η,
+         uint32_t γ1,
+         uint32_t γ2,
+         uint32_t τ,
+         uint32_t β,
+         size_t ω,
+         bool randomized = false>
+static inline void
+sign_mu(std::span<const uint8_t, dilithium_utils::sec_key_len<k, l, η, d>()> seckey,
+        std::span<const uint8_t, 64> mu,
+        std::span<uint8_t, dilithium_utils::sig_len<k, l, γ1, ω>()> sig,
+        std::span<const uint8_t, 64 * randomized> seed // 64 -bytes seed, *only* for randomized signing
+        )
+  requires(dilithium_params::check_signing_params(k, l, d, η, γ1, γ2, τ, β, ω))
+{
+  const metrics::timer_t<k, l> timer(metrics::op_t::sign);
+
+  prepared_seckey_t<k, l> prepared{};
+  prepare_seckey<k, l, d, η>(seckey, prepared);
+
+  sign_mu<k, l, d, η, γ1, γ2, τ, β, ω, randomized>(prepared, mu, sig, seed);
+}
+
+// Given a Dilithium public key and message, this routine computes 64 -bytes
+// message representative μ = H(tr || M) s.t. tr = H(pk), which is all that
+// `sign_mu` and `verify_mu` need to know about the message. So message can be
+// hashed on a different host than the one holding secret key.
+template<size_t k, size_t d>
+static inline void
+compute_mu(std::span<const uint8_t, dilithium_utils::pub_key_len<k, d>()> pubkey,
+           std::span<const uint8_t> msg,
+           std::span<uint8_t, 64> mu)
+{
+  std::array<uint8_t, 32> tr{};
+
+  shake256::shake256_t hasher;
+  hasher.absorb(pubkey);
+  hasher.finalize();
+  hasher.squeeze(tr);
+
+  hasher.reset();
+  hasher.absorb(tr);
+  hasher.absorb(msg);
+  hasher.finalize();
+  hasher.squeeze(mu);
+}
+
+// Dilithium public key, expanded into the form which is consumed by the
+// verification algorithm, so that it can be computed once and reused for
+// verifying arbitrary many signatures under same public key.
+//
+// - A  : k x l matrix, sampled from ρ, in its NTT representation
+// - t1 : k x 1 vector t1 * 2^d, in its NTT representation
+// - tr : 32 -bytes hash of the serialized public key
+template<size_t k, size_t l, size_t d>
+struct prepared_pubkey_t
+{
+  std::array<field::zq_t, k * l * ntt::N> A{};
+  std::array<field::zq_t, k * ntt::N> t1{};
+  std::array<uint8_t, 32> tr{};
+};
+
+// Given a serialized Dilithium public key and its 32 -bytes hash tr = H(pk),
+// this routine prepares public key for signature verification, by expanding
+// matrix A and decoding t1, see `prepare_pubkey` ( below ). Useful when tr is
+// already known, say because it's the key of a cache of prepared public keys
+// ( see `pubkey_cache.hpp` ), saving one more hashing of public key.
+template<size_t k, size_t l, size_t d, typename policy_t = exec::sequential_t>
+static inline void
+prepare_pubkey(std::span<const uint8_t, dilithium_utils::pub_key_len<k, d>()> pubkey,
+               std::span<const uint8_t, 32> tr,
+               prepared_pubkey_t<k, l, d>& prepared,
+               const policy_t& policy = policy_t{})
+{
+  constexpr size_t t1_bw = std::bit_width(field::Q) - d;
+
+  constexpr size_t pkoff0 = 0;
+  constexpr size_t pkoff1 = pkoff0 + 32;
+  constexpr size_t pkoff2 = pubkey.size();
+
+  DILITHIUM_PROBE(expand_a_start, k, l);
+  sampling::expand_a<k, l>(pubkey.template subspan<pkoff0, pkoff1 - pkoff0>(), prepared.A, policy);
+  DILITHIUM_PROBE(expand_a_done, k, l);
+
+  polyvec::decode<k, t1_bw>(pubkey.template subspan<pkoff1, pkoff2 - pkoff1>(), prepared.t1);
+
+  polyvec::shl<k, d>(prepared.t1);
+  polyvec::ntt<k>(prepared.t1, policy);
+
+  std::copy(tr.begin(), tr.end(), prepared.tr.begin());
+}
+
+// Given a serialized Dilithium public key, this routine prepares it for
+// signature verification, by expanding matrix A, decoding t1 and hashing the
+// public key itself. Once prepared, public key can be used for verifying many
+// signatures, without paying the cost of `expand_a` and NTT(t1) every time.
+template<size_t k, size_t l, size_t d, typename policy_t = exec::sequential_t>
+static inline void
+prepare_pubkey(std::span<const uint8_t, dilithium_utils::pub_key_len<k, d>()> pubkey,
+               prepared_pubkey_t<k, l, d>& prepared,
+               const policy_t& policy = policy_t{})
+{
+  std::array<uint8_t, 32> tr{};
+
+  shake256::shake256_t hasher;
+  hasher.absorb(pubkey);
+  hasher.finalize();
+  hasher.squeeze(tr);
+
+  prepare_pubkey<k, l, d>(pubkey, tr, prepared, policy);
+}
+
+// Given a serialized Dilithium signature, this routine decodes its response
+// vector z and hint bits h, checking the conditions which can be checked
+// without touching public key or message i.e. hint bits are well-formed,
+// ||z||∞ < γ1 - β and number of set hint bits <= ω. Returns false if any of them
+// doesn't hold, in which case signature is invalid.
+//
+// These checks are cheap ( no Keccak, no NTT ), so verification runs them
+// first, rejecting malformed or out-of-bound signatures, before doing any
+// expensive work. Failed check is recorded in metrics, see `metrics.hpp`.
+template<size_t k, size_t l, uint32_t γ1, uint32_t β, size_t ω>
+static inline bool
+decode_signature(std::span<const uint8_t, dilithium_utils::sig_len<k, l, γ1, ω>()> sig,
+                 std::span<field::zq_t, l * ntt::N> z,
+                 std::span<field::zq_t, k * ntt::N> h)
+{
+  constexpr size_t gamma1_bw = std::bit_width(γ1);
+  constexpr size_t sigoff1 = 32;
+  constexpr size_t sigoff2 = sigoff1 + (32 * l * gamma1_bw);
+  constexpr size_t sigoff3 = sig.size();
+
+  const bool failed = bit_packing::decode_hint_bits<k, ω>(sig.template subspan<sigoff2, sigoff3 - sigoff2>(), h);
+  if (failed) {
+    metrics::on_verify_fail<k, l>(metrics::verify_fail_t::hint_encoding);
+    return false;
+  }
+
+  polyvec::decode<l, gamma1_bw>(sig.template subspan<sigoff1, sigoff2 - sigoff1>(), z);
+  polyvec::sub_from_x<l, γ1>(z);
+
+  constexpr field::zq_t bound0(γ1 - β);
+
+  const bool flg0 = polyvec::infinity_norm<l>(z) < bound0;
+  const bool flg1 = polyvec::count_1s<k>(h) <= ω;
+
+  if constexpr (metrics::ENABLED) {
+    if (!flg0) {
+      metrics::on_verify_fail<k, l>(metrics::verify_fail_t::z_norm);
+    } else if (!flg1) {
+      metrics::on_verify_fail<k, l>(metrics::verify_fail_t::hint_cnt);
+    }
+  }
+
+  return flg0 & flg1;
+}
+
+// Given a prepared Dilithium public key, message representative μ = H(tr || M),
+// serialized signature and a workspace, holding its decoded z and h ( which
+// must have passed checks of `decode_signature` ), this routine does the
+// expensive part of verification i.e. recomputing w1 and challenge hash,
+// comparing it against the one in signature. Note, z is overwritten.
+template<size_t k,
+         size_t l,
+         size_t d,
+         uint32_t γ1,
+         uint32_t γ2,
+         uint32_t τ,
+         uint32_t β,
+         size_t ω,
+         bool variable_time = false,
+         typename policy_t = exec::sequential_t>
+static inline bool
+verify_from_mu(const prepared_pubkey_t<k, l, d>& pubkey,
+               std::span<const uint8_t, 64> mu,
+               std::span<const uint8_t, dilithium_utils::sig_len<k, l, γ1, ω>()> sig,
+               workspace_t<k, l, γ2>& ws,
+               const policy_t& policy = policy_t{})
+  requires(dilithium_params::check_verify_params(k, l, d, γ1, γ2, τ, β, ω))
+{
+  const metrics::timer_t<k, l> timer(metrics::op_t::verify);
+
+  DILITHIUM_PROBE(verify_start, k, l);
+
+  constexpr size_t sigoff0 = 0;
+  constexpr size_t sigoff1 = sigoff0 + 32;
+
+  auto& c = ws.c;
+  auto& z = ws.z;
+  auto& w0 = ws.r0;
+  auto& w1 = ws.w1;
+  auto& w2 = ws.r1;
+
+  std::fill(c.begin(), c.end(), field::zq_t::zero());
+  sampling::sample_in_ball<τ>(sig.template subspan<sigoff0, sigoff1 - sigoff0>(), c);
+  ntt::ntt(c);
+
+  std::fill(w0.begin(), w0.end(), field::zq_t::zero());
+
+  polyvec::ntt<l>(z, policy);
+  polyvec::matrix_multiply<k, l, l, 1>(pubkey.A, z, w0, policy);
+
+  polyvec::mul_by_poly<k>(c, pubkey.t1, w2);
+  polyvec::neg<k>(w2);
 
   polyvec::add_to<k>(w0, w2);
-  polyvec::intt<k>(w2);
+  polyvec::intt<k>(w2, policy);
 
   constexpr uint32_t α = γ2 << 1;
   constexpr uint32_t m = (field::Q - 1u) / α;
   constexpr size_t w1bw = std::bit_width(m - 1u);
 
-  polyvec::use_hint<k, α>(h, w2, w1);
+  polyvec::use_hint<k, α, variable_time>(ws.h, w2, w1);
+  polyvec::encode<k, w1bw>(w1, ws.cm.w1);
 
-  std::array<uint8_t, mu.size() + (k * w1bw * 32)> hash_in{};
-  std::array<uint8_t, 32> hash_out{};
+  auto& hash_out = ws.c_tilde;
 
-  auto _hash_in = std::span(hash_in);
+  DILITHIUM_PROBE(challenge_start, k, l);
 
-  std::memcpy(_hash_in.template subspan<0, mu.size()>().data(), mu.data(), mu.size());
-  polyvec::encode<k, w1bw>(w1, _hash_in.template subspan<mu.size(), _hash_in.size() - mu.size()>());
-
-  hasher.reset();
-  hasher.absorb(_hash_in);
+  shake256::shake256_t hasher;
+  hasher.absorb(mu);
+  hasher.absorb(ws.cm.w1);
   hasher.finalize();
   hasher.squeeze(hash_out);
 
-  constexpr field::zq_t bound0(γ1 - β);
+  DILITHIUM_PROBE(challenge_done, k, l);
 
-  const bool flg0 = z_norm < bound0;
-  bool flg1 = false;
-  const bool flg2 = count_1 <= ω;
+  bool accepted = false;
+  if constexpr (variable_time) {
+    accepted = std::equal(hash_out.begin(), hash_out.end(), sig.begin() + sigoff0);
+  } else {
+    bool flg = false;
+    for (size_t i = 0; i < hash_out.size(); i++) {
+      flg |= static_cast<bool>(sig[sigoff0 + i] ^ hash_out[i]);
+    }
 
-  for (size_t i = 0; i < hash_out.size(); i++) {
-    flg1 |= static_cast<bool>(sig[sigoff0 + i] ^ hash_out[i]);
+    accepted = !flg;
   }
 
-  const bool flg3 = flg0 & !flg1 & flg2;
-  const bool flg4 = !failed & flg3;
-  return flg4;
+  metrics::on_verify<k, l>(accepted);
+  DILITHIUM_PROBE_ARG(verify_done, k, l, accepted);
+
+  return accepted;
+}
+
+// Given a prepared Dilithium public key, message bytes, serialized signature
+// and a workspace, holding its decoded z and h ( which must have passed checks
+// of `decode_signature` ), this routine computes μ = H(tr || M) and verifies the
+// signature, see `verify_from_mu`. Note, z is overwritten.
+template<size_t k,
+         size_t l,
+         size_t d,
+         uint32_t γ1,
+         uint32_t γ2,
+         uint32_t τ,
+         uint32_t β,
+         size_t ω,
+         bool variable_time = false,
+         typename policy_t = exec::sequential_t>
+static inline bool
+verify_decoded(const prepared_pubkey_t<k, l, d>& pubkey,
+               std::span<const uint8_t> msg,
+               std::span<const uint8_t, dilithium_utils::sig_len<k, l, γ1, ω>()> sig,
+               workspace_t<k, l, γ2>& ws,
+               const policy_t& policy = policy_t{})
+  requires(dilithium_params::check_verify_params(k, l, d, γ1, γ2, τ, β, ω))
+{
+  std::array<uint8_t, 64> mu{};
+
+  shake256::shake256_t hasher;
+  hasher.absorb(pubkey.tr);
+  hasher.absorb(msg);
+  hasher.finalize();
+  hasher.squeeze(mu);
+
+  return verify_from_mu<k, l, d, γ1, γ2, τ, β, ω, variable_time>(pubkey, mu, sig, ws, policy);
+}
+
+// Given a prepared Dilithium public key ( see `prepare_pubkey` ), message bytes,
+// serialized signature and a caller-provided workspace, this routine verifies
+// the correctness of signature, returning boolean result, denoting status of
+// signature verification.
+//
+// Malformed or out-of-bound signatures are rejected before any Keccak or NTT
+// work, see `decode_signature`. Note, this happens in both modes, as it
+// depends only on public signature bytes.
+//
+// When `variable_time` is set, verification doesn't try to run in constant-time
+// ( it only ever processes public data ), rather it returns as soon as outcome
+// is known, takes branchy fast paths and skips remaining work.
+//
+// Per-polynomial work is run as per given execution policy ( see `exec.hpp` ),
+// outcome doesn't depend on it.
+//
+// Verification algorithm is described in figure 4 of Dilithium specification
+// https://pq-crystals.org/dilithium/data/dilithium-specification-round3-20210208.pdf
+template<size_t k,
+         size_t l,
+         size_t d,
+         uint32_t γ1,
+         uint32_t γ2,
+         uint32_t τ,
+         uint32_t β,
+         size_t ω,
+         bool variable_time = false,
+         typename policy_t = exec::sequential_t>
+static inline bool
+verify(const prepared_pubkey_t<k, l, d>& pubkey,
+       std::span<const uint8_t> msg,
+       std::span<const uint8_t, dilithium_utils::sig_len<k, l, γ1, ω>()> sig,
+       workspace_t<k, l, γ2>& ws,
+       const policy_t& policy = policy_t{})
+  requires(dilithium_params::check_verify_params(k, l, d, γ1, γ2, τ, β, ω))
+{
+  const metrics::timer_t<k, l> timer(metrics::op_t::verify);
+
+  if (!decode_signature<k, l, γ1, β, ω>(sig, ws.z, ws.h)) {
+    return false;
+  }
+
+  return verify_decoded<k, l, d, γ1, γ2, τ, β, ω, variable_time>(pubkey, msg, sig, ws, policy);
+}
+
+// Given a prepared Dilithium public key ( see `prepare_pubkey` ), message bytes
+// and serialized signature, this routine verifies the signature, using a
+// workspace of its own, see `verify` ( above ).
+template<size_t k,
+         size_t l,
+         size_t d,
+         uint32_t γ1,
+         uint32_t γ2,
+         uint32_t τ,
+         uint32_t β,
+         size_t ω,
+         bool variable_time = false>
+static inline bool
+verify(const prepared_pubkey_t<k, l, d>& pubkey,
+       std::span<const uint8_t> msg,
+       std::span<const uint8_t, dilithium_utils::sig_len<k, l, γ1, ω>()> sig)
+  requires(dilithium_params::check_verify_params(k, l, d, γ1, γ2, τ, β, ω))
+{
+  const metrics::timer_t<k, l> timer(metrics::op_t::verify);
+
+  workspace_t<k, l, γ2> ws;
+  return verify<k, l, d, γ1, γ2, τ, β, ω, variable_time>(pubkey, msg, sig, ws);
+}
+
+// Given a Dilithium public key, message bytes and serialized signature, this
+// routine verifies the correctness of signature, returning boolean result,
+// denoting status of signature verification. For example, say it returns true,
+// it means signature has successfully been verified.
+//
+// Public key is prepared ( see `prepare_pubkey` ) on every invocation, if you
+// plan to verify many signatures under same public key, consider preparing it
+// once and reusing it. Though, malformed or out-of-bound signatures are
+// rejected before public key is prepared.
+//
+// See `verify` ( above ), for meaning of `variable_time` and `policy`.
+//
+// Verification algorithm is described in figure 4 of Dilithium specification
+// https://pq-crystals.org/dilithium/data/dilithium-specification-round3-20210208.pdf
+template<size_t k,
+         size_t l,
+         size_t d,
+         uint32_t γ1,
+         uint32_t γ2,
+         uint32_t τ,
+         uint32_t β,
+         size_t ω,
+         bool variable_time = false,
+         typename policy_t = exec::sequential_t>
+static inline bool
+verify(std::span<const uint8_t, dilithium_utils::pub_key_len<k, d>()> pubkey,
+       std::span<const uint8_t> msg,
+       std::span<const uint8_t, dilithium_utils::sig_len<k, l, γ1, ω>()> sig,
+       const policy_t& policy = policy_t{})
+  requires(dilithium_params::check_verify_params(k, l, d, γ1, γ2, τ, β, ω))
+{
+  const metrics::timer_t<k, l> timer(metrics::op_t::verify);
+
+  workspace_t<k, l, γ2> ws;
+
+  if (!decode_signature<k, l, γ1, β, ω>(sig, ws.z, ws.h)) {
+    return false;
+  }
+
+  prepared_pubkey_t<k, l, d> prepared{};
+  prepare_pubkey<k, l, d>(pubkey, prepared, policy);
+
+  return verify_decoded<k, l, d, γ1, γ2, τ, β, ω, variable_time>(prepared, msg, sig, ws, policy);
+}
+
+// Given a prepared Dilithium public key, a message, provided as a sequence of
+// non-contiguous parts, and serialized signature, this routine verifies the
+// signature over concatenation of those parts, without ever concatenating them.
+// See `verify` for meaning of `variable_time`.
+template<size_t k,
+         size_t l,
+         size_t d,
+         uint32_t γ1,
+         uint32_t γ2,
+         uint32_t τ,
+         uint32_t β,
+         size_t ω,
+         bool variable_time = false>
+static inline bool
+verify(const prepared_pubkey_t<k, l, d>& pubkey,
+       std::span<const std::span<const uint8_t>> msg,
+       std::span<const uint8_t, dilithium_utils::sig_len<k, l, γ1, ω>()> sig)
+  requires(dilithium_params::check_verify_params(k, l, d, γ1, γ2, τ, β, ω))
+{
+  const metrics::timer_t<k, l> timer(metrics::op_t::verify);
+
+  workspace_t<k, l, γ2> ws;
+
+  if (!decode_signature<k, l, γ1, β, ω>(sig, ws.z, ws.h)) {
+    return false;
+  }
+
+  std::array<uint8_t, 64> mu{};
+  hash_message(pubkey.tr, msg, mu);
+
+  return verify_from_mu<k, l, d, γ1, γ2, τ, β, ω, variable_time>(pubkey, mu, sig, ws);
+}
+
+// Given a Dilithium public key, a message, provided as a sequence of
+// non-contiguous parts, and serialized signature, this routine verifies the
+// signature over concatenation of those parts, see `verify` ( above ).
+template<size_t k,
+         size_t l,
+         size_t d,
+         uint32_t γ1,
+         uint32_t γ2,
+         uint32_t τ,
+         uint32_t β,
+         size_t ω,
+         bool variable_time = false>
+static inline bool
+verify(std::span<const uint8_t, dilithium_utils::pub_key_len<k, d>()> pubkey,
+       std::span<const std::span<const uint8_t>> msg,
+       std::span<const uint8_t, dilithium_utils::sig_len<k, l, γ1, ω>()> sig)
+  requires(dilithium_params::check_verify_params(k, l, d, γ1, γ2, τ, β, ω))
+{
+  const metrics::timer_t<k, l> timer(metrics::op_t::verify);
+
+  workspace_t<k, l, γ2> ws;
+
+  if (!decode_signature<k, l, γ1, β, ω>(sig, ws.z, ws.h)) {
+    return false;
+  }
+
+  prepared_pubkey_t<k, l, d> prepared{};
+  prepare_pubkey<k, l, d>(pubkey, prepared);
+
+  std::array<uint8_t, 64> mu{};
+  hash_message(prepared.tr, msg, mu);
+
+  return verify_from_mu<k, l, d, γ1, γ2, τ, β, ω, variable_time>(prepared, mu, sig, ws);
+}
+
+// Given a prepared Dilithium public key, 64 -bytes message representative
+// μ = H(tr || M), computed elsewhere ( see `compute_mu` ), and serialized
+// signature, this routine verifies the signature, same as `verify` would, given
+// message M itself. See `verify` for meaning of `variable_time`.
+template<size_t k,
+         size_t l,
+         size_t d,
+         uint32_t γ1,
+         uint32_t γ2,
+         uint32_t τ,
+         uint32_t β,
+         size_t ω,
+         bool variable_time = false>
+static inline bool
+verify_mu(const prepared_pubkey_t<k, l, d>& pubkey,
+          std::span<const uint8_t, 64> mu,
+          std::span<const uint8_t, dilithium_utils::sig_len<k, l, γ1, ω>()> sig)
+  requires(dilithium_params::check_verify_params(k, l, d, γ1, γ2, τ, β, ω))
+{
+  const metrics::timer_t<k, l> timer(metrics::op_t::verify);
+
+  workspace_t<k, l, γ2> ws;
+
+  if (!decode_signature<k, l, γ1, β, ω>(sig, ws.z, ws.h)) {
+    return false;
+  }
+
+  return verify_from_mu<k, l, d, γ1, γ2, τ, β, ω, variable_time>(pubkey, mu, sig, ws);
+}
+
+// Given a Dilithium public key, 64 -bytes message representative μ and
+// serialized signature, this routine verifies the signature, see `verify_mu`
+// ( above ).
+template<size_t k,
+         size_t l,
+         size_t d,
+         uint32_t γ1,
+         uint32_t γ2,
+         uint32_t τ,
+         uint32_t β,
+         size_t ω,
+         bool variable_time = false>
+static inline bool
+verify_mu(std::span<const uint8_t, dilithium_utils::pub_key_len<k, d>()> pubkey,
+          std::span<const uint8_t, 64> mu,
+          std::span<const uint8_t, dilithium_utils::sig_len<k, l, γ1, ω>()> sig)
+  requires(dilithium_params::check_verify_params(k, l, d, γ1, γ2, τ, β, ω))
+{
+  const metrics::timer_t<k, l> timer(metrics::op_t::verify);
+
+  workspace_t<k, l, γ2> ws;
+
+  if (!decode_signature<k, l, γ1, β, ω>(sig, ws.z, ws.h)) {
+    return false;
+  }
+
+  prepared_pubkey_t<k, l, d> prepared{};
+  prepare_pubkey<k, l, d>(pubkey, prepared);
+
+  return verify_from_mu<k, l, d, γ1, γ2, τ, β, ω, variable_time>(prepared, mu, sig, ws);
 }
 
 }
@@ -1,5 +1,12 @@
 #pragma once
+#include "batch.hpp"
+#include "csprng.hpp"
 #include "dilithium.hpp"
+#include "masked_sign.hpp"
+#include "presign.hpp"
+#include "pubkey_cache.hpp"
+#include "seckey_cache.hpp"
+#include "streaming.hpp"
 
 // Dilithium Post-Quantum Digital Signature Algorithm instantiated with NIST
 // security level 5 parameters, as suggested in table 2 of
@@ -34,6 +41,17 @@ keygen(std::span<const uint8_t, 32> seed, std::span<uint8_t, PubKeyLen> pubkey,
   dilithium::keygen<k, l, d, η>(seed, pubkey, seckey);
 }
 
+// Same as `keygen` ( above ), but spreads independent per-polynomial work of
+// key generation across threads of given pool, see `exec::parallel_t`.
+inline void
+keygen(std::span<const uint8_t, 32> seed,
+       std::span<uint8_t, PubKeyLen> pubkey,
+       std::span<uint8_t, SecKeyLen> seckey,
+       const exec::parallel_t& policy)
+{
+  dilithium::keygen<k, l, d, η>(seed, pubkey, seckey, policy);
+}
+
 // Given a Dilithium5 secret key and a non-empty message M, this routine can be
 // used for signing the message, computing the signature either
 // deterministically ( by default ) or non-deterministically - a compile-time
@@ -53,14 +71,495 @@ sign(std::span<const uint8_t, SecKeyLen> seckey,
   dilithium::sign<k, l, d, η, γ1, γ2, τ, β, ω, r>(seckey, msg, sig, seed);
 }
 
+// Randomized signing of a non-empty message M, using a Dilithium5 secret key,
+// same as `sign<true>` ( above ), but 64 -bytes seed is drawn from CSPRNG of
+// calling thread ( see `csprng::local` ), so that callers don't need to bring
+// their own, while not paying for a syscall per signature.
+template<const bool random>
+inline void
+sign(std::span<const uint8_t, SecKeyLen> seckey, std::span<const uint8_t> msg, std::span<uint8_t, SigLen> sig)
+  requires(random)
+{
+  std::array<uint8_t, 64> rnd{};
+  csprng::local().read(rnd);
+
+  dilithium::sign<k, l, d, η, γ1, γ2, τ, β, ω, true>(seckey, msg, sig, rnd);
+  dilithium_utils::wipe(std::span(rnd));
+}
+
+// Same as `sign` ( above ), but spreads independent per-polynomial work of this
+// single signing operation across threads of given pool, reducing its latency.
+// Signature is same as the one computed by `sign` ( above ).
+template<const bool random = false>
+inline void
+sign(std::span<const uint8_t, SecKeyLen> seckey,
+     std::span<const uint8_t> msg,
+     std::span<uint8_t, SigLen> sig,
+     std::span<const uint8_t, 64 * random> seed,
+     const exec::parallel_t& policy)
+{
+  constexpr bool r = random;
+  dilithium::sign<k, l, d, η, γ1, γ2, τ, β, ω, r>(seckey, msg, sig, seed, policy);
+}
+
+// Dilithium5 secret key, prepared for signing.
+using prepared_seckey_t = dilithium::prepared_seckey_t<k, l>;
+
+// Pool of precomputed commitments, for offline/ online randomized Dilithium5
+// signing.
+using presign_pool_t = presign::pool_t<k, l, d, η, γ1, γ2, τ, β, ω>;
+
+// Scratch space of Dilithium5 signing and verification, which can be allocated
+// once and reused across calls, see `dilithium::workspace_t`.
+using workspace_t = dilithium::workspace_t<k, l, γ2>;
+
+// Byte length of Dilithium5 workspace.
+constexpr size_t WorkspaceLen = sizeof(workspace_t);
+
+// Given a Dilithium5 secret key, this routine prepares it, so that it can be
+// reused for signing many messages, without expanding it every time.
+inline void
+prepare_seckey(std::span<const uint8_t, SecKeyLen> seckey, prepared_seckey_t& prepared)
+{
+  dilithium::prepare_seckey<k, l, d, η>(seckey, prepared);
+}
+
+// = 32 -bytes seed-only Dilithium5 secret key i.e. the seed `keygen` was called
+// with, which can be stored in place of ( much larger ) serialized secret key.
+constexpr size_t SeedKeyLen = 32;
+
+// Given a seed-only Dilithium5 secret key, this routine expands it into the
+// prepared secret key of its key pair, also writing the public key. Prepared
+// secret key is same as `prepare_seckey` computes from secret key generated by
+// `keygen`, from same seed.
+inline void
+prepare_seckey_from_seed(std::span<const uint8_t, SeedKeyLen> seed,
+                         prepared_seckey_t& prepared,
+                         std::span<uint8_t, PubKeyLen> pubkey)
+{
+  dilithium::prepare_seckey_from_seed<k, l, d, η>(seed, prepared, pubkey);
+}
+
+// Thread-safe cache of Dilithium5 secret keys, prepared from seed-only secret
+// keys, so that each seed is expanded once per process.
+using seckey_cache_t = seckey_cache::cache_t<k, l, d, η>;
+
+// Given a cache of prepared secret keys, a seed-only Dilithium5 secret key and
+// a non-empty message M, this routine signs the message, while looking up
+// prepared form of the secret key in the cache ( or expanding the seed and
+// admitting it into the cache, on miss ). See `sign` ( above ) for meaning of
+// `random` and `rnd`.
+template<const bool random = false>
+inline void
+sign(seckey_cache_t& cache,
+     std::span<const uint8_t, SeedKeyLen> seed,
+     std::span<const uint8_t> msg,
+     std::span<uint8_t, SigLen> sig,
+     std::span<const uint8_t, 64 * random> rnd)
+{
+  constexpr bool r = random;
+  const metrics::timer_t<k, l> timer(metrics::op_t::sign);
+
+  const auto prepared = cache.get(seed);
+  dilithium::sign<k, l, d, η, γ1, γ2, τ, β, ω, r>(*prepared, msg, sig, rnd);
+}
+
+// Given a prepared Dilithium5 secret key and a non-empty message M, this
+// routine signs the message, see `sign` ( above ) for meaning of `random` and
+// `seed`.
+template<const bool random = false>
+inline void
+sign(const prepared_seckey_t& seckey,
+     std::span<const uint8_t> msg,
+     std::span<uint8_t, SigLen> sig,
+     std::span<const uint8_t, 64 * random> seed)
+{
+  constexpr bool r = random;
+  dilithium::sign<k, l, d, η, γ1, γ2, τ, β, ω, r>(seckey, msg, sig, seed);
+}
+
+// Randomized signing of a non-empty message M, using a prepared Dilithium5
+// secret key, drawing 64 -bytes seed from CSPRNG of calling thread, see `sign`
+// ( above ).
+template<const bool random>
+inline void
+sign(const prepared_seckey_t& seckey, std::span<const uint8_t> msg, std::span<uint8_t, SigLen> sig)
+  requires(random)
+{
+  std::array<uint8_t, 64> rnd{};
+  csprng::local().read(rnd);
+
+  dilithium::sign<k, l, d, η, γ1, γ2, τ, β, ω, true>(seckey, msg, sig, rnd);
+  dilithium_utils::wipe(std::span(rnd));
+}
+
+// Given a prepared Dilithium5 secret key, a non-empty message M and a
+// workspace, this routine signs the message, reusing the workspace for all
+// signing attempts, so that it can be allocated once by the caller.
+template<const bool random = false>
+inline void
+sign(const prepared_seckey_t& seckey,
+     std::span<const uint8_t> msg,
+     std::span<uint8_t, SigLen> sig,
+     std::span<const uint8_t, 64 * random> seed,
+     workspace_t& ws)
+{
+  constexpr bool r = random;
+  dilithium::sign<k, l, d, η, γ1, γ2, τ, β, ω, r>(seckey, msg, sig, seed, ws);
+}
+
+// Given a Dilithium5 secret key and a non-empty message M, provided as a
+// sequence of non-contiguous parts, this routine signs concatenation of those
+// parts, without concatenating them. See `sign` for meaning of `random` and
+// `seed`.
+template<const bool random = false>
+inline void
+sign(std::span<const uint8_t, SecKeyLen> seckey,
+     std::span<const std::span<const uint8_t>> msg,
+     std::span<uint8_t, SigLen> sig,
+     std::span<const uint8_t, 64 * random> seed)
+{
+  constexpr bool r = random;
+  dilithium::sign<k, l, d, η, γ1, γ2, τ, β, ω, r>(seckey, msg, sig, seed);
+}
+
+// Given a prepared Dilithium5 secret key and a non-empty message M, provided as
+// a sequence of non-contiguous parts, this routine signs concatenation of those
+// parts, see `sign` ( above ).
+template<const bool random = false>
+inline void
+sign(const prepared_seckey_t& seckey,
+     std::span<const std::span<const uint8_t>> msg,
+     std::span<uint8_t, SigLen> sig,
+     std::span<const uint8_t, 64 * random> seed)
+{
+  constexpr bool r = random;
+  dilithium::sign<k, l, d, η, γ1, γ2, τ, β, ω, r>(seckey, msg, sig, seed);
+}
+
+// Given a Dilithium5 secret key and 64 -bytes message representative μ of
+// message M ( see `compute_mu` ), this routine signs M, producing same signature
+// as `sign` would, given M itself. See `sign` for meaning of `random` and
+// `seed`.
+template<const bool random = false>
+inline void
+sign_mu(std::span<const uint8_t, SecKeyLen> seckey,
+        std::span<const uint8_t, 64> mu,
+        std::span<uint8_t, SigLen> sig,
+        std::span<const uint8_t, 64 * random> seed)
+{
+  constexpr bool r = random;
+  dilithium::sign_mu<k, l, d, η, γ1, γ2, τ, β, ω, r>(seckey, mu, sig, seed);
+}
+
+// Given a prepared Dilithium5 secret key and 64 -bytes message representative μ
+// of message M, this routine signs M, see `sign_mu` ( above ).
+template<const bool random = false>
+inline void
+sign_mu(const prepared_seckey_t& seckey,
+        std::span<const uint8_t, 64> mu,
+        std::span<uint8_t, SigLen> sig,
+        std::span<const uint8_t, 64 * random> seed)
+{
+  constexpr bool r = random;
+  dilithium::sign_mu<k, l, d, η, γ1, γ2, τ, β, ω, r>(seckey, mu, sig, seed);
+}
+
+// Dilithium5 secret key, prepared for masked signing, with s1, s2 split into
+// `order` + 1 arithmetic shares and K into `order` + 1 Boolean shares, see
+// `masked_sign::masked_seckey_t`.
+template<size_t order = masking::DEFAULT_ORDER>
+using masked_seckey_t = masked_sign::masked_seckey_t<k, l, order>;
+
+// Given a Dilithium5 secret key, this routine prepares it for masked signing,
+// splitting its secret vectors and key K into fresh random shares.
+template<size_t order>
+inline void
+prepare_masked_seckey(std::span<const uint8_t, SecKeyLen> seckey, masked_seckey_t<order>& masked)
+{
+  masked_sign::prepare_seckey<k, l, d, η, order>(seckey, masked);
+}
+
+// Given a masked Dilithium5 secret key and a non-empty message M, this routine
+// signs the message, keeping s1, s2, K, ρ' and y masked throughout signing, and
+// unmasking only w1, rejection decisions and the accepted z, h, see
+// `masked_sign::sign`. Signature is same as the one computed by `sign` under
+// unmasked secret key. See `sign` ( above ) for meaning of `random` and `seed`.
+template<const bool random = false, size_t order>
+inline void
+sign(masked_seckey_t<order>& seckey,
+     std::span<const uint8_t> msg,
+     std::span<uint8_t, SigLen> sig,
+     std::span<const uint8_t, 64 * random> seed)
+{
+  constexpr bool r = random;
+  masked_sign::sign<k, l, d, η, γ1, γ2, τ, β, ω, r, order>(seckey, msg, sig, seed);
+}
+
 // Given a Dilithium5 public key, a message M and a signature S, this routine
 // can be used for verifying if the signature is valid for the provided message
 // or not, returning truth value only in case of successful signature
-// verification, otherwise false is returned.
+// verification, otherwise false is returned. Verification can opt for running
+// in variable-time, returning as soon as the outcome is known - a compile-time
+// decision using template parameter. It's safe as verification only ever
+// touches public data.
+template<const bool variable_time = false>
 inline bool
 verify(std::span<const uint8_t, PubKeyLen> pubkey, std::span<const uint8_t> msg, std::span<const uint8_t, SigLen> sig)
 {
-  return dilithium::verify<k, l, d, γ1, γ2, τ, β, ω>(pubkey, msg, sig);
+  constexpr bool vt = variable_time;
+  return dilithium::verify<k, l, d, γ1, γ2, τ, β, ω, vt>(pubkey, msg, sig);
+}
+
+// Same as `verify` ( above ), but spreads independent per-polynomial work of
+// this single verification across threads of given pool.
+template<const bool variable_time = false>
+inline bool
+verify(std::span<const uint8_t, PubKeyLen> pubkey,
+       std::span<const uint8_t> msg,
+       std::span<const uint8_t, SigLen> sig,
+       const exec::parallel_t& policy)
+{
+  constexpr bool vt = variable_time;
+  return dilithium::verify<k, l, d, γ1, γ2, τ, β, ω, vt>(pubkey, msg, sig, policy);
+}
+
+// Streaming Dilithium5 signing context, for signing a message fed in chunks,
+// see `dilithium_stream::sign_ctx_t`.
+template<const bool random = false>
+using sign_ctx_t = dilithium_stream::sign_ctx_t<k, l, d, η, γ1, γ2, τ, β, ω, random>;
+
+// Streaming Dilithium5 verification context, for verifying a signature over a
+// message fed in chunks, see `dilithium_stream::verify_ctx_t`.
+template<const bool variable_time = false>
+using verify_ctx_t = dilithium_stream::verify_ctx_t<k, l, d, γ1, γ2, τ, β, ω, variable_time>;
+
+// Dilithium5 public key, prepared for signature verification.
+using prepared_pubkey_t = dilithium::prepared_pubkey_t<k, l, d>;
+
+// Thread-safe, memory bounded cache of prepared Dilithium5 public keys.
+using pubkey_cache_t = pubkey_cache::cache_t<k, l, d>;
+
+// Given a Dilithium5 public key, this routine prepares it, so that it can be
+// reused for verifying many signatures, without expanding it every time.
+inline void
+prepare_pubkey(std::span<const uint8_t, PubKeyLen> pubkey, prepared_pubkey_t& prepared)
+{
+  dilithium::prepare_pubkey<k, l, d>(pubkey, prepared);
+}
+
+// Given a prepared Dilithium5 public key, a message M and a signature S, this
+// routine can be used for verifying if the signature is valid for the provided
+// message or not.
+template<const bool variable_time = false>
+inline bool
+verify(const prepared_pubkey_t& pubkey, std::span<const uint8_t> msg, std::span<const uint8_t, SigLen> sig)
+{
+  constexpr bool vt = variable_time;
+  return dilithium::verify<k, l, d, γ1, γ2, τ, β, ω, vt>(pubkey, msg, sig);
+}
+
+// Given a prepared Dilithium5 public key, a message M, a signature S and a
+// workspace, this routine verifies if the signature is valid for the provided
+// message or not, using caller-provided workspace.
+template<const bool variable_time = false>
+inline bool
+verify(const prepared_pubkey_t& pubkey,
+       std::span<const uint8_t> msg,
+       std::span<const uint8_t, SigLen> sig,
+       workspace_t& ws)
+{
+  constexpr bool vt = variable_time;
+  return dilithium::verify<k, l, d, γ1, γ2, τ, β, ω, vt>(pubkey, msg, sig, ws);
+}
+
+// Given a Dilithium5 public key, a message M, provided as a sequence of
+// non-contiguous parts, and a signature S, this routine verifies if the
+// signature is valid for concatenation of those parts, without concatenating
+// them.
+template<const bool variable_time = false>
+inline bool
+verify(std::span<const uint8_t, PubKeyLen> pubkey,
+       std::span<const std::span<const uint8_t>> msg,
+       std::span<const uint8_t, SigLen> sig)
+{
+  constexpr bool vt = variable_time;
+  return dilithium::verify<k, l, d, γ1, γ2, τ, β, ω, vt>(pubkey, msg, sig);
+}
+
+// Given a prepared Dilithium5 public key, a message M, provided as a sequence
+// of non-contiguous parts, and a signature S, this routine verifies if the
+// signature is valid for concatenation of those parts, see `verify` ( above ).
+template<const bool variable_time = false>
+inline bool
+verify(const prepared_pubkey_t& pubkey,
+       std::span<const std::span<const uint8_t>> msg,
+       std::span<const uint8_t, SigLen> sig)
+{
+  constexpr bool vt = variable_time;
+  return dilithium::verify<k, l, d, γ1, γ2, τ, β, ω, vt>(pubkey, msg, sig);
+}
+
+// Given a cache of prepared public keys, a Dilithium5 public key, a message M
+// and a signature S, this routine verifies the signature, while looking up
+// prepared form of the public key in the cache ( or admitting it into the cache,
+// on miss ). Malformed or out-of-bound signatures are rejected before touching
+// the cache.
+template<const bool variable_time = false>
+inline bool
+verify(pubkey_cache_t& cache,
+       std::span<const uint8_t, PubKeyLen> pubkey,
+       std::span<const uint8_t> msg,
+       std::span<const uint8_t, SigLen> sig)
+{
+  constexpr bool vt = variable_time;
+  const metrics::timer_t<k, l> timer(metrics::op_t::verify);
+
+  workspace_t ws;
+
+  if (!dilithium::decode_signature<k, l, γ1, β, ω>(sig, ws.z, ws.h)) {
+    return false;
+  }
+
+  const auto prepared = cache.get(pubkey);
+  return dilithium::verify_decoded<k, l, d, γ1, γ2, τ, β, ω, vt>(*prepared, msg, sig, ws);
+}
+
+// Given a Dilithium5 public key and a message M, this routine computes 64 -bytes
+// message representative μ = H(H(pk) || M), so that M can be hashed on a host
+// other than the one signing or verifying it, see `sign_mu` and `verify_mu`.
+inline void
+compute_mu(std::span<const uint8_t, PubKeyLen> pubkey, std::span<const uint8_t> msg, std::span<uint8_t, 64> mu)
+{
+  dilithium::compute_mu<k, d>(pubkey, msg, mu);
+}
+
+// Given a Dilithium5 public key, 64 -bytes message representative μ of message
+// M and a signature S, this routine verifies if the signature is valid for M,
+// same as `verify` would, given M itself.
+template<const bool variable_time = false>
+inline bool
+verify_mu(std::span<const uint8_t, PubKeyLen> pubkey,
+          std::span<const uint8_t, 64> mu,
+          std::span<const uint8_t, SigLen> sig)
+{
+  constexpr bool vt = variable_time;
+  return dilithium::verify_mu<k, l, d, γ1, γ2, τ, β, ω, vt>(pubkey, mu, sig);
+}
+
+// Given a prepared Dilithium5 public key, 64 -bytes message representative μ of
+// message M and a signature S, this routine verifies if the signature is valid
+// for M, see `verify_mu` ( above ).
+template<const bool variable_time = false>
+inline bool
+verify_mu(const prepared_pubkey_t& pubkey, std::span<const uint8_t, 64> mu, std::span<const uint8_t, SigLen> sig)
+{
+  constexpr bool vt = variable_time;
+  return dilithium::verify_mu<k, l, d, γ1, γ2, τ, β, ω, vt>(pubkey, mu, sig);
+}
+
+// One Dilithium5 signature verification job, see `verify_batch`.
+using verify_job_t = dilithium_batch::verify_job_t<k, l, d, γ1, ω>;
+
+// Given a batch of Dilithium5 signature verification jobs, this routine
+// verifies all of them, using worker threads of given pool, returning a bitmap
+// s.t. i -th bit is set only when i -th signature is successfully verified.
+// Jobs sharing same public key, share its preparation too.
+inline std::vector<bool>
+verify_batch(std::span<const verify_job_t> jobs, thread_pool::pool_t& pool = thread_pool::default_pool())
+{
+  return dilithium_batch::verify_batch<k, l, d, γ1, γ2, τ, β, ω>(jobs, pool);
+}
+
+// Given n Dilithium5 public keys ( concatenated ), n messages and n signatures
+// ( concatenated ), this routine verifies all of them, writing 1 to results[i]
+// only when i -th signature is valid, otherwise writing 0. Signatures are
+// verified `lanes::DEFAULT_LANES` at a time, one per lane, which pays off when
+// most public keys are distinct.
+inline void
+verify_lanes(std::span<const uint8_t> pubkeys,
+             std::span<const std::span<const uint8_t>> msgs,
+             std::span<const uint8_t> sigs,
+             std::span<uint8_t> results,
+             thread_pool::pool_t& pool = thread_pool::default_pool())
+{
+  dilithium_batch::verify_lanes<k, l, d, γ1, γ2, τ, β, ω>(pubkeys, msgs, sigs, results, pool);
+}
+
+// Given n 32 -bytes seeds ( concatenated ), this routine generates n Dilithium5
+// key pairs, writing i -th public key to pubkeys[i * PubKeyLen, (i + 1) *
+// PubKeyLen) and i -th secret key to seckeys[i * SecKeyLen, (i + 1) *
+// SecKeyLen). Seeds are processed `lanes::DEFAULT_LANES` at a time, one per
+// lane, spread across worker threads of given pool. Key pairs are same as the
+// ones `keygen` generates.
+inline void
+keygen_batch(std::span<const uint8_t> seeds,
+             std::span<uint8_t> pubkeys,
+             std::span<uint8_t> seckeys,
+             thread_pool::pool_t& pool = thread_pool::default_pool())
+{
+  dilithium_batch::keygen_batch<k, l, d, η>(seeds, pubkeys, seckeys, pool);
+}
+
+// Given a Dilithium5 secret key and a non-empty message M, this routine signs
+// the message, evaluating a few consecutive signing attempts at once, across
+// worker threads of given pool, which reduces tail of signing latency. Produced
+// signature is byte-identical to the one `sign` produces. See `sign` for
+// meaning of `random` and `seed`. If `width` is 0, one attempt per worker thread
+// ( plus one for the calling thread ) is evaluated at once.
+template<const bool random = false>
+inline void
+sign_speculative(std::span<const uint8_t, SecKeyLen> seckey,
+                 std::span<const uint8_t> msg,
+                 std::span<uint8_t, SigLen> sig,
+                 std::span<const uint8_t, 64 * random> seed,
+                 thread_pool::pool_t& pool = thread_pool::default_pool(),
+                 const size_t width = 0)
+{
+  constexpr bool r = random;
+  dilithium_batch::sign_speculative<k, l, d, η, γ1, γ2, τ, β, ω, r>(seckey, msg, sig, seed, pool, width);
+}
+
+// Given a prepared Dilithium5 secret key and n non-empty messages, this routine
+// signs all of them, writing i -th signature to sigs[i * SigLen, (i + 1) *
+// SigLen), spreading the work across worker threads of given pool. For
+// randomized signing, n 64 -bytes seeds must be provided ( concatenated ),
+// otherwise `seeds` can be left empty. Produced signatures are same as the ones
+// `sign` produces.
+template<const bool random = false>
+inline void
+sign_batch(const prepared_seckey_t& seckey,
+           std::span<const std::span<const uint8_t>> msgs,
+           std::span<uint8_t> sigs,
+           std::span<const uint8_t> seeds = {},
+           thread_pool::pool_t& pool = thread_pool::default_pool())
+{
+  constexpr bool r = random;
+  dilithium_batch::sign_batch<k, l, d, η, γ1, γ2, τ, β, ω, r>(seckey, msgs, sigs, seeds, pool);
+}
+
+// Returns Dilithium5 signing loop counters, accumulated by calling thread, which
+// are only updated when compiled with `-DDILITHIUM_PROFILE_SIGN`, see
+// `sign_profile.hpp`.
+inline const sign_profile::counters_t&
+sign_counters()
+{
+  return sign_profile::counters<k, l, γ1, γ2, τ, β, ω>();
+}
+
+// Resets Dilithium5 signing loop counters, accumulated by calling thread.
+inline void
+reset_sign_counters()
+{
+  sign_profile::reset<k, l, γ1, γ2, τ, β, ω>();
+}
+
+// Returns Dilithium5 metrics, summed over all threads, which are only updated
+// when compiled with `-DDILITHIUM_METRICS`, see `metrics.hpp`.
+inline metrics::set_metrics_t<uint64_t>
+metrics_snapshot()
+{
+  return metrics::snapshot().of<k, l>();
 }
 
 }
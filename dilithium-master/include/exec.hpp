@@ -0,0 +1,41 @@
+#pragma once
+#include "thread_pool.hpp"
+#include <cstddef>
+
+// Execution policies, deciding how independent per-polynomial parts of a single
+// Dilithium operation ( say k x l streams of `expand_a` or rows of
+// `matrix_multiply` ) are run
+namespace exec {
+
+// Runs all parts one after another, on calling thread. Default policy of every
+// Dilithium routine.
+struct sequential_t
+{
+  // Invokes `fn(i)` for each i ∈ [0, cnt), in order.
+  template<typename F>
+  inline void for_each(const size_t cnt, F&& fn) const
+  {
+    for (size_t i = 0; i < cnt; i++) {
+      fn(i);
+    }
+  }
+};
+
+// Spreads parts across worker threads of a pool and calling thread, reducing
+// latency of one large operation, on otherwise idle cores. Worth it only for
+// parts as large as whole polynomials, as each `for_each` pays for dispatching
+// work to the pool.
+struct parallel_t
+{
+  thread_pool::pool_t& pool;
+
+  // Invokes `fn(i)` for each i ∈ [0, cnt), concurrently, returning when all of
+  // them have finished.
+  template<typename F>
+  inline void for_each(const size_t cnt, F&& fn) const
+  {
+    pool.parallel_for(cnt, fn);
+  }
+};
+
+}
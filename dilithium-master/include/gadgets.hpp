@@ -0,0 +1,559 @@
+#pragma once
+#include "csprng.hpp"
+#include "field.hpp"
+#include "keccak_xn.hpp"
+#include "params.hpp"
+#include "shake256.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+// Boolean masking gadgets, conversions between Boolean and arithmetic ( mod q )
+// masking and masked Keccak-f[1600], so that non-linear steps of masked signing
+// ( see `masked_sign.hpp` ) run on shares, same as linear ones do.
+//
+// Gadgets follow
+//
+// - ISW multiplication, from "Private Circuits: Securing Hardware against Probing
+//   Attacks" by Ishai, Sahai and Wagner
+// - Kogge-Stone addition of Boolean shares, from "Conversion from Arithmetic to
+//   Boolean Masking with Logarithmic Complexity" by Coron, Großschädl, Tibouchi and
+//   Vadnala
+// - Conversions mod q, from "Masking the GLP Lattice-Based Signature Scheme at
+//   Any Order" by Barthe, Belaïd, Espitau, Fouque, Grégoire, Rossi and Tibouchi
+//
+// Each of them takes L = order + 1 shares and fresh randomness from a
+// `random_t`. With L = 1, they compute the plain, unmasked function.
+namespace gadgets {
+
+// Boolean masking of a word of type T, with L shares s.t.
+// secret = share[0] ^ share[1] ^ ... ^ share[L-1].
+template<typename T, size_t L>
+using bool_t = std::array<T, L>;
+
+// Arithmetic masking of an element of Z_q, with L shares, each ∈ [0, q), s.t.
+// secret = share[0] + share[1] + ... + share[L-1] ( mod q ).
+template<size_t L>
+using arith_t = std::array<uint32_t, L>;
+
+// Source of fresh randomness, consumed by gadgets, which reads given generator
+// ( `prng::prng_t` or `csprng::csprng_t` ) a buffer at a time, as gadgets ask
+// for a few bytes at a time, but lots of them.
+template<typename rng_t = csprng::csprng_t>
+struct random_t
+{
+public:
+  inline explicit random_t(rng_t& prng)
+    : prng(prng)
+  {
+  }
+
+  random_t(const random_t&) = delete;
+  random_t& operator=(const random_t&) = delete;
+
+  inline ~random_t() { dilithium_utils::wipe(std::span(buf)); }
+
+  // Returns uniform random word of type T.
+  template<typename T>
+  inline T next()
+  {
+    if (off + sizeof(T) > buf.size()) {
+      prng.read(buf);
+      off = 0;
+    }
+
+    T v{};
+    std::memcpy(&v, buf.data() + off, sizeof(v));
+    off += sizeof(v);
+
+    return v;
+  }
+
+  // Returns uniform random element of Z_q, by rejection sampling 23 -bit words.
+  inline uint32_t next_zq()
+  {
+    uint32_t v = 0;
+    do {
+      v = next<uint32_t>() & ((1u << 23) - 1u);
+    } while (v >= field::Q);
+
+    return v;
+  }
+
+private:
+  rng_t& prng;
+  std::array<uint8_t, 1024> buf{};
+  size_t off = buf.size();
+};
+
+// Returns Boolean masking of public word c, with c as first share and all others
+// zero. It must go through `refresh`, before secret-dependent use.
+template<typename T, size_t L>
+static inline constexpr bool_t<T, L>
+constant(const T c)
+{
+  bool_t<T, L> res{};
+  res[0] = c;
+  return res;
+}
+
+// Recombines Boolean shares, returning the secret.
+template<typename T, size_t L>
+static inline constexpr T
+unmask(const bool_t<T, L>& a)
+{
+  T res = a[0];
+  for (size_t i = 1; i < L; i++) {
+    res ^= a[i];
+  }
+
+  return res;
+}
+
+// Share-wise linear maps, on Boolean shares.
+template<typename T, size_t L>
+static inline constexpr bool_t<T, L>
+bxor(const bool_t<T, L>& a, const bool_t<T, L>& b)
+{
+  bool_t<T, L> res{};
+  for (size_t i = 0; i < L; i++) {
+    res[i] = a[i] ^ b[i];
+  }
+
+  return res;
+}
+
+template<typename T, size_t L>
+static inline constexpr bool_t<T, L>
+shl(const bool_t<T, L>& a, const size_t s)
+{
+  bool_t<T, L> res{};
+  for (size_t i = 0; i < L; i++) {
+    res[i] = a[i] << s;
+  }
+
+  return res;
+}
+
+template<typename T, size_t L>
+static inline constexpr bool_t<T, L>
+shr(const bool_t<T, L>& a, const size_t s)
+{
+  bool_t<T, L> res{};
+  for (size_t i = 0; i < L; i++) {
+    res[i] = a[i] >> s;
+  }
+
+  return res;
+}
+
+template<typename T, size_t L>
+static inline constexpr bool_t<T, L>
+band(const bool_t<T, L>& a, const T c)
+{
+  bool_t<T, L> res{};
+  for (size_t i = 0; i < L; i++) {
+    res[i] = a[i] & c;
+  }
+
+  return res;
+}
+
+// Complements the secret, by complementing first share only.
+template<typename T, size_t L>
+static inline constexpr bool_t<T, L>
+bnot(bool_t<T, L> a)
+{
+  a[0] = ~a[0];
+  return a;
+}
+
+// Given Boolean shares of a 32 -bit word, returns Boolean shares of a word, being
+// all ones if most significant bit of the secret is set, otherwise zero.
+template<size_t L>
+static inline constexpr bool_t<uint32_t, L>
+sign_mask(const bool_t<uint32_t, L>& a)
+{
+  bool_t<uint32_t, L> res{};
+  for (size_t i = 0; i < L; i++) {
+    res[i] = static_cast<uint32_t>(static_cast<int32_t>(a[i]) >> 31);
+  }
+
+  return res;
+}
+
+// Re-randomizes Boolean shares, without changing the secret, by xoring a fresh
+// random word into both shares of every pair of shares.
+template<typename T, size_t L, typename rng_t>
+static inline void
+refresh(bool_t<T, L>& a, random_t<rng_t>& rnd)
+{
+  for (size_t i = 0; i < L; i++) {
+    for (size_t j = i + 1; j < L; j++) {
+      const T r = rnd.template next<T>();
+      a[i] ^= r;
+      a[j] ^= r;
+    }
+  }
+}
+
+// ISW multiplication i.e. Boolean shares of a & b.
+template<typename T, size_t L, typename rng_t>
+static inline bool_t<T, L>
+sec_and(const bool_t<T, L>& a, const bool_t<T, L>& b, random_t<rng_t>& rnd)
+{
+  bool_t<T, L> c{};
+  for (size_t i = 0; i < L; i++) {
+    c[i] = a[i] & b[i];
+  }
+
+  for (size_t i = 0; i < L; i++) {
+    for (size_t j = i + 1; j < L; j++) {
+      const T r = rnd.template next<T>();
+
+      c[i] ^= r;
+      c[j] ^= (r ^ (a[i] & b[j])) ^ (a[j] & b[i]);
+    }
+  }
+
+  return c;
+}
+
+// Kogge-Stone addition of Boolean shares i.e. Boolean shares of a + b ( mod
+// 2^w ), for w -bit word type T, costing 2 * log2(w) calls to `sec_and`.
+template<typename T, size_t L, typename rng_t>
+static inline bool_t<T, L>
+sec_add(const bool_t<T, L>& a, const bool_t<T, L>& b, random_t<rng_t>& rnd)
+{
+  constexpr size_t n = std::bit_width(sizeof(T) * 8) - 1;
+
+  auto p = bxor(a, b);
+  auto g = sec_and(a, b, rnd);
+
+  for (size_t i = 1; i < n; i++) {
+    const size_t s = 1ul << (i - 1);
+
+    g = bxor(g, sec_and(p, shl(g, s), rnd));
+
+    auto ps = shl(p, s);
+    refresh(ps, rnd);
+    p = sec_and(p, ps, rnd);
+  }
+
+  g = bxor(g, sec_and(p, shl(g, 1ul << (n - 1)), rnd));
+
+  return bxor(bxor(a, b), shl(g, 1));
+}
+
+// Boolean shares of a + c ( mod 2^w ), for public c.
+template<typename T, size_t L, typename rng_t>
+static inline bool_t<T, L>
+sec_add(const bool_t<T, L>& a, const T c, random_t<rng_t>& rnd)
+{
+  return sec_add(a, constant<T, L>(c), rnd);
+}
+
+// Given Boolean shares of a, b ∈ [0, q), returns Boolean shares of a + b ( mod q ).
+template<size_t L, typename rng_t>
+static inline bool_t<uint32_t, L>
+sec_add_modq(const bool_t<uint32_t, L>& a, const bool_t<uint32_t, L>& b, random_t<rng_t>& rnd)
+{
+  const auto s = sec_add(a, b, rnd);
+  const auto t = sec_add(s, 0u - field::Q, rnd);
+
+  // t < 0 iff s < q, in which case s is kept
+  const auto m = sign_mask(t);
+  return bxor(t, sec_and(bxor(s, t), m, rnd));
+}
+
+// Converts arithmetic shares mod q into Boolean shares of same secret, by
+// Boolean masking each arithmetic share and adding them up, using `sec_add_modq`.
+template<size_t L, typename rng_t>
+static inline bool_t<uint32_t, L>
+a2b(const arith_t<L>& a, random_t<rng_t>& rnd)
+{
+  auto res = constant<uint32_t, L>(a[0]);
+  refresh(res, rnd);
+
+  for (size_t i = 1; i < L; i++) {
+    auto t = constant<uint32_t, L>(a[i]);
+    refresh(t, rnd);
+
+    res = sec_add_modq(res, t, rnd);
+  }
+
+  return res;
+}
+
+// Converts Boolean shares of a secret ∈ [0, q) into arithmetic shares mod q, by
+// sampling all arithmetic shares but first, subtracting them from the secret,
+// under Boolean masking, and unmasking the difference, after a refresh, as the
+// first arithmetic share.
+template<size_t L, typename rng_t>
+static inline arith_t<L>
+b2a(const bool_t<uint32_t, L>& a, random_t<rng_t>& rnd)
+{
+  arith_t<L> res{};
+  auto acc = a;
+
+  for (size_t i = 1; i < L; i++) {
+    res[i] = rnd.next_zq();
+
+    auto t = constant<uint32_t, L>((-field::zq_t(res[i])).raw());
+    refresh(t, rnd);
+
+    acc = sec_add_modq(acc, t, rnd);
+  }
+
+  refresh(acc, rnd);
+  res[0] = unmask(acc);
+
+  return res;
+}
+
+// Given arithmetic shares of x ∈ Z_q and public c, bound, returns Boolean shares
+// of a single bit, being set iff (x + c) mod q < bound.
+template<size_t L, typename rng_t>
+static inline bool_t<uint32_t, L>
+sec_lt(arith_t<L> x, const uint32_t c, const uint32_t bound, random_t<rng_t>& rnd)
+{
+  x[0] = (field::zq_t(x[0]) + field::zq_t(c)).raw();
+
+  const auto u = a2b(x, rnd);
+  const auto t = sec_add(u, 0u - bound, rnd);
+
+  return shr(t, 31);
+}
+
+// Given Boolean shares of r ∈ [0, q), returns Boolean shares of its high order
+// bits ( see `reduction::highbits` ), computed as the reference implementation
+// of Dilithium does, using only shifts, additions and masks.
+template<uint32_t alpha, size_t L, typename rng_t>
+static inline bool_t<uint32_t, L>
+highbits(const bool_t<uint32_t, L>& r, random_t<rng_t>& rnd)
+  requires(dilithium_params::check_γ2(alpha / 2))
+{
+  const auto a = shr(sec_add(r, 127u, rnd), 7);
+
+  if constexpr (alpha == ((field::Q - 1) / 16)) {
+    // (a * 1025 + 2^21) >> 22, keeping low 4 bits
+    const auto t = sec_add(shl(a, 10), a, rnd);
+    return band(shr(sec_add(t, 1u << 21, rnd), 22), 15u);
+  } else {
+    // (a * 11275 + 2^23) >> 24, where 11275 = 11 * 1025
+    const auto t0 = sec_add(shl(a, 3), sec_add(shl(a, 1), a, rnd), rnd);
+    const auto t1 = sec_add(shl(t0, 10), t0, rnd);
+    const auto a1 = shr(sec_add(t1, 1u << 23, rnd), 24);
+
+    // a1 = 44 wraps around to 0, which happens iff 43 - a1 < 0
+    const auto m = sign_mask(sec_add(bnot(a1), 44u, rnd));
+    return bxor(a1, sec_and(m, a1, rnd));
+  }
+}
+
+// Given a lane-sliced vector, holding L interleaved arithmetic shares of each
+// coefficient ( see `masking::sliced_shares_t` ), returns shares of j -th one.
+template<size_t L>
+static inline arith_t<L>
+load(std::span<const field::zq_t> shares, const size_t j)
+{
+  arith_t<L> res{};
+  for (size_t i = 0; i < L; i++) {
+    res[i] = shares[j * L + i].raw();
+  }
+
+  return res;
+}
+
+// Re-randomizes Boolean shares of a byte string of length n, where i -th share
+// lives at [i * n, (i + 1) * n), see `refresh`.
+template<size_t n, size_t L, typename rng_t>
+static inline void
+refresh_bytes(std::span<uint8_t, n * L> shares, random_t<rng_t>& rnd)
+{
+  for (size_t b = 0; b < n; b++) {
+    for (size_t i = 0; i < L; i++) {
+      for (size_t j = i + 1; j < L; j++) {
+        const auto r = rnd.template next<uint8_t>();
+        shares[i * n + b] ^= r;
+        shares[j * n + b] ^= r;
+      }
+    }
+  }
+}
+
+// Splits a byte string of length n into L fresh Boolean shares, laid out as
+// `refresh_bytes` expects.
+template<size_t n, size_t L, typename rng_t>
+static inline void
+mask_bytes(std::span<const uint8_t, n> secret, std::span<uint8_t, n * L> shares, random_t<rng_t>& rnd)
+{
+  std::fill(shares.begin(), shares.end(), 0);
+  std::copy(secret.begin(), secret.end(), shares.begin());
+
+  refresh_bytes<n, L>(shares, rnd);
+}
+
+// Applies Keccak-f[1600] permutation on L Boolean shares of a state, stored
+// word-major i.e. i -th word of j -th share lives at index i * L + j, same as
+// `keccak_xn::permute` lays out its lanes. θ, ρ and π are linear, so they are
+// applied on each share, ι on first share only, while χ runs `sec_and`.
+template<size_t L, typename rng_t>
+static inline void
+permute(std::span<uint64_t, keccak_xn::WORDS * L> state, random_t<rng_t>& rnd)
+{
+  using namespace keccak_xn;
+
+  std::array<uint64_t, 5 * L> c{};
+  std::array<uint64_t, WORDS * L> b{};
+
+  for (size_t r = 0; r < ROUNDS; r++) {
+    // θ
+    for (size_t x = 0; x < 5; x++) {
+      for (size_t j = 0; j < L; j++) {
+        c[x * L + j] = state[(x + 0) * L + j] ^ state[(x + 5) * L + j] ^ state[(x + 10) * L + j] ^
+                       state[(x + 15) * L + j] ^ state[(x + 20) * L + j];
+      }
+    }
+
+    for (size_t x = 0; x < 5; x++) {
+      const size_t x0 = (x + 4) % 5;
+      const size_t x1 = (x + 1) % 5;
+
+      for (size_t j = 0; j < L; j++) {
+        const uint64_t t = c[x0 * L + j] ^ rotl(c[x1 * L + j], 1);
+
+        for (size_t y = 0; y < 5; y++) {
+          state[(x + 5 * y) * L + j] ^= t;
+        }
+      }
+    }
+
+    // ρ and π
+    for (size_t i = 0; i < WORDS; i++) {
+      for (size_t j = 0; j < L; j++) {
+        b[π_IDX[i] * L + j] = rotl(state[i * L + j], ROT[i]);
+      }
+    }
+
+    // χ
+    for (size_t y = 0; y < 5; y++) {
+      for (size_t x = 0; x < 5; x++) {
+        const size_t i0 = x + 5 * y;
+        const size_t i1 = (x + 1) % 5 + 5 * y;
+        const size_t i2 = (x + 2) % 5 + 5 * y;
+
+        bool_t<uint64_t, L> b1{};
+        bool_t<uint64_t, L> b2{};
+        for (size_t j = 0; j < L; j++) {
+          b1[j] = b[i1 * L + j];
+          b2[j] = b[i2 * L + j];
+        }
+
+        const auto t = sec_and(bnot(b1), b2, rnd);
+        for (size_t j = 0; j < L; j++) {
+          state[i0 * L + j] = b[i0 * L + j] ^ t[j];
+        }
+      }
+    }
+
+    // ι
+    state[0] ^= RC[r];
+  }
+
+  dilithium_utils::wipe(std::span(c));
+  dilithium_utils::wipe(std::span(b));
+}
+
+// SHAKE256 Xof over L Boolean shares of its state, absorbing public and masked
+// messages and squeezing masked output. Masked byte strings of length n keep
+// i -th share at [i * n, (i + 1) * n).
+//
+// Messages are absorbed, in order, before `finalize`, after which output can be
+// squeezed, as many times as needed.
+template<size_t L>
+struct shake256_t
+{
+private:
+  static constexpr size_t RATE_BYTES = shake256::RATE / 8;
+
+  std::array<uint64_t, keccak_xn::WORDS * L> state{};
+  size_t offset = 0;
+
+  // XORs i -th share of a byte into state, at current offset.
+  inline void xor_byte(const size_t i, const uint8_t byte)
+  {
+    state[(offset >> 3) * L + i] ^= static_cast<uint64_t>(byte) << ((offset & 7) * 8);
+  }
+
+  template<typename rng_t>
+  inline void make_room(random_t<rng_t>& rnd)
+  {
+    if (offset == RATE_BYTES) {
+      permute<L>(state, rnd);
+      offset = 0;
+    }
+  }
+
+public:
+  // Absorbs public message, into first share.
+  template<typename rng_t>
+  inline void absorb(std::span<const uint8_t> msg, random_t<rng_t>& rnd)
+  {
+    for (size_t b = 0; b < msg.size(); b++) {
+      make_room(rnd);
+      xor_byte(0, msg[b]);
+      offset++;
+    }
+  }
+
+  // Absorbs Boolean shares of a message of length n, each share into its own
+  // share of state.
+  template<size_t n, typename rng_t>
+  inline void absorb_masked(std::span<const uint8_t, n * L> msg, random_t<rng_t>& rnd)
+  {
+    for (size_t b = 0; b < n; b++) {
+      make_room(rnd);
+      for (size_t i = 0; i < L; i++) {
+        xor_byte(i, msg[i * n + b]);
+      }
+      offset++;
+    }
+  }
+
+  // Applies SHAKE domain separator and padding, on first share.
+  template<typename rng_t>
+  inline void finalize(random_t<rng_t>& rnd)
+  {
+    make_room(rnd);
+
+    xor_byte(0, 0x1f);
+    state[((RATE_BYTES - 1) >> 3) * L] ^= static_cast<uint64_t>(0x80) << (((RATE_BYTES - 1) & 7) * 8);
+
+    permute<L>(state, rnd);
+    offset = 0;
+  }
+
+  // Squeezes Boolean shares of n -bytes output.
+  template<size_t n, typename rng_t>
+  inline void squeeze(std::span<uint8_t, n * L> out, random_t<rng_t>& rnd)
+  {
+    for (size_t b = 0; b < n; b++) {
+      make_room(rnd);
+      for (size_t i = 0; i < L; i++) {
+        out[i * n + b] = static_cast<uint8_t>(state[(offset >> 3) * L + i] >> ((offset & 7) * 8));
+      }
+      offset++;
+    }
+  }
+
+  // Zeroes shares of state.
+  inline void wipe() { dilithium_utils::wipe(std::span(state)); }
+};
+
+}
@@ -0,0 +1,268 @@
+#pragma once
+#include "shake128.hpp"
+#include "shake256.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Multi-lane Keccak-f[1600] permutation and SHAKE{128, 256} Xofs, running
+// `lanes` -many independent sponges in lockstep
+namespace keccak_xn {
+
+// Number of Keccak instances, processed together by default, chosen to fill one
+// vector register with 64 -bit state words on the target machine, but never
+// less than 4.
+#if defined(__AVX512F__)
+constexpr size_t DEFAULT_LANES = 8;
+#else
+constexpr size_t DEFAULT_LANES = 4;
+#endif
+
+// Number of 64 -bit words in Keccak-f[1600] permutation state.
+constexpr size_t WORDS = 25;
+
+// Number of rounds of Keccak-f[1600] permutation.
+constexpr size_t ROUNDS = 24;
+
+// Round constants, see https://keccak.team/keccak_specs_summary.html
+constexpr std::array<uint64_t, ROUNDS> RC{
+  0x0000000000000001ul, 0x0000000000008082ul, 0x800000000000808aul, 0x8000000080008000ul, 0x000000000000808bul,
+  0x0000000080000001ul, 0x8000000080008081ul, 0x8000000000008009ul, 0x000000000000008aul, 0x0000000000000088ul,
+  0x0000000080008009ul, 0x000000008000000aul, 0x000000008000808bul, 0x800000000000008bul, 0x8000000000008089ul,
+  0x8000000000008003ul, 0x8000000000008002ul, 0x8000000000000080ul, 0x000000000000800aul, 0x800000008000000aul,
+  0x8000000080008081ul, 0x8000000000008080ul, 0x0000000080000001ul, 0x8000000080008008ul,
+};
+
+// Rotation offsets of ρ step, indexed by x + 5y.
+constexpr std::array<size_t, WORDS> ROT{ 0,  1,  62, 28, 27, 36, 44, 6,  55, 20, 3,  10, 43,
+                                         25, 39, 41, 45, 15, 21, 8,  18, 2,  61, 56, 14 };
+
+// Destination index ( of π step ) of word at x + 5y, which is y + 5((2x + 3y) mod 5).
+static consteval std::array<size_t, WORDS>
+compute_π_index()
+{
+  std::array<size_t, WORDS> res{};
+
+  for (size_t y = 0; y < 5; y++) {
+    for (size_t x = 0; x < 5; x++) {
+      res[x + 5 * y] = y + 5 * ((2 * x + 3 * y) % 5);
+    }
+  }
+
+  return res;
+}
+
+constexpr auto π_IDX = compute_π_index();
+
+static inline constexpr uint64_t
+rotl(const uint64_t v, const size_t n)
+{
+  return (n == 0) ? v : ((v << n) | (v >> (64 - n)));
+}
+
+// Applies Keccak-f[1600] permutation on each of `lanes` -many states, which are
+// stored word-major i.e. i -th word of j -th lane lives at index i * lanes + j,
+// so that innermost loops run over lanes and can be vectorized by compiler.
+template<size_t lanes>
+static inline constexpr void
+permute(std::span<uint64_t, WORDS * lanes> state)
+{
+  std::array<uint64_t, 5 * lanes> c{};
+  std::array<uint64_t, WORDS * lanes> b{};
+
+  for (size_t r = 0; r < ROUNDS; r++) {
+    // θ
+    for (size_t x = 0; x < 5; x++) {
+      for (size_t j = 0; j < lanes; j++) {
+        c[x * lanes + j] = state[(x + 0) * lanes + j] ^ state[(x + 5) * lanes + j] ^ state[(x + 10) * lanes + j] ^
+                           state[(x + 15) * lanes + j] ^ state[(x + 20) * lanes + j];
+      }
+    }
+
+    for (size_t x = 0; x < 5; x++) {
+      const size_t x0 = (x + 4) % 5;
+      const size_t x1 = (x + 1) % 5;
+
+      for (size_t j = 0; j < lanes; j++) {
+        const uint64_t t = c[x0 * lanes + j] ^ rotl(c[x1 * lanes + j], 1);
+
+        for (size_t y = 0; y < 5; y++) {
+          state[(x + 5 * y) * lanes + j] ^= t;
+        }
+      }
+    }
+
+    // ρ and π
+    for (size_t i = 0; i < WORDS; i++) {
+      for (size_t j = 0; j < lanes; j++) {
+        b[π_IDX[i] * lanes + j] = rotl(state[i * lanes + j], ROT[i]);
+      }
+    }
+
+    // χ
+    for (size_t y = 0; y < 5; y++) {
+      for (size_t x = 0; x < 5; x++) {
+        const size_t i0 = x + 5 * y;
+        const size_t i1 = (x + 1) % 5 + 5 * y;
+        const size_t i2 = (x + 2) % 5 + 5 * y;
+
+        for (size_t j = 0; j < lanes; j++) {
+          state[i0 * lanes + j] = b[i0 * lanes + j] ^ (~b[i1 * lanes + j] & b[i2 * lanes + j]);
+        }
+      }
+    }
+
+    // ι
+    for (size_t j = 0; j < lanes; j++) {
+      state[j] ^= RC[r];
+    }
+  }
+}
+
+// `lanes` -many SHAKE Xof instances ( with rate of `rate` -bits ), absorbing
+// their own messages and being squeezed in lockstep, so that one invocation of
+// multi-lane permutation serves all of them.
+//
+// Each lane's message is absorbed in one go ( see `absorb_finalize` ) and they
+// don't need to be of same length. After that, all lanes are squeezed for same
+// number of bytes.
+template<size_t rate, size_t lanes>
+struct xof_t
+{
+private:
+  static constexpr size_t RATE_BYTES = rate / 8;
+
+  std::array<uint64_t, WORDS * lanes> state{};
+  size_t offset = RATE_BYTES;
+
+public:
+  inline constexpr xof_t() = default;
+
+  // Absorbs, into each lane, concatenation of `segs` -many message segments and
+  // finalizes the sponge, applying SHAKE domain separator and padding.
+  //
+  // Lanes with shorter messages finish absorption earlier, their state is set
+  // aside and restored once longer messages of other lanes are absorbed.
+  template<size_t segs>
+  inline constexpr void absorb_finalize(const std::array<std::array<std::span<const uint8_t>, segs>, lanes>& msgs)
+  {
+    std::array<size_t, lanes> blocks{};
+    std::array<size_t, lanes> seg_idx{};
+    std::array<size_t, lanes> seg_off{};
+    std::array<uint64_t, WORDS * lanes> done{};
+
+    size_t max_blocks = 0;
+    for (size_t j = 0; j < lanes; j++) {
+      size_t len = 0;
+      for (size_t s = 0; s < segs; s++) {
+        len += msgs[j][s].size();
+      }
+
+      blocks[j] = len / RATE_BYTES + 1;
+      max_blocks = std::max(max_blocks, blocks[j]);
+    }
+
+    std::fill(state.begin(), state.end(), 0);
+
+    std::array<uint8_t, RATE_BYTES> blk{};
+
+    for (size_t bidx = 0; bidx < max_blocks; bidx++) {
+      for (size_t j = 0; j < lanes; j++) {
+        if (bidx >= blocks[j]) {
+          continue;
+        }
+
+        size_t filled = 0;
+        while ((filled < RATE_BYTES) && (seg_idx[j] < segs)) {
+          const auto seg = msgs[j][seg_idx[j]];
+          const size_t take = std::min(RATE_BYTES - filled, seg.size() - seg_off[j]);
+
+          std::copy_n(seg.begin() + seg_off[j], take, blk.begin() + filled);
+          filled += take;
+          seg_off[j] += take;
+
+          if (seg_off[j] == seg.size()) {
+            seg_idx[j]++;
+            seg_off[j] = 0;
+          }
+        }
+
+        std::fill(blk.begin() + filled, blk.end(), 0);
+
+        if (bidx + 1 == blocks[j]) {
+          blk[filled] ^= 0x1f;
+          blk[RATE_BYTES - 1] ^= 0x80;
+        }
+
+        for (size_t w = 0; w < RATE_BYTES / 8; w++) {
+          uint64_t word = 0;
+          for (size_t i = 0; i < 8; i++) {
+            word |= static_cast<uint64_t>(blk[w * 8 + i]) << (i * 8);
+          }
+
+          state[w * lanes + j] ^= word;
+        }
+      }
+
+      permute<lanes>(state);
+
+      for (size_t j = 0; j < lanes; j++) {
+        if ((bidx + 1 == blocks[j]) && (blocks[j] != max_blocks)) {
+          for (size_t w = 0; w < WORDS; w++) {
+            done[w * lanes + j] = state[w * lanes + j];
+          }
+        }
+      }
+    }
+
+    for (size_t j = 0; j < lanes; j++) {
+      if (blocks[j] != max_blocks) {
+        for (size_t w = 0; w < WORDS; w++) {
+          state[w * lanes + j] = done[w * lanes + j];
+        }
+      }
+    }
+
+    offset = 0;
+  }
+
+  // Squeezes `len` -bytes from each lane, writing j -th lane's output to
+  // out[j * len, (j + 1) * len).
+  inline constexpr void squeeze(std::span<uint8_t> out, const size_t len)
+  {
+    size_t done = 0;
+
+    while (done < len) {
+      if (offset == RATE_BYTES) {
+        permute<lanes>(state);
+        offset = 0;
+      }
+
+      const size_t take = std::min(RATE_BYTES - offset, len - done);
+
+      for (size_t j = 0; j < lanes; j++) {
+        for (size_t i = 0; i < take; i++) {
+          const size_t boff = offset + i;
+          const uint64_t word = state[(boff >> 3) * lanes + j];
+
+          out[j * len + done + i] = static_cast<uint8_t>(word >> ((boff & 7) * 8));
+        }
+      }
+
+      offset += take;
+      done += take;
+    }
+  }
+};
+
+// `lanes` -many SHAKE128 Xofs, running in lockstep.
+template<size_t lanes>
+using shake128_xn_t = xof_t<shake128::RATE, lanes>;
+
+// `lanes` -many SHAKE256 Xofs, running in lockstep.
+template<size_t lanes>
+using shake256_xn_t = xof_t<shake256::RATE, lanes>;
+
+}
@@ -0,0 +1,257 @@
+#pragma once
+#include "field.hpp"
+#include "ntt.hpp"
+#include "reduction.hpp"
+#include <array>
+#include <cstddef>
+#include <span>
+
+// Lane-sliced polynomial arithmetic, where L independent instances of the same
+// computation ( say L different signatures ) are processed together, one per
+// lane.
+//
+// A lane-sliced polynomial stores j -th coefficient of i -th lane at index
+// j * L + i, so that every innermost loop runs over lanes, doing exactly the same
+// operation on each of them, which lets compiler map lanes to SIMD registers. A
+// lane-sliced vector of k polynomials is k such polynomials, laid out one after
+// another.
+namespace lanes {
+
+// Number of lanes, processed together by default, chosen to fill one vector
+// register with 32 -bit coefficients on the target machine.
+#if defined(__AVX512F__)
+constexpr size_t DEFAULT_LANES = 16;
+#elif defined(__AVX2__)
+constexpr size_t DEFAULT_LANES = 8;
+#else
+constexpr size_t DEFAULT_LANES = 4;
+#endif
+
+// Lane-sliced NTT over L degree-255 polynomials, following exactly the same
+// schedule as `ntt::ntt`.
+template<size_t L>
+static inline constexpr void
+ntt(std::span<field::zq_t, ntt::N * L> poly)
+{
+  for (int64_t l = ntt::LOG2N - 1; l >= 0; l--) {
+    const size_t len = 1ul << l;
+    const size_t lenx2 = len << 1;
+    const size_t k_beg = ntt::N >> (l + 1);
+
+    for (size_t start = 0; start < ntt::N; start += lenx2) {
+      const size_t k_now = k_beg + (start >> (l + 1));
+      const field::zq_t ζ_exp = ntt::ζ_EXP[k_now];
+
+      for (size_t i = start; i < start + len; i++) {
+        for (size_t j = 0; j < L; j++) {
+          const auto tmp = ζ_exp * poly[(i + len) * L + j];
+
+          poly[(i + len) * L + j] = poly[i * L + j] - tmp;
+          poly[i * L + j] += tmp;
+        }
+      }
+    }
+  }
+}
+
+// Lane-sliced iNTT over L degree-255 polynomials, following exactly the same
+// schedule as `ntt::intt`.
+template<size_t L>
+static inline constexpr void
+intt(std::span<field::zq_t, ntt::N * L> poly)
+{
+  for (size_t l = 0; l < ntt::LOG2N; l++) {
+    const size_t len = 1ul << l;
+    const size_t lenx2 = len << 1;
+    const size_t k_beg = (ntt::N >> l) - 1;
+
+    for (size_t start = 0; start < ntt::N; start += lenx2) {
+      const size_t k_now = k_beg - (start >> (l + 1));
+      const field::zq_t neg_ζ_exp = ntt::ζ_NEG_EXP[k_now];
+
+      for (size_t i = start; i < start + len; i++) {
+        for (size_t j = 0; j < L; j++) {
+          const auto tmp = poly[i * L + j];
+
+          poly[i * L + j] += poly[(i + len) * L + j];
+          poly[(i + len) * L + j] = tmp - poly[(i + len) * L + j];
+          poly[(i + len) * L + j] *= neg_ζ_exp;
+        }
+      }
+    }
+  }
+
+  for (size_t i = 0; i < poly.size(); i++) {
+    poly[i] *= ntt::INV_N;
+  }
+}
+
+// Applies lane-sliced NTT on each of k lane-sliced polynomials.
+template<size_t k, size_t L>
+static inline constexpr void
+ntt(std::span<field::zq_t, k * ntt::N * L> vec)
+{
+  for (size_t i = 0; i < k; i++) {
+    ntt<L>(std::span<field::zq_t, ntt::N * L>(vec.subspan(i * ntt::N * L, ntt::N * L)));
+  }
+}
+
+// Applies lane-sliced iNTT on each of k lane-sliced polynomials.
+template<size_t k, size_t L>
+static inline constexpr void
+intt(std::span<field::zq_t, k * ntt::N * L> vec)
+{
+  for (size_t i = 0; i < k; i++) {
+    intt<L>(std::span<field::zq_t, ntt::N * L>(vec.subspan(i * ntt::N * L, ntt::N * L)));
+  }
+}
+
+// Lane-sliced multiplication of a k x l matrix with a l x 1 vector, both in
+// NTT representation, accumulating the result into k x 1 vector, where each
+// lane has its own matrix and vector.
+template<size_t k, size_t l, size_t L>
+static inline constexpr void
+matrix_multiply(std::span<const field::zq_t, k * l * ntt::N * L> a,
+                std::span<const field::zq_t, l * ntt::N * L> b,
+                std::span<field::zq_t, k * ntt::N * L> c)
+{
+  constexpr size_t plen = ntt::N * L;
+
+  for (size_t i = 0; i < k; i++) {
+    for (size_t j = 0; j < l; j++) {
+      const size_t aoff = (i * l + j) * plen;
+      const size_t boff = j * plen;
+      const size_t coff = i * plen;
+
+      for (size_t m = 0; m < plen; m++) {
+        c[coff + m] += a[aoff + m] * b[boff + m];
+      }
+    }
+  }
+}
+
+// Lane-sliced multiplication of a k x l matrix, which is same for all lanes
+// ( hence kept in standard layout ), with a lane-sliced l x 1 vector, both in
+// NTT representation, accumulating the result into lane-sliced k x 1 vector.
+template<size_t k, size_t l, size_t L>
+static inline constexpr void
+matrix_multiply_shared(std::span<const field::zq_t, k * l * ntt::N> a,
+                       std::span<const field::zq_t, l * ntt::N * L> b,
+                       std::span<field::zq_t, k * ntt::N * L> c)
+{
+  constexpr size_t plen = ntt::N * L;
+
+  for (size_t i = 0; i < k; i++) {
+    for (size_t j = 0; j < l; j++) {
+      const size_t aoff = (i * l + j) * ntt::N;
+      const size_t boff = j * plen;
+      const size_t coff = i * plen;
+
+      for (size_t m = 0; m < ntt::N; m++) {
+        const auto coeff = a[aoff + m];
+
+        for (size_t n = 0; n < L; n++) {
+          c[coff + m * L + n] += coeff * b[boff + m * L + n];
+        }
+      }
+    }
+  }
+}
+
+// Lane-sliced pointwise multiplication of one lane-sliced polynomial with each
+// of k lane-sliced polynomials, all in NTT representation.
+template<size_t k, size_t L>
+static inline constexpr void
+mul_by_poly(std::span<const field::zq_t, ntt::N * L> poly,
+            std::span<const field::zq_t, k * ntt::N * L> src_vec,
+            std::span<field::zq_t, k * ntt::N * L> dst_vec)
+{
+  constexpr size_t plen = ntt::N * L;
+
+  for (size_t i = 0; i < k; i++) {
+    for (size_t m = 0; m < plen; m++) {
+      dst_vec[i * plen + m] = poly[m] * src_vec[i * plen + m];
+    }
+  }
+}
+
+// Pointwise multiplication of one polynomial, which is same for all lanes
+// ( hence kept in standard layout ), with each of k lane-sliced polynomials,
+// all in NTT representation.
+template<size_t k, size_t L>
+static inline constexpr void
+mul_by_shared_poly(std::span<const field::zq_t, ntt::N> poly,
+                   std::span<const field::zq_t, k * ntt::N * L> src_vec,
+                   std::span<field::zq_t, k * ntt::N * L> dst_vec)
+{
+  constexpr size_t plen = ntt::N * L;
+
+  for (size_t i = 0; i < k; i++) {
+    for (size_t m = 0; m < ntt::N; m++) {
+      const auto coeff = poly[m];
+
+      for (size_t n = 0; n < L; n++) {
+        dst_vec[i * plen + m * L + n] = coeff * src_vec[i * plen + m * L + n];
+      }
+    }
+  }
+}
+
+// Lane-sliced addition of one vector of polynomials to another one s.t.
+// destination vector is mutated.
+template<size_t k, size_t L>
+static inline constexpr void
+add_to(std::span<const field::zq_t, k * ntt::N * L> src, std::span<field::zq_t, k * ntt::N * L> dst)
+{
+  for (size_t m = 0; m < dst.size(); m++) {
+    dst[m] += src[m];
+  }
+}
+
+// Lane-sliced subtraction of one vector of polynomials from another one s.t.
+// destination vector is mutated.
+template<size_t k, size_t L>
+static inline constexpr void
+sub_from(std::span<const field::zq_t, k * ntt::N * L> src, std::span<field::zq_t, k * ntt::N * L> dst)
+{
+  for (size_t m = 0; m < dst.size(); m++) {
+    dst[m] -= src[m];
+  }
+}
+
+// Lane-sliced recovery of high order bits, using hint bits, see
+// `reduction::use_hint`.
+template<size_t k, uint32_t alpha, size_t L>
+static inline constexpr void
+use_hint(std::span<const field::zq_t, k * ntt::N * L> polyh,
+         std::span<const field::zq_t, k * ntt::N * L> polyr,
+         std::span<field::zq_t, k * ntt::N * L> polyrz)
+{
+  for (size_t m = 0; m < polyrz.size(); m++) {
+    polyrz[m] = reduction::use_hint<alpha>(polyh[m], polyr[m]);
+  }
+}
+
+// Writes k polynomials of one lane ( in standard layout ) into j -th lane of a
+// lane-sliced vector of k polynomials.
+template<size_t k, size_t L>
+static inline constexpr void
+scatter(std::span<const field::zq_t, k * ntt::N> src, std::span<field::zq_t, k * ntt::N * L> dst, const size_t j)
+{
+  for (size_t m = 0; m < k * ntt::N; m++) {
+    dst[m * L + j] = src[m];
+  }
+}
+
+// Reads j -th lane of a lane-sliced vector of k polynomials, writing them in
+// standard layout.
+template<size_t k, size_t L>
+static inline constexpr void
+gather(std::span<const field::zq_t, k * ntt::N * L> src, std::span<field::zq_t, k * ntt::N> dst, const size_t j)
+{
+  for (size_t m = 0; m < k * ntt::N; m++) {
+    dst[m] = src[m * L + j];
+  }
+}
+
+}
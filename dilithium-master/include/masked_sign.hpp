@@ -0,0 +1,452 @@
+#pragma once
+#include "dilithium.hpp"
+#include "gadgets.hpp"
+#include "lanes.hpp"
+#include "masking.hpp"
+
+// Masked Dilithium signing, as a countermeasure against side-channel ( say DPA )
+// attacks on long-term secrets s1, s2, K and per-attempt secrets ρ', y
+namespace masked_sign {
+
+// Dilithium secret key, prepared for masked signing ( see `sign` ), where s1 and
+// s2 are kept as `order` + 1 arithmetic shares mod q, interleaved so that all
+// shares of a coefficient are processed together ( see
+// `masking::sliced_shares_t` ), and K as `order` + 1 Boolean shares.
+//
+// - A      : k x l matrix, sampled from ρ, in its NTT representation
+// - s1     : l x 1 vector, masked, in its NTT representation
+// - s2     : k x 1 vector, masked, in its NTT representation
+// - t0     : k x 1 vector, in its NTT representation ( not masked )
+// - key    : 32 -bytes key K, masked, used for deriving ρ' during deterministic
+//            signing, i -th share lives at [32 * i, 32 * (i + 1))
+// - tr     : 32 -bytes hash of the serialized public key
+//
+// Shares of s1, s2 and K are refreshed before every signature, so a masked
+// secret key must not be used by more than one signing thread at a time.
+template<size_t k, size_t l, size_t order>
+struct masked_seckey_t
+{
+  std::array<field::zq_t, k * l * ntt::N> A{};
+  masking::sliced_shares_t<l * ntt::N, order> s1{};
+  masking::sliced_shares_t<k * ntt::N, order> s2{};
+  std::array<field::zq_t, k * ntt::N> t0{};
+  std::array<uint8_t, 32 * (order + 1)> key{};
+  std::array<uint8_t, 32> tr{};
+
+  // Zeroes secret parts of the masked key.
+  inline void wipe()
+  {
+    s1.wipe();
+    s2.wipe();
+    dilithium_utils::wipe(std::span(t0));
+    dilithium_utils::wipe(std::span(key));
+  }
+};
+
+// Scratch space of masked Dilithium signing, holding unmasked workspace of a
+// signing attempt ( see `dilithium::workspace_t` ), which only receives public
+// values and the accepted signature, along with masked y, NTT(y) ( later reused
+// for z ), w ( later reused for w - cs2 - αw1 ), cs2 and Boolean shares of hint
+// bits.
+template<size_t k, size_t l, uint32_t γ2, size_t order>
+struct workspace_t
+{
+  static constexpr size_t L = order + 1;
+
+  dilithium::workspace_t<k, l, γ2> ws;
+
+  masking::sliced_shares_t<l * ntt::N, order> y;
+  std::array<field::zq_t, l * ntt::N * L> y_hat;
+  std::array<field::zq_t, k * ntt::N * L> w;
+  std::array<field::zq_t, k * ntt::N * L> cs2;
+  std::array<uint32_t, k * ntt::N * L> h;
+
+  // Overwrites the workspace with zeros, in a way compiler can't elide.
+  inline void wipe()
+  {
+    ws.wipe();
+    y.wipe();
+    dilithium_utils::wipe(std::span(y_hat));
+    dilithium_utils::wipe(std::span(w));
+    dilithium_utils::wipe(std::span(cs2));
+    dilithium_utils::wipe(std::span(h));
+  }
+};
+
+// Given a serialized Dilithium secret key, this routine prepares it for masked
+// signing, by expanding it ( see `dilithium::prepare_seckey` ) and splitting s1,
+// s2 and K into fresh shares, sampled from given generator. Unmasked expansion
+// is wiped before returning.
+template<size_t k, size_t l, size_t d, uint32_t η, size_t order, typename rng_t = csprng::csprng_t>
+static inline void
+prepare_seckey(std::span<const uint8_t, dilithium_utils::sec_key_len<k, l, η, d>()> seckey,
+               masked_seckey_t<k, l, order>& masked,
+               rng_t& prng = masking::rng())
+{
+  dilithium::prepared_seckey_t<k, l> prepared{};
+  dilithium::prepare_seckey<k, l, d, η>(seckey, prepared);
+
+  std::copy(prepared.A.begin(), prepared.A.end(), masked.A.begin());
+  std::copy(prepared.t0.begin(), prepared.t0.end(), masked.t0.begin());
+  std::copy(prepared.tr.begin(), prepared.tr.end(), masked.tr.begin());
+
+  gadgets::random_t<rng_t> rnd(prng);
+  gadgets::mask_bytes<32, order + 1>(prepared.key, masked.key, rnd);
+
+  // NTT is linear, so masking NTT representation is same as running NTT on
+  // each share of masked standard representation.
+  masked.s1.mask(prepared.s1, prng);
+  masked.s2.mask(prepared.s2, prng);
+
+  prepared.wipe();
+}
+
+// Given Boolean shares of 64 -bytes seed ρ' and 2 -bytes nonce, this routine
+// samples l x 1 masking vector y, same as `sampling::expand_mask` does, but
+// with SHAKE256 running over Boolean shares ( see `gadgets::shake256_t` ).
+// Coefficients u ∈ [0, 2γ1) are unpacked share by share, converted to
+// arithmetic shares ( see `gadgets::b2a` ) and y = γ1 - u is written, as
+// interleaved arithmetic shares.
+template<uint32_t γ1, size_t l, size_t order, typename rng_t>
+static inline void
+expand_mask(std::span<const uint8_t, 64 * (order + 1)> seed,
+            const uint16_t nonce,
+            masking::sliced_shares_t<l * ntt::N, order>& y,
+            gadgets::random_t<rng_t>& rnd)
+{
+  constexpr size_t L = order + 1;
+  constexpr size_t gbw = std::bit_width(2 * γ1 - 1u);
+  constexpr size_t len = ntt::N * gbw / 8;
+
+  std::array<uint8_t, len * L> buf{};
+  std::array<field::zq_t, ntt::N * L> u{};
+  auto vec = y.data();
+
+  for (size_t i = 0; i < l; i++) {
+    const uint16_t kappa = nonce + static_cast<uint16_t>(i);
+    const std::array<uint8_t, 2> nonce_bytes{ static_cast<uint8_t>(kappa >> 0), static_cast<uint8_t>(kappa >> 8) };
+
+    gadgets::shake256_t<L> hasher;
+    hasher.template absorb_masked<64>(seed, rnd);
+    hasher.absorb(nonce_bytes, rnd);
+    hasher.finalize(rnd);
+    hasher.template squeeze<len>(buf, rnd);
+    hasher.wipe();
+
+    // Unpacking is a bit permutation, so it's applied on each share.
+    for (size_t j = 0; j < L; j++) {
+      bit_packing::decode<gbw>(std::span<const uint8_t, len>(buf.data() + j * len, len),
+                               std::span<field::zq_t, ntt::N>(u.data() + j * ntt::N, ntt::N));
+    }
+
+    for (size_t c = 0; c < ntt::N; c++) {
+      gadgets::bool_t<uint32_t, L> bu{};
+      for (size_t j = 0; j < L; j++) {
+        bu[j] = u[j * ntt::N + c].raw();
+      }
+
+      const auto au = gadgets::b2a(bu, rnd);
+      const size_t off = (i * ntt::N + c) * L;
+
+      vec[off] = field::zq_t(γ1) - field::zq_t(au[0]);
+      for (size_t j = 1; j < L; j++) {
+        vec[off + j] = -field::zq_t(au[j]);
+      }
+    }
+  }
+
+  dilithium_utils::wipe(std::span(buf));
+  dilithium_utils::wipe(std::span(u));
+}
+
+// Given a lane-sliced vector of n coefficients, holding interleaved arithmetic
+// shares ( see `masking::sliced_shares_t` ), this routine returns truth value of
+// ‖x‖∞ < bound, computing it over Boolean shares ( see `gadgets::sec_lt` ), so
+// that nothing but the final truth value is ever unmasked.
+template<size_t n, size_t order, uint32_t bound, typename rng_t>
+static inline bool
+norm_below(std::span<const field::zq_t, n * (order + 1)> x, gadgets::random_t<rng_t>& rnd)
+{
+  constexpr size_t L = order + 1;
+
+  // centered |x| < bound iff (x + bound - 1) mod q < 2 * bound - 1
+  auto ok = gadgets::constant<uint32_t, L>(1u);
+  for (size_t j = 0; j < n; j++) {
+    const auto lt = gadgets::sec_lt<L>(gadgets::load<L>(x, j), bound - 1u, 2 * bound - 1u, rnd);
+    ok = gadgets::sec_and(ok, lt, rnd);
+  }
+
+  return gadgets::unmask(ok) == 1u;
+}
+
+// One attempt of masked Dilithium signing loop ( see `sign` ), using mask
+// sampled with nonce κ, computing candidate signature ( c~, z, h ) into the
+// workspace, returning truth value only when the attempt got accepted. It
+// computes same as `dilithium::sign_attempt`, so that accepted attempt is
+// exactly the same.
+//
+// y is sampled as shares ( see `expand_mask` ). Thereafter NTT(y), w = Ay,
+// cs1, cs2, z = y + cs1 and w - cs2 are computed share by share, all shares of a
+// coefficient in one go, while non-linear steps run on Boolean shares ( see
+// `gadgets.hpp` ). Unmasked values are exactly those, which are ( or are
+// derived from ) public parts of a signature
+//
+// - w1 = HighBits(w), computed over Boolean shares, which feeds c~
+// - truth value of each rejection check
+// - z and h, once the attempt is accepted
+//
+// Rejection checks don't need LowBits of w - cs2, as, w1 being public,
+//
+// - ‖LowBits(w - cs2)‖∞ < γ2 - β iff ‖w - cs2 - αw1‖∞ < γ2 - β
+// - h = 0 iff (w - cs2 + ct0 - αw1 + γ2 - 1 + [w1 = 0]) mod q < α + [w1 = 0]
+//
+// once the former holds, so both are range checks on arithmetic shares, with
+// public bounds. ct0 is computed unmasked, as t0 is not masked.
+template<size_t k,
+         size_t l,
+         uint32_t γ1,
+         uint32_t γ2,
+         uint32_t τ,
+         uint32_t β,
+         size_t ω,
+         size_t order,
+         typename rng_t>
+static inline bool
+sign_attempt(const masked_seckey_t<k, l, order>& seckey,
+             std::span<const uint8_t, 64> mu,
+             std::span<const uint8_t, 64 * (order + 1)> rho_prime,
+             const uint16_t kappa,
+             workspace_t<k, l, γ2, order>& mws,
+             gadgets::random_t<rng_t>& rnd)
+{
+  constexpr size_t L = order + 1;
+  constexpr uint32_t α = γ2 << 1;
+  constexpr size_t w1bw = dilithium::commitment_t<k, l, γ2>::w1bw;
+
+  auto& ws = mws.ws;
+  auto& cm = ws.cm;
+
+  DILITHIUM_PROBE_ARG(attempt_start, k, l, kappa);
+
+  // Commitment
+  expand_mask<γ1, l, order>(rho_prime, kappa, mws.y, rnd);
+
+  auto y = mws.y.data();
+  std::copy(y.begin(), y.end(), mws.y_hat.begin());
+  std::fill(mws.w.begin(), mws.w.end(), field::zq_t::zero());
+
+  lanes::ntt<l, L>(mws.y_hat);
+  lanes::matrix_multiply_shared<k, l, L>(seckey.A, mws.y_hat, mws.w);
+  lanes::intt<k, L>(mws.w);
+
+  for (size_t j = 0; j < k * ntt::N; j++) {
+    const auto bw = gadgets::a2b<L>(gadgets::load<L>(mws.w, j), rnd);
+    ws.w1[j] = field::zq_t(gadgets::unmask(gadgets::highbits<α>(bw, rnd)));
+  }
+
+  polyvec::encode<k, w1bw>(ws.w1, cm.w1);
+
+  // Response
+  DILITHIUM_PROBE(challenge_start, k, l);
+
+  shake256::shake256_t hasher;
+  hasher.absorb(mu);
+  hasher.absorb(cm.w1);
+  hasher.finalize();
+  hasher.squeeze(ws.c_tilde);
+
+  auto& c = ws.c;
+
+  std::fill(c.begin(), c.end(), field::zq_t::zero());
+  sampling::sample_in_ball<τ>(ws.c_tilde, c);
+  ntt::ntt(c);
+
+  DILITHIUM_PROBE(challenge_done, k, l);
+
+  auto& z = mws.y_hat;
+
+  lanes::mul_by_shared_poly<l, L>(c, seckey.s1.data(), z);
+  lanes::intt<l, L>(z);
+  lanes::add_to<l, L>(y, z);
+
+  constexpr uint32_t bound0 = γ1 - β;
+  constexpr uint32_t bound1 = γ2 - β;
+  constexpr field::zq_t bound2(γ2);
+
+  if (!norm_below<l * ntt::N, order, bound0>(z, rnd)) {
+    sign_profile::on_reject<k, l, γ1, γ2, τ, β, ω>(sign_profile::reject_t::z_norm);
+    return false;
+  }
+
+  auto& r = mws.w;
+  auto& cs2 = mws.cs2;
+
+  lanes::mul_by_shared_poly<k, L>(c, seckey.s2.data(), cs2);
+  lanes::intt<k, L>(cs2);
+  lanes::sub_from<k, L>(cs2, r);
+
+  // r = w - cs2 - αw1, subtracting public αw1 from first share only
+  for (size_t j = 0; j < k * ntt::N; j++) {
+    r[j * L] -= field::zq_t(α) * ws.w1[j];
+  }
+
+  if (!norm_below<k * ntt::N, order, bound1>(r, rnd)) {
+    sign_profile::on_reject<k, l, γ1, γ2, τ, β, ω>(sign_profile::reject_t::r0_norm);
+    return false;
+  }
+
+  auto& ct0 = ws.ct0;
+
+  polyvec::mul_by_poly<k>(c, seckey.t0, ct0);
+  polyvec::intt<k>(ct0);
+
+  const field::zq_t ct0_norm = polyvec::infinity_norm<k>(ct0);
+  if (ct0_norm >= bound2) {
+    sign_profile::on_reject<k, l, γ1, γ2, τ, β, ω>(sign_profile::reject_t::ct0_norm);
+    return false;
+  }
+
+  DILITHIUM_PROBE(hint_start, k, l);
+
+  auto count_1 = gadgets::constant<uint32_t, L>(0u);
+
+  for (size_t j = 0; j < k * ntt::N; j++) {
+    auto x = gadgets::load<L>(r, j);
+    x[0] = (field::zq_t(x[0]) + ct0[j]).raw();
+
+    const uint32_t e = static_cast<uint32_t>(ws.w1[j] == field::zq_t::zero());
+    const auto h = gadgets::bxor(gadgets::sec_lt<L>(x, γ2 - 1u + e, α + e, rnd), gadgets::constant<uint32_t, L>(1u));
+
+    std::copy(h.begin(), h.end(), mws.h.begin() + j * L);
+    count_1 = gadgets::sec_add(count_1, h, rnd);
+  }
+
+  const auto hint_ok = gadgets::shr(gadgets::sec_add(count_1, 0u - static_cast<uint32_t>(ω + 1), rnd), 31);
+
+  DILITHIUM_PROBE(hint_done, k, l);
+
+  if (gadgets::unmask(hint_ok) != 1u) {
+    sign_profile::on_reject<k, l, γ1, γ2, τ, β, ω>(sign_profile::reject_t::hint_cnt);
+    return false;
+  }
+
+  // Accepted, so z and h are public now
+  masking::recombine<l * ntt::N, order>(z, ws.z);
+
+  for (size_t j = 0; j < k * ntt::N; j++) {
+    gadgets::bool_t<uint32_t, L> h{};
+    std::copy_n(mws.h.begin() + j * L, L, h.begin());
+
+    ws.h[j] = field::zq_t(gadgets::unmask(h));
+  }
+
+  return true;
+}
+
+// Given a masked Dilithium secret key ( see `prepare_seckey` ), message and a
+// caller-provided workspace, this routine computes deterministic ( default
+// choice ) or randomized signature, which is exactly same as
+// `dilithium::sign` computes, under the unmasked secret key.
+//
+// Shares of s1, s2 and K are refreshed, using given generator, before signing.
+// ρ' is derived as Boolean shares, from shares of K, or from the caller's seed,
+// during randomized signing. Gadgets draw fresh randomness from same generator.
+// Masking order is a property of the secret key, see `masked_seckey_t`. Linear
+// steps run over order + 1 interleaved shares, in lockstep, while cost of
+// non-linear ones ( see `gadgets.hpp` ) grows quadratically with order.
+//
+// Workspace holds secret intermediates after signing, consider wiping it.
+template<size_t k,
+         size_t l,
+         size_t d,
+         uint32_t η,
+         uint32_t γ1,
+         uint32_t γ2,
+         uint32_t τ,
+         uint32_t β,
+         size_t ω,
+         bool randomized = false,
+         size_t order = masking::DEFAULT_ORDER,
+         typename rng_t = csprng::csprng_t>
+static inline void
+sign(masked_seckey_t<k, l, order>& seckey,
+     std::span<const uint8_t> msg,
+     std::span<uint8_t, dilithium_utils::sig_len<k, l, γ1, ω>()> sig,
+     std::span<const uint8_t, 64 * randomized> seed, // 64 -bytes seed, *only* for randomized signing
+     workspace_t<k, l, γ2, order>& mws,
+     rng_t& prng = masking::rng())
+  requires(dilithium_params::check_signing_params(k, l, d, η, γ1, γ2, τ, β, ω))
+{
+  const metrics::timer_t<k, l> timer(metrics::op_t::sign);
+
+  DILITHIUM_PROBE(sign_start, k, l);
+
+  constexpr size_t L = order + 1;
+
+  std::array<uint8_t, 64> mu{};
+  std::array<uint8_t, 64 * L> rho_prime{};
+
+  gadgets::random_t<rng_t> rnd(prng);
+
+  seckey.s1.refresh(prng);
+  seckey.s2.refresh(prng);
+  gadgets::refresh_bytes<32, L>(seckey.key, rnd);
+
+  shake256::shake256_t hasher;
+  hasher.absorb(seckey.tr);
+  hasher.absorb(msg);
+  hasher.finalize();
+  hasher.squeeze(mu);
+
+  if constexpr (randomized) {
+    gadgets::mask_bytes<64, L>(seed, rho_prime, rnd);
+  } else {
+    gadgets::shake256_t<L> crh;
+    crh.template absorb_masked<32>(seckey.key, rnd);
+    crh.absorb(mu, rnd);
+    crh.finalize(rnd);
+    crh.template squeeze<64>(rho_prime, rnd);
+    crh.wipe();
+  }
+
+  uint16_t kappa = 0;
+
+  while (!sign_attempt<k, l, γ1, γ2, τ, β, ω>(seckey, mu, rho_prime, kappa, mws, rnd)) {
+    kappa += static_cast<uint16_t>(l);
+  }
+
+  sign_profile::on_signature<k, l, γ1, γ2, τ, β, ω>(kappa / l + 1);
+
+  dilithium::encode_signature<k, l, γ1, ω>(mws.ws.c_tilde, mws.ws.z, mws.ws.h, sig);
+  dilithium_utils::wipe(std::span(rho_prime));
+
+  DILITHIUM_PROBE(sign_done, k, l);
+}
+
+// Same as `sign` ( above ), but uses its own workspace, which is wiped before
+// returning.
+template<size_t k,
+         size_t l,
+         size_t d,
+         uint32_t η,
+         uint32_t γ1,
+         uint32_t γ2,
+         uint32_t τ,
+         uint32_t β,
+         size_t ω,
+         bool randomized = false,
+         size_t order = masking::DEFAULT_ORDER>
+static inline void
+sign(masked_seckey_t<k, l, order>& seckey,
+     std::span<const uint8_t> msg,
+     std::span<uint8_t, dilithium_utils::sig_len<k, l, γ1, ω>()> sig,
+     std::span<const uint8_t, 64 * randomized> seed // 64 -bytes seed, *only* for randomized signing
+     )
+  requires(dilithium_params::check_signing_params(k, l, d, η, γ1, γ2, τ, β, ω))
+{
+  workspace_t<k, l, γ2, order> mws;
+  sign<k, l, d, η, γ1, γ2, τ, β, ω, randomized, order>(seckey, msg, sig, seed, mws);
+  mws.wipe();
+}
+
+}
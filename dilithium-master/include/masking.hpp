@@ -0,0 +1,224 @@
+#pragma once
+#include "csprng.hpp"
+#include "field.hpp"
+#include "ntt.hpp"
+#include "prng.hpp"
+#include "sampling.hpp"
+#include "shake128.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+// Arithmetic masking of secret polynomial vectors, as a countermeasure against
+// side-channel ( say DPA ) attacks
+namespace masking {
+
+// Masking order of masked signing ( see `masked_sign.hpp` ), unless asked
+// otherwise. A masking of order d splits each secret into d + 1 shares, so that
+// any d of them are independent of the secret. Key generation is unmasked ( order
+// 0 ), unless asked otherwise, see `dilithium::keygen`.
+constexpr size_t DEFAULT_ORDER = 1;
+
+// Returns CSPRNG of calling thread ( see `csprng::local` ), from which masks
+// are sampled, unless some other generator is given.
+inline csprng::csprng_t&
+rng()
+{
+  return csprng::local();
+}
+
+// Fills given vector of n ( a multiple of N ) coefficients with uniform random
+// elements of Z_q, sampled from given generator ( `prng::prng_t` or
+// `csprng::csprng_t` ). Bytes are read a SHAKE128 block at a time and turned into
+// coefficients by rejection sampling, see `sampling::rej_uniform`.
+template<size_t n, typename rng_t>
+static inline void
+random_fill(std::span<field::zq_t, n> vec, rng_t& prng)
+  requires((n % ntt::N) == 0)
+{
+  std::array<uint8_t, shake128::RATE / 8> buf{};
+
+  for (size_t off = 0; off < n; off += ntt::N) {
+    auto poly = std::span<field::zq_t, ntt::N>(vec.subspan(off, ntt::N));
+
+    size_t cnt = 0;
+    while (cnt < ntt::N) {
+      prng.read(buf);
+      cnt = sampling::rej_uniform(buf, poly, cnt);
+    }
+  }
+
+  dilithium_utils::wipe(std::span(buf));
+}
+
+// Arithmetic masking of a vector of n coefficients over Z_q, with `order` + 1
+// shares s.t. secret = share[0] + share[1] + ... + share[order] ( mod q ).
+//
+// Shares are plain arrays of `field::zq_t`, so that masked computation runs
+// same word-level ( auto-vectorized ) routines as unmasked one, on each share.
+// Masking of order 0 keeps the secret itself, as its only share.
+template<size_t n, size_t order>
+struct shares_t
+{
+  std::array<std::array<field::zq_t, n>, order + 1> share{};
+
+  // Returns i -th share.
+  inline std::span<field::zq_t, n> operator[](const size_t i) { return share[i]; }
+  inline std::span<const field::zq_t, n> operator[](const size_t i) const { return share[i]; }
+
+  // Splits given secret into shares, sampling `order` -many of them uniformly
+  // at random, while last one being the secret minus sum of the others.
+  template<typename rng_t = csprng::csprng_t>
+  inline void mask(std::span<const field::zq_t, n> secret, rng_t& prng = rng())
+  {
+    std::copy(secret.begin(), secret.end(), share[0].begin());
+
+    for (size_t i = 1; i <= order; i++) {
+      random_fill<n>(share[i], prng);
+
+      for (size_t j = 0; j < n; j++) {
+        share[0][j] -= share[i][j];
+      }
+    }
+  }
+
+  // Recombines shares, writing the secret.
+  inline void unmask(std::span<field::zq_t, n> secret) const
+  {
+    std::copy(share[0].begin(), share[0].end(), secret.begin());
+
+    for (size_t i = 1; i <= order; i++) {
+      for (size_t j = 0; j < n; j++) {
+        secret[j] += share[i][j];
+      }
+    }
+  }
+
+  // Re-randomizes shares, without changing the secret they recombine to, by
+  // adding a fresh random mask to each share but first and subtracting it from
+  // first one.
+  template<typename rng_t = csprng::csprng_t>
+  inline void refresh(rng_t& prng = rng())
+  {
+    std::array<field::zq_t, n> r{};
+
+    for (size_t i = 1; i <= order; i++) {
+      random_fill<n>(r, prng);
+
+      for (size_t j = 0; j < n; j++) {
+        share[i][j] += r[j];
+        share[0][j] -= r[j];
+      }
+    }
+
+    dilithium_utils::wipe(std::span(r));
+  }
+
+  // Applies given linear map on each share i.e. `fn(share)`, which computes
+  // same map of the secret, as long as the map is linear over Z_q ( say NTT or
+  // multiplication by a public polynomial ).
+  template<typename F>
+  inline void apply(F&& fn)
+  {
+    for (size_t i = 0; i <= order; i++) {
+      fn(std::span<field::zq_t, n>(share[i]));
+    }
+  }
+
+  // Zeroes all shares.
+  inline void wipe()
+  {
+    for (auto& s : share) {
+      dilithium_utils::wipe(std::span(s));
+    }
+  }
+};
+
+// Given a lane-sliced vector of n coefficients, holding `order` + 1 interleaved
+// shares of some secret ( see `sliced_shares_t` ), this routine recombines them,
+// writing the secret.
+template<size_t n, size_t order>
+static inline void
+recombine(std::span<const field::zq_t, n * (order + 1)> shares, std::span<field::zq_t, n> secret)
+{
+  constexpr size_t L = order + 1;
+
+  for (size_t j = 0; j < n; j++) {
+    auto acc = shares[j * L];
+
+    for (size_t i = 1; i < L; i++) {
+      acc += shares[j * L + i];
+    }
+
+    secret[j] = acc;
+  }
+}
+
+// Arithmetic masking of a vector of n coefficients over Z_q, with `order` + 1
+// shares, same as `shares_t`, but shares are interleaved i.e. j -th coefficient
+// of i -th share lives at index j * (order + 1) + i. That's the lane-sliced
+// layout of `lanes.hpp`, with one lane per share, so that lane-sliced routines
+// ( NTT, products, sums ) process all shares of a coefficient together, in one
+// SIMD register.
+template<size_t n, size_t order>
+struct sliced_shares_t
+{
+  static constexpr size_t L = order + 1;
+
+  std::array<field::zq_t, n * L> coeffs{};
+
+  // Returns interleaved shares, as a lane-sliced vector.
+  inline std::span<field::zq_t, n * L> data() { return coeffs; }
+  inline std::span<const field::zq_t, n * L> data() const { return coeffs; }
+
+  // Splits given secret into shares, sampling `order` -many of them uniformly
+  // at random, while first one being the secret minus sum of the others.
+  template<typename rng_t = csprng::csprng_t>
+  inline void mask(std::span<const field::zq_t, n> secret, rng_t& prng = rng())
+  {
+    std::array<field::zq_t, n> r{};
+
+    for (size_t j = 0; j < n; j++) {
+      coeffs[j * L] = secret[j];
+    }
+
+    for (size_t i = 1; i <= order; i++) {
+      random_fill<n>(r, prng);
+
+      for (size_t j = 0; j < n; j++) {
+        coeffs[j * L + i] = r[j];
+        coeffs[j * L] -= r[j];
+      }
+    }
+
+    dilithium_utils::wipe(std::span(r));
+  }
+
+  // Recombines shares, writing the secret.
+  inline void unmask(std::span<field::zq_t, n> secret) const { recombine<n, order>(coeffs, secret); }
+
+  // Re-randomizes shares, without changing the secret they recombine to, see
+  // `shares_t::refresh`.
+  template<typename rng_t = csprng::csprng_t>
+  inline void refresh(rng_t& prng = rng())
+  {
+    std::array<field::zq_t, n> r{};
+
+    for (size_t i = 1; i <= order; i++) {
+      random_fill<n>(r, prng);
+
+      for (size_t j = 0; j < n; j++) {
+        coeffs[j * L + i] += r[j];
+        coeffs[j * L] -= r[j];
+      }
+    }
+
+    dilithium_utils::wipe(std::span(r));
+  }
+
+  // Zeroes all shares.
+  inline void wipe() { dilithium_utils::wipe(std::span(coeffs)); }
+};
+
+}
@@ -0,0 +1,451 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Opt-in, library-wide metrics i.e. per parameter set counters of keygen, sign
+// and verify calls, signing attempts and their rejections, verification
+// failures by reason, prepared key cache hits, misses and evictions, along with
+// latency histograms, which can be scraped, from any thread, using `snapshot`.
+//
+// Enabled by compiling with `-DDILITHIUM_METRICS`, otherwise every hook
+// compiles to nothing. Define it consistently for all translation units, as
+// level wrappers ( say `dilithium3::sign` ) are inline functions.
+//
+// Counters are per-thread, each updated only by its own thread, without any
+// read-modify-write or lock, while `snapshot` reads them concurrently. A thread
+// registers its counters once, on its first recorded event, and on exit, folds
+// them into totals of exited threads.
+namespace metrics {
+
+#if defined(DILITHIUM_METRICS)
+constexpr bool ENABLED = true;
+#else
+constexpr bool ENABLED = false;
+#endif
+
+// Parameter sets, metrics are kept for, see `set_index`.
+constexpr size_t SET_CNT = 3;
+constexpr std::array<std::string_view, SET_CNT> SET_NAMES{ "dilithium2", "dilithium3", "dilithium5" };
+
+// Returns index of parameter set, given its matrix dimension, or `SET_CNT` if
+// it's none of NIST security level 2, 3, 5 parameter sets, in which case its
+// events aren't recorded.
+template<size_t k, size_t l>
+static inline constexpr size_t
+set_index()
+{
+  if constexpr (k == 4 && l == 4) {
+    return 0;
+  } else if constexpr (k == 6 && l == 5) {
+    return 1;
+  } else if constexpr (k == 8 && l == 7) {
+    return 2;
+  } else {
+    return SET_CNT;
+  }
+}
+
+// Operations, calls and latency are recorded for.
+enum class op_t : size_t
+{
+  keygen = 0,
+  sign = 1,
+  verify = 2,
+};
+constexpr size_t OP_CNT = 3;
+
+// Reasons a signature gets rejected by verification, in the order they are
+// checked, see `dilithium::decode_signature` and `dilithium::verify_from_mu`.
+enum class verify_fail_t : size_t
+{
+  hint_encoding = 0, // malformed encoding of hint bits
+  z_norm = 1,        // ||z||∞ >= γ1 - β
+  hint_cnt = 2,      // number of 1s in h > ω
+  challenge = 3,     // recomputed challenge hash doesn't match
+};
+constexpr size_t VERIFY_FAIL_CNT = 4;
+
+// Number of bound checks, rejecting a signing attempt, see
+// `sign_profile::reject_t`, which indexes signing rejection counters.
+constexpr size_t SIGN_REJECT_CNT = 4;
+
+// Caches of prepared keys, see `pubkey_cache.hpp` and `seckey_cache.hpp`.
+enum class cache_t : size_t
+{
+  pubkey = 0,
+  seckey = 1,
+};
+constexpr size_t CACHE_CNT = 2;
+
+// Events of a cache lookup.
+enum class cache_event_t : size_t
+{
+  hit = 0,
+  miss = 1,
+  eviction = 2,
+};
+constexpr size_t CACHE_EVENT_CNT = 3;
+
+// Number of buckets of a latency histogram. i -th bucket counts latencies
+// ∈ [2^(i-1), 2^i) nanoseconds, last one counts all longer ones.
+constexpr size_t HIST_LEN = 32;
+
+// Counter, written by a single thread, read by any thread. Being the only
+// writer, owning thread increments it using a plain load and store, instead
+// of a ( much costlier ) atomic read-modify-write.
+struct counter_t
+{
+  std::atomic<uint64_t> val{ 0 };
+
+  static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+  inline void add(const uint64_t n = 1) { val.store(val.load(std::memory_order_relaxed) + n, std::memory_order_relaxed); }
+  inline uint64_t load() const { return val.load(std::memory_order_relaxed); }
+};
+
+// Latency histogram, see `HIST_LEN`, with total latency, so that mean can be
+// computed. Counter type `T` is `counter_t`, when held by a thread, or
+// `uint64_t`, when part of a snapshot.
+template<typename T>
+struct histogram_t
+{
+  std::array<T, HIST_LEN> buckets{};
+  T sum_ns{};
+
+  // Returns number of recorded latencies.
+  inline uint64_t count() const
+    requires(std::is_same_v<T, uint64_t>)
+  {
+    uint64_t cnt = 0;
+    for (const auto v : buckets) {
+      cnt += v;
+    }
+    return cnt;
+  }
+
+  // Returns an upper bound on q -th quantile ( q ∈ [0, 1] ) of recorded
+  // latencies, in nanoseconds i.e. upper bound of bucket holding it, or 0 if
+  // nothing got recorded.
+  inline uint64_t quantile_ns(const double q) const
+    requires(std::is_same_v<T, uint64_t>)
+  {
+    const uint64_t cnt = count();
+    if (cnt == 0) {
+      return 0;
+    }
+
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(q * static_cast<double>(cnt) + 0.5));
+
+    uint64_t acc = 0;
+    for (size_t i = 0; i < HIST_LEN; i++) {
+      acc += buckets[i];
+      if (acc >= rank) {
+        return uint64_t{ 1 } << i;
+      }
+    }
+
+    return uint64_t{ 1 } << (HIST_LEN - 1);
+  }
+};
+
+// Metrics of one parameter set. Counter type `T` is `counter_t`, when held by a
+// thread, or `uint64_t`, when part of a snapshot.
+template<typename T>
+struct set_metrics_t
+{
+  std::array<T, OP_CNT> calls{};
+  T sign_attempts{};
+  std::array<T, SIGN_REJECT_CNT> sign_rejections{};
+  std::array<T, VERIFY_FAIL_CNT> verify_failures{};
+  std::array<std::array<T, CACHE_EVENT_CNT>, CACHE_CNT> cache_events{};
+  std::array<histogram_t<T>, OP_CNT> latency{};
+
+  inline uint64_t calls_of(const op_t op) const
+    requires(std::is_same_v<T, uint64_t>)
+  {
+    return calls[static_cast<size_t>(op)];
+  }
+
+  inline uint64_t failed_by(const verify_fail_t reason) const
+    requires(std::is_same_v<T, uint64_t>)
+  {
+    return verify_failures[static_cast<size_t>(reason)];
+  }
+
+  inline uint64_t events_of(const cache_t cache, const cache_event_t event) const
+    requires(std::is_same_v<T, uint64_t>)
+  {
+    return cache_events[static_cast<size_t>(cache)][static_cast<size_t>(event)];
+  }
+
+  inline const histogram_t<T>& latency_of(const op_t op) const { return latency[static_cast<size_t>(op)]; }
+};
+
+// Metrics of all parameter sets, summed over all threads, at some point in
+// time. Counters only ever grow, so rates are computed from difference of two
+// snapshots.
+struct snapshot_t
+{
+  std::array<set_metrics_t<uint64_t>, SET_CNT> sets{};
+
+  // Returns metrics of given parameter set.
+  template<size_t k, size_t l>
+  inline const set_metrics_t<uint64_t>& of() const
+    requires(set_index<k, l>() < SET_CNT)
+  {
+    return sets[set_index<k, l>()];
+  }
+};
+
+// Adds counters of a thread to those of a snapshot.
+template<size_t n>
+static inline void
+accumulate(const std::array<counter_t, n>& src, std::array<uint64_t, n>& dst)
+{
+  for (size_t i = 0; i < n; i++) {
+    dst[i] += src[i].load();
+  }
+}
+
+static inline void
+accumulate(const set_metrics_t<counter_t>& src, set_metrics_t<uint64_t>& dst)
+{
+  accumulate(src.calls, dst.calls);
+  dst.sign_attempts += src.sign_attempts.load();
+  accumulate(src.sign_rejections, dst.sign_rejections);
+  accumulate(src.verify_failures, dst.verify_failures);
+
+  for (size_t i = 0; i < CACHE_CNT; i++) {
+    accumulate(src.cache_events[i], dst.cache_events[i]);
+  }
+
+  for (size_t i = 0; i < OP_CNT; i++) {
+    accumulate(src.latency[i].buckets, dst.latency[i].buckets);
+    dst.latency[i].sum_ns += src.latency[i].sum_ns.load();
+  }
+}
+
+struct thread_metrics_t;
+
+// Registry of counters of live threads, along with totals of exited ones.
+struct registry_t
+{
+  std::mutex mtx;
+  std::vector<const thread_metrics_t*> live;
+  snapshot_t exited{};
+};
+
+inline registry_t&
+registry()
+{
+  static registry_t reg;
+  return reg;
+}
+
+// Counters of all parameter sets, held by one thread, registered for as long as
+// the thread lives.
+struct thread_metrics_t
+{
+  std::array<set_metrics_t<counter_t>, SET_CNT> sets{};
+
+  inline thread_metrics_t()
+  {
+    auto& reg = registry();
+
+    std::lock_guard<std::mutex> lock(reg.mtx);
+    reg.live.push_back(this);
+  }
+
+  thread_metrics_t(const thread_metrics_t&) = delete;
+  thread_metrics_t& operator=(const thread_metrics_t&) = delete;
+
+  inline ~thread_metrics_t()
+  {
+    auto& reg = registry();
+
+    std::lock_guard<std::mutex> lock(reg.mtx);
+    for (size_t i = 0; i < SET_CNT; i++) {
+      accumulate(sets[i], reg.exited.sets[i]);
+    }
+    reg.live.erase(std::find(reg.live.begin(), reg.live.end(), this));
+  }
+};
+
+// Returns counters of calling thread.
+inline thread_metrics_t&
+local()
+{
+  static thread_local thread_metrics_t tm;
+  return tm;
+}
+
+// Returns metrics, summed over all threads, live and exited. Counters of a live
+// thread are read while it may be updating them, so a snapshot may miss its
+// most recent events, which show up in next one.
+inline snapshot_t
+snapshot()
+{
+  auto& reg = registry();
+
+  std::lock_guard<std::mutex> lock(reg.mtx);
+
+  snapshot_t snap = reg.exited;
+  for (const auto* tm : reg.live) {
+    for (size_t i = 0; i < SET_CNT; i++) {
+      accumulate(tm->sets[i], snap.sets[i]);
+    }
+  }
+
+  return snap;
+}
+
+// Returns counters of the parameter set, held by calling thread.
+template<size_t k, size_t l>
+static inline set_metrics_t<counter_t>&
+local_set()
+{
+  return local().sets[set_index<k, l>()];
+}
+
+// Records a call of given operation.
+template<size_t k, size_t l>
+static inline void
+on_call(const op_t op)
+{
+  if constexpr (ENABLED && (set_index<k, l>() < SET_CNT)) {
+    local_set<k, l>().calls[static_cast<size_t>(op)].add();
+  }
+}
+
+// Records that a signature got computed, after given number of attempts, see
+// `sign_profile::on_signature`.
+template<size_t k, size_t l>
+static inline void
+on_sign(const size_t attempts)
+{
+  if constexpr (ENABLED && (set_index<k, l>() < SET_CNT)) {
+    auto& set = local_set<k, l>();
+
+    set.calls[static_cast<size_t>(op_t::sign)].add();
+    set.sign_attempts.add(attempts);
+  }
+}
+
+// Records that a signing attempt got rejected by given bound check, see
+// `sign_profile::reject_t`.
+template<size_t k, size_t l>
+static inline void
+on_sign_reject(const size_t check)
+{
+  if constexpr (ENABLED && (set_index<k, l>() < SET_CNT)) {
+    local_set<k, l>().sign_rejections[check].add();
+  }
+}
+
+// Records a verification, rejected by given check.
+template<size_t k, size_t l>
+static inline void
+on_verify_fail(const verify_fail_t reason)
+{
+  if constexpr (ENABLED && (set_index<k, l>() < SET_CNT)) {
+    auto& set = local_set<k, l>();
+
+    set.calls[static_cast<size_t>(op_t::verify)].add();
+    set.verify_failures[static_cast<size_t>(reason)].add();
+  }
+}
+
+// Records a verification, which passed cheap checks, with its outcome, which is
+// decided by comparing challenge hash.
+template<size_t k, size_t l>
+static inline void
+on_verify(const bool accepted)
+{
+  if constexpr (ENABLED && (set_index<k, l>() < SET_CNT)) {
+    auto& set = local_set<k, l>();
+
+    set.calls[static_cast<size_t>(op_t::verify)].add();
+    set.verify_failures[static_cast<size_t>(verify_fail_t::challenge)].add(!accepted);
+  }
+}
+
+// Records an event of a prepared key cache lookup.
+template<size_t k, size_t l>
+static inline void
+on_cache(const cache_t cache, const cache_event_t event)
+{
+  if constexpr (ENABLED && (set_index<k, l>() < SET_CNT)) {
+    local_set<k, l>().cache_events[static_cast<size_t>(cache)][static_cast<size_t>(event)].add();
+  }
+}
+
+// Records latency of one call of given operation, into its histogram.
+template<size_t k, size_t l>
+static inline void
+on_latency(const op_t op, const uint64_t lat)
+{
+  if constexpr (ENABLED && (set_index<k, l>() < SET_CNT)) {
+    auto& hist = local_set<k, l>().latency[static_cast<size_t>(op)];
+
+    hist.buckets[std::min<size_t>(std::bit_width(lat), HIST_LEN - 1)].add();
+    hist.sum_ns.add(lat);
+  }
+}
+
+// Number of timers of each operation, currently live on calling thread, see
+// `timer_t`.
+inline thread_local std::array<uint32_t, OP_CNT> timer_depth{};
+
+// Times a scope, recording its latency into histogram of given operation, once
+// it's left. Reads no clock unless metrics are enabled.
+//
+// Timers nest i.e. only outermost timer of an operation, on a thread, records,
+// so that public entry points ( say `sign` taking serialized secret key ) time
+// everything they do, including preparing keys and hashing message, while
+// routines they call, which are entry points too ( say `sign` taking prepared
+// secret key ), don't record same call twice.
+template<size_t k, size_t l>
+struct timer_t
+{
+  using clock_t = std::chrono::steady_clock;
+
+  op_t op;
+  bool outermost = false;
+  clock_t::time_point start{};
+
+  inline explicit timer_t(const op_t op)
+    : op(op)
+  {
+    if constexpr (ENABLED && (set_index<k, l>() < SET_CNT)) {
+      outermost = timer_depth[static_cast<size_t>(op)]++ == 0;
+      if (outermost) {
+        start = clock_t::now();
+      }
+    }
+  }
+
+  timer_t(const timer_t&) = delete;
+  timer_t& operator=(const timer_t&) = delete;
+
+  inline ~timer_t()
+  {
+    if constexpr (ENABLED && (set_index<k, l>() < SET_CNT)) {
+      timer_depth[static_cast<size_t>(op)]--;
+      if (outermost) {
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_t::now() - start).count();
+        on_latency<k, l>(op, static_cast<uint64_t>(std::max<int64_t>(ns, 0)));
+      }
+    }
+  }
+};
+
+}
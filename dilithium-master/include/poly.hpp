@@ -109,15 +109,20 @@ make_hint(std::span<const field::zq_t, ntt::N> polya,
 // Given a hint bit polynomial ( of degree-255 ) and another degree-255
 // polynomial r with arbitrary coefficients ∈ Z_q, this routine recovers high
 // order bits of r + z s.t. hint bit was computed using `make_hint` routine and
-// z is another degree-255 polynomial with small coefficients.
-template<uint32_t alpha>
+// z is another degree-255 polynomial with small coefficients. Set
+// `variable_time` only when operating on public data.
+template<uint32_t alpha, bool variable_time = false>
 static inline constexpr void
 use_hint(std::span<const field::zq_t, ntt::N> polyh,
          std::span<const field::zq_t, ntt::N> polyr,
          std::span<field::zq_t, ntt::N> polyrz)
 {
   for (size_t i = 0; i < polyh.size(); i++) {
-    polyrz[i] = reduction::use_hint<alpha>(polyh[i], polyr[i]);
+    if constexpr (variable_time) {
+      polyrz[i] = reduction::use_hint_vartime<alpha>(polyh[i], polyr[i]);
+    } else {
+      polyrz[i] = reduction::use_hint<alpha>(polyh[i], polyr[i]);
+    }
   }
 }
 
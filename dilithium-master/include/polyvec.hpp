@@ -1,11 +1,15 @@
 #pragma once
 #include "bit_packing.hpp"
+#include "compact.hpp"
+#include "exec.hpp"
 #include "field.hpp"
 #include "params.hpp"
 #include "poly.hpp"
 #include <array>
+#include <cassert>
 #include <cstdint>
 #include <span>
+#include <type_traits>
 
 // Utility functions applied on vector of degree-255 polynomials
 namespace polyvec {
@@ -13,30 +17,91 @@ namespace polyvec {
 using const_poly_t = std::span<const field::zq_t, ntt::N>;
 using poly_t = std::span<field::zq_t, ntt::N>;
 
+// Each routine, iterating over polynomials of a vector ( or matrix ), comes in
+// two forms. Shared one takes vector of any dimension, which must be a multiple
+// of N, see `compact.hpp`. Specialized one ( templated on dimension ) forwards
+// to the shared one. Routines taking an execution policy ( see `exec.hpp` ) do
+// so too, when the policy is sequential.
+
 // Applies NTT on a vector ( of dimension k x 1 ) of degree-255 polynomials
+DILITHIUM_SHARED inline constexpr void
+ntt(std::span<field::zq_t> vec)
+{
+  assert(vec.size() % ntt::N == 0);
+
+  for (size_t off = 0; off < vec.size(); off += ntt::N) {
+    ntt::ntt(poly_t(vec.subspan(off, ntt::N)));
+  }
+}
+
 template<size_t k>
 static inline constexpr void
 ntt(std::span<field::zq_t, k * ntt::N> vec)
 {
-  for (size_t i = 0; i < k; i++) {
-    const size_t off = i * ntt::N;
-    ntt::ntt(poly_t(vec.subspan(off, ntt::N)));
-  }
+  ntt(std::span<field::zq_t>(vec));
 }
 
 // Applies iNTT on a vector ( of dimension k x 1 ) of degree-255 polynomials
+DILITHIUM_SHARED inline constexpr void
+intt(std::span<field::zq_t> vec)
+{
+  assert(vec.size() % ntt::N == 0);
+
+  for (size_t off = 0; off < vec.size(); off += ntt::N) {
+    ntt::intt(poly_t(vec.subspan(off, ntt::N)));
+  }
+}
+
 template<size_t k>
 static inline constexpr void
 intt(std::span<field::zq_t, k * ntt::N> vec)
 {
-  for (size_t i = 0; i < k; i++) {
-    const size_t off = i * ntt::N;
-    ntt::intt(poly_t(vec.subspan(off, ntt::N)));
+  intt(std::span<field::zq_t>(vec));
+}
+
+// Applies NTT on a vector ( of dimension k x 1 ) of degree-255 polynomials,
+// transforming polynomials as per given execution policy ( see `exec.hpp` ).
+template<size_t k, typename policy_t>
+static inline void
+ntt(std::span<field::zq_t, k * ntt::N> vec, const policy_t& policy)
+{
+  if constexpr (std::is_same_v<policy_t, exec::sequential_t>) {
+    ntt(std::span<field::zq_t>(vec));
+  } else {
+    policy.for_each(k, [&](const size_t i) { ntt::ntt(poly_t(vec.subspan(i * ntt::N, ntt::N))); });
+  }
+}
+
+// Applies iNTT on a vector ( of dimension k x 1 ) of degree-255 polynomials,
+// transforming polynomials as per given execution policy ( see `exec.hpp` ).
+template<size_t k, typename policy_t>
+static inline void
+intt(std::span<field::zq_t, k * ntt::N> vec, const policy_t& policy)
+{
+  if constexpr (std::is_same_v<policy_t, exec::sequential_t>) {
+    intt(std::span<field::zq_t>(vec));
+  } else {
+    policy.for_each(k, [&](const size_t i) { ntt::intt(poly_t(vec.subspan(i * ntt::N, ntt::N))); });
   }
 }
 
 // Compresses vector ( of dimension k x 1 ) of degree-255 polynomials by
 // extracting out high and low order bits
+template<size_t d>
+DILITHIUM_SHARED inline constexpr void
+power2round(std::span<const field::zq_t> poly, std::span<field::zq_t> poly_hi, std::span<field::zq_t> poly_lo)
+  requires(dilithium_params::check_d(d))
+{
+  assert(poly.size() % ntt::N == 0);
+  assert(poly.size() == poly_hi.size() && poly.size() == poly_lo.size());
+
+  for (size_t off = 0; off < poly.size(); off += ntt::N) {
+    poly::power2round<d>(const_poly_t(poly.subspan(off, ntt::N)),
+                         poly_t(poly_hi.subspan(off, ntt::N)),
+                         poly_t(poly_lo.subspan(off, ntt::N)));
+  }
+}
+
 template<size_t k, size_t d>
 static inline constexpr void
 power2round(std::span<const field::zq_t, k * ntt::N> poly,
@@ -44,17 +109,60 @@ power2round(std::span<const field::zq_t, k * ntt::N> poly,
             std::span<field::zq_t, k * ntt::N> poly_lo)
   requires(dilithium_params::check_d(d))
 {
-  for (size_t i = 0; i < k; i++) {
-    const size_t off = i * ntt::N;
-    poly::power2round<d>(const_poly_t(poly.subspan(off, ntt::N)),
-                         poly_t(poly_hi.subspan(off, ntt::N)),
-                         poly_t(poly_lo.subspan(off, ntt::N)));
+  power2round<d>(std::span<const field::zq_t>(poly), std::span<field::zq_t>(poly_hi), std::span<field::zq_t>(poly_lo));
+}
+
+// Computes element ( i, j ) of product of matrices a ( of dimension a_rows x
+// a_cols ) and b ( of dimension a_cols x b_cols ), both in NTT domain, adding it
+// to polynomial c. Shared by all forms of `matrix_multiply` ( below ).
+DILITHIUM_SHARED inline constexpr void
+matrix_multiply_elem(std::span<const field::zq_t> a,
+                     std::span<const field::zq_t> b,
+                     poly_t c,
+                     const size_t i,
+                     const size_t j,
+                     const size_t a_cols,
+                     const size_t b_cols)
+{
+  std::array<field::zq_t, ntt::N> tmp{};
+  auto _tmp = std::span(tmp);
+
+  for (size_t k = 0; k < a_cols; k++) {
+    const size_t aoff = (i * a_cols + k) * ntt::N;
+    const size_t boff = (k * b_cols + j) * ntt::N;
+
+    poly::mul(const_poly_t(a.subspan(aoff, ntt::N)), const_poly_t(b.subspan(boff, ntt::N)), _tmp);
+
+    for (size_t l = 0; l < _tmp.size(); l++) {
+      c[l] += _tmp[l];
+    }
   }
 }
 
 // Given two matrices ( in NTT domain ) of compatible dimension, where each
 // matrix element is a degree-255 polynomial over Z_q | q = 2^23 -2^13 + 1, this
-// routine attempts to multiply and compute resulting matrix
+// routine attempts to multiply and compute resulting matrix. Matrix a is of
+// dimension a_rows x a_cols, while number of columns of b is inferred.
+DILITHIUM_SHARED inline constexpr void
+matrix_multiply(std::span<const field::zq_t> a,
+                std::span<const field::zq_t> b,
+                std::span<field::zq_t> c,
+                const size_t a_rows,
+                const size_t a_cols)
+{
+  assert(a.size() == a_rows * a_cols * ntt::N);
+  assert(b.size() % (a_cols * ntt::N) == 0);
+
+  const size_t b_cols = b.size() / (a_cols * ntt::N);
+  assert(c.size() == a_rows * b_cols * ntt::N);
+
+  for (size_t i = 0; i < a_rows; i++) {
+    for (size_t j = 0; j < b_cols; j++) {
+      matrix_multiply_elem(a, b, poly_t(c.subspan((i * b_cols + j) * ntt::N, ntt::N)), i, j, a_cols, b_cols);
+    }
+  }
+}
+
 template<size_t a_rows, size_t a_cols, size_t b_rows, size_t b_cols>
 static inline constexpr void
 matrix_multiply(std::span<const field::zq_t, a_rows * a_cols * ntt::N> a,
@@ -62,81 +170,108 @@ matrix_multiply(std::span<const field::zq_t, a_rows * a_cols * ntt::N> a,
                 std::span<field::zq_t, a_rows * b_cols * ntt::N> c)
   requires(dilithium_params::check_matrix_dim(a_cols, b_rows))
 {
-  std::array<field::zq_t, ntt::N> tmp{};
-  auto _tmp = std::span(tmp);
-
-  for (size_t i = 0; i < a_rows; i++) {
-    for (size_t j = 0; j < b_cols; j++) {
-      const size_t coff = (i * b_cols + j) * ntt::N;
-
-      for (size_t k = 0; k < a_cols; k++) {
-        const size_t aoff = (i * a_cols + k) * ntt::N;
-        const size_t boff = (k * b_cols + j) * ntt::N;
-
-        poly::mul(const_poly_t(a.subspan(aoff, ntt::N)), const_poly_t(b.subspan(boff, ntt::N)), _tmp);
+  matrix_multiply(std::span<const field::zq_t>(a), std::span<const field::zq_t>(b), std::span<field::zq_t>(c), a_rows, a_cols);
+}
 
-        for (size_t l = 0; l < _tmp.size(); l++) {
-          c[coff + l] += _tmp[l];
-        }
-      }
-    }
+// Multiplies two matrices ( in NTT domain ), see `matrix_multiply` ( above ),
+// computing elements of resulting matrix as per given execution policy ( see
+// `exec.hpp` ), where each element is computed as a whole, by one thread.
+template<size_t a_rows, size_t a_cols, size_t b_rows, size_t b_cols, typename policy_t>
+static inline void
+matrix_multiply(std::span<const field::zq_t, a_rows * a_cols * ntt::N> a,
+                std::span<const field::zq_t, b_rows * b_cols * ntt::N> b,
+                std::span<field::zq_t, a_rows * b_cols * ntt::N> c,
+                const policy_t& policy)
+  requires(dilithium_params::check_matrix_dim(a_cols, b_rows))
+{
+  if constexpr (std::is_same_v<policy_t, exec::sequential_t>) {
+    matrix_multiply(std::span<const field::zq_t>(a), std::span<const field::zq_t>(b), std::span<field::zq_t>(c), a_rows, a_cols);
+  } else {
+    policy.for_each(a_rows * b_cols, [&](const size_t idx) {
+      matrix_multiply_elem(a, b, poly_t(c.subspan(idx * ntt::N, ntt::N)), idx / b_cols, idx % b_cols, a_cols, b_cols);
+    });
   }
 }
 
 // Given a vector ( of dimension k x 1 ) of degree-255 polynomials, this
 // routine adds it to another polynomial vector of same dimension s.t.
 // destination vector is mutated.
-template<size_t k>
-static inline constexpr void
-add_to(std::span<const field::zq_t, k * ntt::N> src, std::span<field::zq_t, k * ntt::N> dst)
+DILITHIUM_SHARED inline constexpr void
+add_to(std::span<const field::zq_t> src, std::span<field::zq_t> dst)
 {
-  for (size_t i = 0; i < k; i++) {
-    const size_t off = i * ntt::N;
+  assert(src.size() % ntt::N == 0);
+  assert(src.size() == dst.size());
 
+  for (size_t off = 0; off < src.size(); off += ntt::N) {
     for (size_t l = 0; l < ntt::N; l++) {
       dst[off + l] += src[off + l];
     }
   }
 }
 
-// Given a vector ( of dimension k x 1 ) of degree-255 polynomials, this
-// routine negates each coefficient.
 template<size_t k>
 static inline constexpr void
-neg(std::span<field::zq_t, k * ntt::N> vec)
+add_to(std::span<const field::zq_t, k * ntt::N> src, std::span<field::zq_t, k * ntt::N> dst)
 {
-  for (size_t i = 0; i < k; i++) {
-    const size_t off = i * ntt::N;
+  add_to(std::span<const field::zq_t>(src), std::span<field::zq_t>(dst));
+}
+
+// Given a vector ( of dimension k x 1 ) of degree-255 polynomials, this
+// routine negates each coefficient.
+DILITHIUM_SHARED inline constexpr void
+neg(std::span<field::zq_t> vec)
+{
+  assert(vec.size() % ntt::N == 0);
 
+  for (size_t off = 0; off < vec.size(); off += ntt::N) {
     for (size_t l = 0; l < ntt::N; l++) {
       vec[off + l] = -vec[off + l];
     }
   }
 }
 
+template<size_t k>
+static inline constexpr void
+neg(std::span<field::zq_t, k * ntt::N> vec)
+{
+  neg(std::span<field::zq_t>(vec));
+}
+
 // Given a vector ( of dimension k x 1 ) of degree-255 polynomials s.t. each
 // coefficient ∈ [-x, x], this routine subtracts each coefficient from x so that
 // coefficients now stay in [0, 2x].
+template<uint32_t x>
+DILITHIUM_SHARED inline constexpr void
+sub_from_x(std::span<field::zq_t> vec)
+{
+  assert(vec.size() % ntt::N == 0);
+
+  for (size_t off = 0; off < vec.size(); off += ntt::N) {
+    poly::sub_from_x<x>(poly_t(vec.subspan(off, ntt::N)));
+  }
+}
+
 template<size_t k, uint32_t x>
 static inline constexpr void
 sub_from_x(std::span<field::zq_t, k * ntt::N> vec)
 {
-  for (size_t i = 0; i < k; i++) {
-    const size_t off = i * ntt::N;
-    poly::sub_from_x<x>(poly_t(vec.subspan(off, ntt::N)));
-  }
+  sub_from_x<x>(std::span<field::zq_t>(vec));
 }
 
 // Given a vector ( of dimension k x 1 ) of degree-255 polynomials, this routine
 // encodes each of those polynomials into 32 x sbw -bytes, writing to a
 // (k x 32 x sbw) -bytes destination array.
-template<size_t k, size_t sbw>
-static inline constexpr void
-encode(std::span<const field::zq_t, k * ntt::N> src, std::span<uint8_t, k * sbw * ntt::N / 8> dst)
+template<size_t sbw>
+DILITHIUM_SHARED inline constexpr void
+encode(std::span<const field::zq_t> src, std::span<uint8_t> dst)
 {
   // Byte length of degree-255 polynomial after serialization
   constexpr size_t poly_blen = sbw * ntt::N / 8;
 
+  const size_t k = src.size() / ntt::N;
+  assert(src.size() == k * ntt::N);
+  assert(dst.size() == k * poly_blen);
+
   for (size_t i = 0; i < k; i++) {
     const size_t off0 = i * ntt::N;
     const size_t off1 = i * poly_blen;
@@ -146,16 +281,27 @@ encode(std::span<const field::zq_t, k * ntt::N> src, std::span<uint8_t, k * sbw
   }
 }
 
+template<size_t k, size_t sbw>
+static inline constexpr void
+encode(std::span<const field::zq_t, k * ntt::N> src, std::span<uint8_t, k * sbw * ntt::N / 8> dst)
+{
+  encode<sbw>(std::span<const field::zq_t>(src), std::span<uint8_t>(dst));
+}
+
 // Given a byte array of length (k x 32 x sbw) -bytes, this routine decodes them
 // into k degree-255 polynomials, writing them to a column vector of dimension
 // k x 1.
-template<size_t k, size_t sbw>
-static inline constexpr void
-decode(std::span<const uint8_t, k * sbw * ntt::N / 8> src, std::span<field::zq_t, k * ntt::N> dst)
+template<size_t sbw>
+DILITHIUM_SHARED inline constexpr void
+decode(std::span<const uint8_t> src, std::span<field::zq_t> dst)
 {
   // Byte length of degree-255 polynomial after serialization
   constexpr size_t poly_blen = sbw * ntt::N / 8;
 
+  const size_t k = dst.size() / ntt::N;
+  assert(dst.size() == k * ntt::N);
+  assert(src.size() == k * poly_blen);
+
   for (size_t i = 0; i < k; i++) {
     const size_t off0 = i * poly_blen;
     const size_t off1 = i * ntt::N;
@@ -165,44 +311,79 @@ decode(std::span<const uint8_t, k * sbw * ntt::N / 8> src, std::span<field::zq_t
   }
 }
 
+template<size_t k, size_t sbw>
+static inline constexpr void
+decode(std::span<const uint8_t, k * sbw * ntt::N / 8> src, std::span<field::zq_t, k * ntt::N> dst)
+{
+  decode<sbw>(std::span<const uint8_t>(src), std::span<field::zq_t>(dst));
+}
+
 // Given a vector ( of dimension k x 1 ) of degree-255 polynomials, this routine
 // extracts out high order bits from each coefficient
+template<uint32_t alpha>
+DILITHIUM_SHARED inline constexpr void
+highbits(std::span<const field::zq_t> src, std::span<field::zq_t> dst)
+{
+  assert(src.size() % ntt::N == 0);
+  assert(src.size() == dst.size());
+
+  for (size_t off = 0; off < src.size(); off += ntt::N) {
+    poly::highbits<alpha>(const_poly_t(src.subspan(off, ntt::N)), poly_t(dst.subspan(off, ntt::N)));
+  }
+}
+
 template<size_t k, uint32_t alpha>
 static inline constexpr void
 highbits(std::span<const field::zq_t, k * ntt::N> src, std::span<field::zq_t, k * ntt::N> dst)
 {
-  for (size_t i = 0; i < k; i++) {
-    const size_t off = i * ntt::N;
-    poly::highbits<alpha>(const_poly_t(src.subspan(off, ntt::N)), poly_t(dst.subspan(off, ntt::N)));
-  }
+  highbits<alpha>(std::span<const field::zq_t>(src), std::span<field::zq_t>(dst));
 }
 
 // Given a vector ( of dimension k x 1 ) of degree-255 polynomials, this routine
 // extracts out low order bits from each coefficient, while not mutating operand
+template<uint32_t alpha>
+DILITHIUM_SHARED inline constexpr void
+lowbits(std::span<const field::zq_t> src, std::span<field::zq_t> dst)
+{
+  assert(src.size() % ntt::N == 0);
+  assert(src.size() == dst.size());
+
+  for (size_t off = 0; off < src.size(); off += ntt::N) {
+    poly::lowbits<alpha>(const_poly_t(src.subspan(off, ntt::N)), poly_t(dst.subspan(off, ntt::N)));
+  }
+}
+
 template<size_t k, uint32_t alpha>
 static inline constexpr void
 lowbits(std::span<const field::zq_t, k * ntt::N> src, std::span<field::zq_t, k * ntt::N> dst)
 {
-  for (size_t i = 0; i < k; i++) {
-    const size_t off = i * ntt::N;
-    poly::lowbits<alpha>(const_poly_t(src.subspan(off, ntt::N)), poly_t(dst.subspan(off, ntt::N)));
-  }
+  lowbits<alpha>(std::span<const field::zq_t>(src), std::span<field::zq_t>(dst));
 }
 
 // Given a vector ( of dimension k x 1 ) of degree-255 polynomials and one
 // multiplier polynomial, this routine performs k pointwise polynomial
 // multiplications when each of these polynomials are in their NTT
 // representation, while not mutating operand polynomials.
+DILITHIUM_SHARED inline constexpr void
+mul_by_poly(std::span<const field::zq_t, ntt::N> poly,
+            std::span<const field::zq_t> src_vec,
+            std::span<field::zq_t> dst_vec)
+{
+  assert(src_vec.size() % ntt::N == 0);
+  assert(src_vec.size() == dst_vec.size());
+
+  for (size_t off = 0; off < src_vec.size(); off += ntt::N) {
+    poly::mul(poly, const_poly_t(src_vec.subspan(off, ntt::N)), poly_t(dst_vec.subspan(off, ntt::N)));
+  }
+}
+
 template<size_t k>
 static inline constexpr void
 mul_by_poly(std::span<const field::zq_t, ntt::N> poly,
             std::span<const field::zq_t, k * ntt::N> src_vec,
             std::span<field::zq_t, k * ntt::N> dst_vec)
 {
-  for (size_t i = 0; i < k; i++) {
-    const size_t off = i * ntt::N;
-    poly::mul(poly, const_poly_t(src_vec.subspan(off, ntt::N)), poly_t(dst_vec.subspan(off, ntt::N)));
-  }
+  mul_by_poly(poly, std::span<const field::zq_t>(src_vec), std::span<field::zq_t>(dst_vec));
 }
 
 // Computes infinity norm of a vector ( of dimension k x 1 ) of degree-255
@@ -210,79 +391,120 @@ mul_by_poly(std::span<const field::zq_t, ntt::N> poly,
 //
 // See point `Sizes of elements` in section 2.1 of Dilithium specification
 // https://pq-crystals.org/dilithium/data/dilithium-specification-round3-20210208.pdf
-template<size_t k>
-static inline constexpr field::zq_t
-infinity_norm(std::span<const field::zq_t, k * ntt::N> vec)
+DILITHIUM_SHARED inline constexpr field::zq_t
+infinity_norm(std::span<const field::zq_t> vec)
 {
+  assert(vec.size() % ntt::N == 0);
+
   auto res = field::zq_t::zero();
 
-  for (size_t i = 0; i < k; i++) {
-    const size_t off = i * ntt::N;
+  for (size_t off = 0; off < vec.size(); off += ntt::N) {
     res = std::max(res, poly::infinity_norm(const_poly_t(vec.subspan(off, ntt::N))));
   }
 
   return res;
 }
 
+template<size_t k>
+static inline constexpr field::zq_t
+infinity_norm(std::span<const field::zq_t, k * ntt::N> vec)
+{
+  return infinity_norm(std::span<const field::zq_t>(vec));
+}
+
 // Given two vector ( of dimension k x 1 ) of degree-255 polynomials, this
 // routine computes hint bit for each coefficient, using `make_hint` routine.
+template<uint32_t alpha>
+DILITHIUM_SHARED inline constexpr void
+make_hint(std::span<const field::zq_t> polya, std::span<const field::zq_t> polyb, std::span<field::zq_t> polyc)
+{
+  assert(polya.size() % ntt::N == 0);
+  assert(polya.size() == polyb.size() && polya.size() == polyc.size());
+
+  for (size_t off = 0; off < polya.size(); off += ntt::N) {
+    poly::make_hint<alpha>(const_poly_t(polya.subspan(off, ntt::N)),
+                           const_poly_t(polyb.subspan(off, ntt::N)),
+                           poly_t(polyc.subspan(off, ntt::N)));
+  }
+}
+
 template<size_t k, uint32_t alpha>
 static inline constexpr void
 make_hint(std::span<const field::zq_t, k * ntt::N> polya,
           std::span<const field::zq_t, k * ntt::N> polyb,
           std::span<field::zq_t, k * ntt::N> polyc)
 {
-  for (size_t i = 0; i < k; i++) {
-    const size_t off = i * ntt::N;
-    poly::make_hint<alpha>(const_poly_t(polya.subspan(off, ntt::N)),
-                           const_poly_t(polyb.subspan(off, ntt::N)),
-                           poly_t(polyc.subspan(off, ntt::N)));
-  }
+  make_hint<alpha>(std::span<const field::zq_t>(polya), std::span<const field::zq_t>(polyb), std::span<field::zq_t>(polyc));
 }
 
 // Recovers high order bits of a vector of degree-255 polynomials (  i.e. r + z
 // ) s.t. hint bits ( say h ) and another polynomial vector ( say r ) are
-// provided.
-template<size_t k, uint32_t alpha>
+// provided. Set `variable_time` only when operating on public data.
+template<uint32_t alpha, bool variable_time = false>
+DILITHIUM_SHARED inline constexpr void
+use_hint(std::span<const field::zq_t> polyh, std::span<const field::zq_t> polyr, std::span<field::zq_t> polyrz)
+{
+  assert(polyh.size() % ntt::N == 0);
+  assert(polyh.size() == polyr.size() && polyh.size() == polyrz.size());
+
+  for (size_t off = 0; off < polyh.size(); off += ntt::N) {
+    poly::use_hint<alpha, variable_time>(const_poly_t(polyh.subspan(off, ntt::N)),
+                                         const_poly_t(polyr.subspan(off, ntt::N)),
+                                         poly_t(polyrz.subspan(off, ntt::N)));
+  }
+}
+
+template<size_t k, uint32_t alpha, bool variable_time = false>
 static inline constexpr void
 use_hint(std::span<const field::zq_t, k * ntt::N> polyh,
          std::span<const field::zq_t, k * ntt::N> polyr,
          std::span<field::zq_t, k * ntt::N> polyrz)
 {
-  for (size_t i = 0; i < k; i++) {
-    const size_t off = i * ntt::N;
-    poly::use_hint<alpha>(const_poly_t(polyh.subspan(off, ntt::N)),
-                          const_poly_t(polyr.subspan(off, ntt::N)),
-                          poly_t(polyrz.subspan(off, ntt::N)));
-  }
+  use_hint<alpha, variable_time>(
+    std::span<const field::zq_t>(polyh), std::span<const field::zq_t>(polyr), std::span<field::zq_t>(polyrz));
 }
 
 // Given a vector ( of dimension k x 1 ) of degree-255 polynomials, this routine
 // counts number of coefficients having value 1.
-template<size_t k>
-static inline constexpr size_t
-count_1s(std::span<const field::zq_t, k * ntt::N> vec)
+DILITHIUM_SHARED inline constexpr size_t
+count_1s(std::span<const field::zq_t> vec)
 {
+  assert(vec.size() % ntt::N == 0);
+
   size_t cnt = 0;
 
-  for (size_t i = 0; i < k; i++) {
-    const size_t off = i * ntt::N;
+  for (size_t off = 0; off < vec.size(); off += ntt::N) {
     cnt += poly::count_1s(const_poly_t(vec.subspan(off, ntt::N)));
   }
 
   return cnt;
 }
 
+template<size_t k>
+static inline constexpr size_t
+count_1s(std::span<const field::zq_t, k * ntt::N> vec)
+{
+  return count_1s(std::span<const field::zq_t>(vec));
+}
+
 // Given a vector ( of dimension k x 1 ) of degree-255 polynomials, this routine
 // shifts each coefficient leftwards by d bits
+template<size_t d>
+DILITHIUM_SHARED inline constexpr void
+shl(std::span<field::zq_t> vec)
+{
+  assert(vec.size() % ntt::N == 0);
+
+  for (size_t off = 0; off < vec.size(); off += ntt::N) {
+    poly::shl<d>(poly_t(vec.subspan(off, ntt::N)));
+  }
+}
+
 template<size_t k, size_t d>
 static inline constexpr void
 shl(std::span<field::zq_t, k * ntt::N> vec)
 {
-  for (size_t i = 0; i < k; i++) {
-    const size_t off = i * ntt::N;
-    poly::shl<d>(poly_t(vec.subspan(off, ntt::N)));
-  }
+  shl<d>(std::span<field::zq_t>(vec));
 }
 
 }
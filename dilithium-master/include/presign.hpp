@@ -0,0 +1,200 @@
+#pragma once
+#include "csprng.hpp"
+#include "dilithium.hpp"
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Offline/ online split of randomized Dilithium signing, where message
+// independent part of signing attempts is precomputed in background
+namespace presign {
+
+// Bounded pool of precomputed, single-use commitments ( see
+// `dilithium::commitment_t` ) of randomized signing attempts, under one
+// prepared secret key.
+//
+// Background threads keep the pool filled, each commitment being computed
+// from its own fresh random seed ρ' ( with κ = 0 ), so that expand_mask, NTT(y),
+// Ay, iNTT and HighBits are done offline. Online signing ( see `sign_online` )
+// only computes μ, c, z, r0 and hint bits, taking another commitment for each
+// rejected attempt.
+//
+// Each commitment is handed out exactly once and wiped right after its use.
+// When the pool runs dry, commitment is computed by the signing thread itself,
+// so that signing never blocks on background threads. Commitments still queued
+// are wiped when the pool is destroyed.
+template<size_t k, size_t l, size_t d, uint32_t η, uint32_t γ1, uint32_t γ2, uint32_t τ, uint32_t β, size_t ω>
+  requires(dilithium_params::check_signing_params(k, l, d, η, γ1, γ2, τ, β, ω))
+struct pool_t
+{
+public:
+  using seckey_t = dilithium::prepared_seckey_t<k, l>;
+  using commitment_t = dilithium::commitment_t<k, l, γ2>;
+  using workspace_t = dilithium::workspace_t<k, l, γ2>;
+
+  // Creates a pool of at max `capacity` -many commitments, under given prepared
+  // secret key, which is kept filled by `thread_cnt` -many background threads.
+  inline pool_t(std::shared_ptr<const seckey_t> seckey, const size_t capacity, const size_t thread_cnt = 1)
+    : key(std::move(seckey))
+    , cap(capacity)
+  {
+    workers.reserve(thread_cnt);
+    for (size_t i = 0; i < thread_cnt; i++) {
+      workers.emplace_back([this]() { fill_loop(); });
+    }
+  }
+
+  pool_t(const pool_t&) = delete;
+  pool_t& operator=(const pool_t&) = delete;
+
+  inline ~pool_t()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      stopping = true;
+    }
+    space_cv.notify_all();
+
+    for (auto& w : workers) {
+      w.join();
+    }
+
+    for (auto& cm : ready) {
+      cm->wipe();
+    }
+  }
+
+  // Returns number of commitments, which are ready to be consumed.
+  inline size_t size() const
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    return ready.size();
+  }
+
+  // Returns maximum number of commitments, this pool holds.
+  inline size_t capacity() const { return cap; }
+
+  // Blocks until the pool is filled up to its capacity or at least `cnt` -many
+  // commitments are ready, whichever happens first. Requires at least one
+  // background thread.
+  inline void wait_ready(const size_t cnt)
+  {
+    std::unique_lock<std::mutex> lock(mtx);
+    ready_cv.wait(lock, [&]() { return ready.size() >= std::min(cnt, cap); });
+  }
+
+  // Given a non-empty message, this routine computes its randomized signature,
+  // using precomputed commitments. Safe to be called concurrently.
+  inline void sign_online(std::span<const uint8_t> msg,
+                          std::span<uint8_t, dilithium_utils::sig_len<k, l, γ1, ω>()> sig)
+  {
+    std::array<uint8_t, 64> mu{};
+
+    shake256::shake256_t hasher;
+    hasher.absorb(key->tr);
+    hasher.absorb(msg);
+    hasher.finalize();
+    hasher.squeeze(mu);
+
+    auto ws = std::make_unique<workspace_t>();
+
+    size_t attempts = 0;
+
+    bool accepted = false;
+    while (!accepted) {
+      auto cm = take(*ws);
+
+      accepted = dilithium::respond<k, l, γ1, γ2, τ, β, ω>(key->s1, key->s2, key->t0, mu, *cm, *ws);
+      cm->wipe();
+      attempts++;
+    }
+
+    sign_profile::on_signature<k, l, γ1, γ2, τ, β, ω>(attempts);
+
+    dilithium::encode_signature<k, l, γ1, ω>(ws->c_tilde, ws->z, ws->h, sig);
+    ws->wipe();
+  }
+
+private:
+  std::shared_ptr<const seckey_t> key;
+  const size_t cap;
+
+  mutable std::mutex mtx;
+  std::condition_variable space_cv;
+  std::condition_variable ready_cv;
+  std::deque<std::unique_ptr<commitment_t>> ready;
+  size_t in_flight = 0;
+  bool stopping = false;
+
+  std::vector<std::thread> workers;
+
+  // Computes a fresh commitment, using a random seed ρ', which is wiped
+  // right after.
+  inline std::unique_ptr<commitment_t> make_commitment(csprng::csprng_t& rng, workspace_t& ws) const
+  {
+    auto cm = std::make_unique<commitment_t>();
+
+    std::array<uint8_t, 64> rho_prime{};
+    rng.read(rho_prime);
+
+    dilithium::commit<k, l, γ1, γ2>(key->A, rho_prime, 0, *cm, ws);
+    dilithium_utils::wipe(std::span(rho_prime));
+
+    return cm;
+  }
+
+  // Takes one commitment out of the pool, computing it on calling thread, using
+  // given workspace, if the pool is empty.
+  inline std::unique_ptr<commitment_t> take(workspace_t& ws)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+
+      if (!ready.empty()) {
+        auto cm = std::move(ready.front());
+        ready.pop_front();
+
+        space_cv.notify_one();
+        return cm;
+      }
+    }
+
+    return make_commitment(csprng::local(), ws);
+  }
+
+  inline void fill_loop()
+  {
+    auto& rng = csprng::local();
+    auto ws = std::make_unique<workspace_t>();
+
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mtx);
+        space_cv.wait(lock, [this]() { return stopping || (ready.size() + in_flight < cap); });
+
+        if (stopping) {
+          break;
+        }
+
+        in_flight++;
+      }
+
+      auto cm = make_commitment(rng, *ws);
+
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+
+        in_flight--;
+        ready.push_back(std::move(cm));
+      }
+      ready_cv.notify_all();
+    }
+
+    ws->wipe();
+  }
+};
+
+}
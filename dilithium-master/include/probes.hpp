@@ -0,0 +1,55 @@
+#pragma once
+
+// Opt-in USDT ( user-level statically defined tracing ) probes, marking stage
+// boundaries of keygen, signing and verification, so that per-stage latency can
+// be observed, in production binaries, using `perf` or `bpftrace`, even though
+// every stage is inlined into its caller and doesn't show up in flame graphs.
+//
+// Enabled by compiling with `-DDILITHIUM_USDT`, which needs `<sys/sdt.h>` ( from
+// systemtap-sdt-dev on Debian/ Ubuntu or systemtap-sdt-devel on Fedora ). Each
+// probe compiles to a single `nop`, plus an ELF note describing where its
+// arguments live, costing next to nothing until a tracer attaches to it.
+// Otherwise probes compile to nothing.
+//
+// All probes belong to provider `dilithium` and take matrix dimension k, l as
+// their first two arguments, telling parameter sets apart. Probes are
+//
+// - keygen_start, keygen_done
+// - expand_a_start, expand_a_done                 ( keygen, preparing keys )
+// - secret_decode_start, secret_decode_done       ( decoding s1, s2, t0 and their NTTs )
+// - key_pack_start, key_pack_done                 ( keygen )
+// - sign_start, sign_done
+// - attempt_start(κ), attempt_reject(check), attempt_accept(attempts) ( see `sign_profile::reject_t` )
+// - challenge_start, challenge_done               ( signing and verification )
+// - hint_start, hint_done
+// - sig_pack_start, sig_pack_done
+// - verify_start, verify_done(accepted)
+//
+// For example, signing attempt latency histogram can be collected using
+//
+//   bpftrace -e 'usdt:./a.out:dilithium:attempt_start { @s[tid] = nsecs; }
+//                usdt:./a.out:dilithium:attempt_reject,
+//                usdt:./a.out:dilithium:attempt_accept /@s[tid]/ { @ns = hist(nsecs - @s[tid]); delete(@s[tid]); }'
+#if defined(DILITHIUM_USDT)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#else
+#error "DILITHIUM_USDT needs <sys/sdt.h>, install systemtap-sdt-dev ( or systemtap-sdt-devel )"
+#endif
+
+#define DILITHIUM_PROBE(name, k, l) DTRACE_PROBE2(dilithium, name, k, l)
+#define DILITHIUM_PROBE_ARG(name, k, l, arg) DTRACE_PROBE3(dilithium, name, k, l, arg)
+#else
+#define DILITHIUM_PROBE(name, k, l) static_cast<void>(0)
+#define DILITHIUM_PROBE_ARG(name, k, l, arg) static_cast<void>(0)
+#endif
+
+namespace probes {
+
+#if defined(DILITHIUM_USDT)
+constexpr bool ENABLED = true;
+#else
+constexpr bool ENABLED = false;
+#endif
+
+}
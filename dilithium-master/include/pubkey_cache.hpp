@@ -0,0 +1,298 @@
+#pragma once
+#include "dilithium.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Concurrent, memory bounded cache of prepared Dilithium public keys
+namespace pubkey_cache {
+
+// Snapshot of cache counters, see `cache_t::stats`.
+struct stats_t
+{
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t evictions = 0;
+};
+
+// Thread-safe cache of prepared Dilithium public keys ( see
+// `dilithium::prepared_pubkey_t` ), keyed by 32 -bytes hash of serialized
+// public key i.e. tr, which anyway needs to be computed during verification.
+//
+// Cached entries are spread over a fixed number of shards, each guarded by its
+// own lock, so that concurrent lookups of different public keys rarely contend.
+// Total memory occupied by cached entries is bounded by a configurable budget.
+//
+// Eviction is frequency-aware ( following the idea of TinyLFU, see
+// https://arxiv.org/abs/1512.00727 ). Each shard keeps an approximate access
+// frequency of recently seen public keys in a count-min sketch, which is
+// periodically aged by halving all counters. When a shard is full, a newly seen
+// public key is only admitted if it has been requested more often than the
+// least frequently used one among a small random sample of cached entries,
+// which is then evicted. This keeps hot keys of a skewed ( say Zipfian ) key
+// distribution resident, while one-off public keys don't flush them out, and
+// keeps the work done under shard lock, on a miss, independent of shard size.
+template<size_t k, size_t l, size_t d>
+struct cache_t
+{
+public:
+  using prepared_t = dilithium::prepared_pubkey_t<k, l, d>;
+  using entry_t = std::shared_ptr<const prepared_t>;
+
+  // Approximate number of bytes accounted for each cached public key.
+  static constexpr size_t ENTRY_SIZE = sizeof(prepared_t) + 128;
+
+  // Creates a cache, which keeps at most `mem_budget` -bytes worth of prepared
+  // public keys, spread across `num_shards` (>0) -many shards. At least one
+  // entry per shard is always allowed.
+  inline explicit cache_t(const size_t mem_budget, const size_t num_shards = 16)
+    : shard_cnt(std::max<size_t>(num_shards, 1))
+    , shards(std::make_unique<shard_t[]>(this->shard_cnt))
+  {
+    const size_t capacity = mem_budget / ENTRY_SIZE;
+    this->shard_capacity = std::max<size_t>((capacity + this->shard_cnt - 1) / this->shard_cnt, 1);
+  }
+
+  cache_t(const cache_t&) = delete;
+  cache_t& operator=(const cache_t&) = delete;
+
+  // Given a serialized Dilithium public key, returns its prepared form, either
+  // from cache ( on hit ) or by preparing it ( on miss ), in which case the
+  // prepared public key may be admitted into cache.
+  //
+  // Returned prepared public key stays valid for as long as it's held by the
+  // caller, even if it gets evicted from cache meanwhile.
+  inline entry_t get(std::span<const uint8_t, dilithium_utils::pub_key_len<k, d>()> pubkey)
+  {
+    key_t key{};
+
+    shake256::shake256_t hasher;
+    hasher.absorb(pubkey);
+    hasher.finalize();
+    hasher.squeeze(key);
+
+    shard_t& shard = shards[shard_index(key)];
+
+    {
+      std::lock_guard<std::mutex> lock(shard.mtx);
+
+      shard.touch(key);
+      auto it = shard.entries.find(key);
+      if (it != shard.entries.end()) {
+        hits.fetch_add(1, std::memory_order_relaxed);
+        metrics::on_cache<k, l>(metrics::cache_t::pubkey, metrics::cache_event_t::hit);
+        return it->second;
+      }
+    }
+
+    misses.fetch_add(1, std::memory_order_relaxed);
+    metrics::on_cache<k, l>(metrics::cache_t::pubkey, metrics::cache_event_t::miss);
+
+    // Prepare public key outside of the lock, it's the expensive part. Cache
+    // key is H(pk) i.e. tr, so it's not computed again.
+    auto prepared = std::make_shared<prepared_t>();
+    dilithium::prepare_pubkey<k, l, d>(pubkey, key, *prepared);
+
+    std::lock_guard<std::mutex> lock(shard.mtx);
+
+    auto it = shard.entries.find(key);
+    if (it != shard.entries.end()) {
+      // Some other thread has admitted it, meanwhile.
+      return it->second;
+    }
+
+    if (shard.entries.size() < shard_capacity) {
+      shard.insert(key, prepared);
+      return prepared;
+    }
+
+    const size_t victim = shard.sample_victim();
+
+    if (shard.estimate(key) > shard.estimate(shard.keys[victim])) {
+      shard.erase_at(victim);
+      shard.insert(key, prepared);
+      evictions.fetch_add(1, std::memory_order_relaxed);
+      metrics::on_cache<k, l>(metrics::cache_t::pubkey, metrics::cache_event_t::eviction);
+    }
+
+    return prepared;
+  }
+
+  // Returns number of prepared public keys, currently held in cache.
+  inline size_t size() const
+  {
+    size_t cnt = 0;
+    for (size_t i = 0; i < shard_cnt; i++) {
+      std::lock_guard<std::mutex> lock(shards[i].mtx);
+      cnt += shards[i].entries.size();
+    }
+
+    return cnt;
+  }
+
+  // Returns maximum number of prepared public keys, which can be held in cache.
+  inline size_t capacity() const { return shard_capacity * shard_cnt; }
+
+  // Returns a snapshot of hit, miss and eviction counters.
+  inline stats_t stats() const
+  {
+    return stats_t{
+      hits.load(std::memory_order_relaxed),
+      misses.load(std::memory_order_relaxed),
+      evictions.load(std::memory_order_relaxed),
+    };
+  }
+
+  // Drops all cached public keys, while keeping counters as they are.
+  inline void clear()
+  {
+    for (size_t i = 0; i < shard_cnt; i++) {
+      std::lock_guard<std::mutex> lock(shards[i].mtx);
+      shards[i].entries.clear();
+      shards[i].keys.clear();
+    }
+  }
+
+private:
+  using key_t = std::array<uint8_t, 32>;
+
+  // Cache key is output of SHAKE256 Xof, so any 8 -bytes of it are as good a
+  // hash as any other.
+  struct key_hash_t
+  {
+    inline size_t operator()(const key_t& key) const
+    {
+      uint64_t v = 0;
+      std::memcpy(&v, key.data() + 8, sizeof(v));
+      return static_cast<size_t>(v);
+    }
+  };
+
+  struct shard_t
+  {
+    // Number of counters in each row of count-min sketch, must be power of 2.
+    static constexpr size_t SKETCH_WIDTH = 1ul << 10;
+    static constexpr size_t SKETCH_DEPTH = 4;
+    static constexpr uint8_t SKETCH_MAX = 15;
+    // After these many increments, all counters of the sketch are halved.
+    static constexpr size_t SKETCH_SAMPLE = 10 * SKETCH_WIDTH;
+    // Number of cached entries, eviction victim is chosen among.
+    static constexpr size_t EVICTION_SAMPLE = 8;
+
+    mutable std::mutex mtx;
+    std::unordered_map<key_t, entry_t, key_hash_t> entries;
+    // Keys of cached entries, densely packed, so that they can be sampled.
+    std::vector<key_t> keys;
+    std::array<uint8_t, SKETCH_DEPTH * SKETCH_WIDTH> sketch{};
+    size_t increments = 0;
+    // State of xorshift64 generator, used for sampling eviction victims. It
+    // needs no unpredictability, only spread.
+    uint64_t rng_state = 0x9e3779b97f4a7c15ul;
+
+    inline void insert(const key_t& key, const entry_t& entry)
+    {
+      entries.emplace(key, entry);
+      keys.push_back(key);
+    }
+
+    // Drops cached entry at given position of `keys`, moving last key into it.
+    inline void erase_at(const size_t pos)
+    {
+      entries.erase(keys[pos]);
+
+      keys[pos] = keys.back();
+      keys.pop_back();
+    }
+
+    // Returns next output of xorshift64 generator.
+    inline uint64_t next_random()
+    {
+      rng_state ^= rng_state << 13;
+      rng_state ^= rng_state >> 7;
+      rng_state ^= rng_state << 17;
+
+      return rng_state;
+    }
+
+    // Returns position ( in `keys` ) of least frequently used entry, among
+    // `EVICTION_SAMPLE` -many randomly chosen ones, or among all of them, if
+    // shard holds no more than that many. Shard must not be empty.
+    inline size_t sample_victim()
+    {
+      const size_t n = keys.size();
+      const size_t cnt = std::min(n, EVICTION_SAMPLE);
+
+      size_t victim = 0;
+      uint32_t victim_freq = std::numeric_limits<uint32_t>::max();
+
+      for (size_t i = 0; i < cnt; i++) {
+        const size_t pos = n <= EVICTION_SAMPLE ? i : static_cast<size_t>(next_random() % n);
+
+        const uint32_t freq = estimate(keys[pos]);
+        if (freq < victim_freq) {
+          victim = pos;
+          victim_freq = freq;
+        }
+      }
+
+      return victim;
+    }
+
+    inline size_t sketch_index(const key_t& key, const size_t row) const
+    {
+      uint16_t v = 0;
+      std::memcpy(&v, key.data() + 16 + row * sizeof(v), sizeof(v));
+      return row * SKETCH_WIDTH + (v & (SKETCH_WIDTH - 1));
+    }
+
+    // Records one access of given key, in count-min sketch.
+    inline void touch(const key_t& key)
+    {
+      for (size_t r = 0; r < SKETCH_DEPTH; r++) {
+        uint8_t& ctr = sketch[sketch_index(key, r)];
+        ctr += ctr < SKETCH_MAX;
+      }
+
+      increments++;
+      if (increments == SKETCH_SAMPLE) {
+        for (auto& ctr : sketch) {
+          ctr >>= 1;
+        }
+        increments = 0;
+      }
+    }
+
+    // Estimates access frequency of given key, from count-min sketch.
+    inline uint32_t estimate(const key_t& key) const
+    {
+      uint8_t freq = SKETCH_MAX;
+      for (size_t r = 0; r < SKETCH_DEPTH; r++) {
+        freq = std::min(freq, sketch[sketch_index(key, r)]);
+      }
+
+      return freq;
+    }
+  };
+
+  inline size_t shard_index(const key_t& key) const
+  {
+    uint64_t v = 0;
+    std::memcpy(&v, key.data(), sizeof(v));
+    return static_cast<size_t>(v % shard_cnt);
+  }
+
+  const size_t shard_cnt;
+  size_t shard_capacity = 1;
+  std::unique_ptr<shard_t[]> shards;
+
+  std::atomic<uint64_t> hits{ 0 };
+  std::atomic<uint64_t> misses{ 0 };
+  std::atomic<uint64_t> evictions{ 0 };
+};
+
+}
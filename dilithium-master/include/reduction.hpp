@@ -144,4 +144,34 @@ use_hint(const field::zq_t h, const field::zq_t r)
   }
 }
 
+// Variable-time counterpart of `use_hint` ( defined above ), producing exactly
+// same result, while taking data-dependent branches, so that most coefficients
+// ( i.e. those with hint bit unset ) return right after computing high order
+// bits. Only ever use it on public data, say during signature verification.
+template<uint32_t alpha>
+static inline constexpr field::zq_t
+use_hint_vartime(const field::zq_t h, const field::zq_t r)
+{
+  constexpr uint32_t m = (field::Q - 1) / alpha;
+  constexpr uint32_t t0 = alpha >> 1;
+
+  const uint32_t r1 = (r.raw() + t0 - 1u) / alpha;
+  const int32_t r0 = static_cast<int32_t>(r.raw()) - static_cast<int32_t>(r1 * alpha);
+
+  if (r1 == m) {
+    // r1 * α = q - 1, so r0 is decremented to -1 and then r0 <= 0
+    return (h == field::zq_t::one()) ? field::zq_t{ m - 1u } : field::zq_t::zero();
+  }
+
+  if ((h != field::zq_t::one()) || (r0 == 0)) {
+    return field::zq_t{ r1 };
+  }
+
+  if (r0 > 0) {
+    return field::zq_t{ (r1 == m - 1u) ? 0u : r1 + 1u };
+  }
+
+  return field::zq_t{ (r1 == 0u) ? m - 1u : r1 - 1u };
+}
+
 }
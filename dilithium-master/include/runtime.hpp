@@ -0,0 +1,374 @@
+#pragma once
+#include "dilithium2.hpp"
+#include "dilithium3.hpp"
+#include "dilithium5.hpp"
+#include <memory>
+#include <stdexcept>
+
+// Dilithium parameter set, chosen at runtime ( say negotiated per request ),
+// behind type-erased signer and verifier objects, which dispatch on parameter
+// set once, when they are constructed, instead of on every call
+namespace dilithium {
+
+// NIST security level of Dilithium parameter set, see table 2 of the
+// specification.
+enum class level_t : uint8_t
+{
+  dilithium2 = 2,
+  dilithium3 = 3,
+  dilithium5 = 5,
+};
+
+// Parameters of Dilithium instantiation, at given security level, as compile-time
+// constants, see `dilithium{2,3,5}.hpp`.
+template<level_t lv>
+struct params_t;
+
+template<>
+struct params_t<level_t::dilithium2>
+{
+  static constexpr size_t k = dilithium2::k, l = dilithium2::l, d = dilithium2::d, ω = dilithium2::ω;
+  static constexpr uint32_t η = dilithium2::η, γ1 = dilithium2::γ1, γ2 = dilithium2::γ2, τ = dilithium2::τ, β = dilithium2::β;
+};
+
+template<>
+struct params_t<level_t::dilithium3>
+{
+  static constexpr size_t k = dilithium3::k, l = dilithium3::l, d = dilithium3::d, ω = dilithium3::ω;
+  static constexpr uint32_t η = dilithium3::η, γ1 = dilithium3::γ1, γ2 = dilithium3::γ2, τ = dilithium3::τ, β = dilithium3::β;
+};
+
+template<>
+struct params_t<level_t::dilithium5>
+{
+  static constexpr size_t k = dilithium5::k, l = dilithium5::l, d = dilithium5::d, ω = dilithium5::ω;
+  static constexpr uint32_t η = dilithium5::η, γ1 = dilithium5::γ1, γ2 = dilithium5::γ2, τ = dilithium5::τ, β = dilithium5::β;
+};
+
+// Invokes `fn(params_t<lv>{})` for given runtime security level, returning
+// whatever it returns. Throws on unknown level.
+template<typename F>
+static inline decltype(auto)
+dispatch(const level_t lv, F&& fn)
+{
+  switch (lv) {
+    case level_t::dilithium2:
+      return fn(params_t<level_t::dilithium2>{});
+    case level_t::dilithium3:
+      return fn(params_t<level_t::dilithium3>{});
+    case level_t::dilithium5:
+      return fn(params_t<level_t::dilithium5>{});
+  }
+
+  throw std::invalid_argument("dilithium: unknown security level");
+}
+
+// Byte length of public key, at given security level.
+static inline size_t
+pub_key_len(const level_t lv)
+{
+  return dispatch(lv, []<typename P>(P) { return dilithium_utils::pub_key_len<P::k, P::d>(); });
+}
+
+// Byte length of secret key, at given security level.
+static inline size_t
+sec_key_len(const level_t lv)
+{
+  return dispatch(lv, []<typename P>(P) { return dilithium_utils::sec_key_len<P::k, P::l, P::η, P::d>(); });
+}
+
+// Byte length of signature, at given security level.
+static inline size_t
+sig_len(const level_t lv)
+{
+  return dispatch(lv, []<typename P>(P) { return dilithium_utils::sig_len<P::k, P::l, P::γ1, P::ω>(); });
+}
+
+// Given a security level and a 32 -bytes seed, this routine generates a fresh
+// key pair of that level, see `dilithium{2,3,5}::keygen`. Public and secret key
+// buffers must be `pub_key_len(lv)` and `sec_key_len(lv)` -bytes, otherwise it
+// throws.
+static inline void
+keygen(const level_t lv, std::span<const uint8_t, 32> seed, std::span<uint8_t> pubkey, std::span<uint8_t> seckey)
+{
+  dispatch(lv, [&]<typename P>(P) {
+    constexpr size_t pklen = dilithium_utils::pub_key_len<P::k, P::d>();
+    constexpr size_t sklen = dilithium_utils::sec_key_len<P::k, P::l, P::η, P::d>();
+
+    if ((pubkey.size() != pklen) || (seckey.size() != sklen)) {
+      throw std::invalid_argument("dilithium: public or secret key length doesn't match security level");
+    }
+
+    keygen<P::k, P::l, P::d, P::η>(seed, pubkey.template first<pklen>(), seckey.template first<sklen>());
+  });
+}
+
+// Dilithium signer of runtime chosen security level, holding secret key in its
+// prepared form ( see `prepare_seckey` ). Security level is dispatched on once,
+// when the signer is constructed, after which every call is a single indirect
+// call into signing routines of that level.
+//
+// A signer is immutable once constructed, so it can be shared by many threads,
+// each signing call uses a workspace of its own.
+struct signer_t
+{
+public:
+  // Prepares given secret key, of given security level, for signing. Throws if
+  // length of secret key doesn't match the level.
+  inline signer_t(const level_t lv, std::span<const uint8_t> seckey)
+    : lvl(lv)
+  {
+    impl = dispatch(lv, [&]<typename P>(P) -> std::unique_ptr<const iface_t> {
+      constexpr size_t sklen = dilithium_utils::sec_key_len<P::k, P::l, P::η, P::d>();
+      if (seckey.size() != sklen) {
+        throw std::invalid_argument("dilithium: secret key length doesn't match security level");
+      }
+
+      return std::make_unique<const impl_t<P>>(seckey.template first<sklen>());
+    });
+  }
+
+  // Security level of the signer.
+  inline level_t level() const { return lvl; }
+
+  // Byte length of signatures, produced by the signer.
+  inline size_t sig_len() const { return impl->sig_len(); }
+
+  // Given a non-empty message, this routine signs it, computing the signature
+  // either deterministically ( default ) or randomized, using 64 -bytes seed,
+  // see `dilithium{2,3,5}::sign`. Signature buffer must be `sig_len()` -bytes,
+  // otherwise it throws.
+  template<const bool random = false>
+  inline void sign(std::span<const uint8_t> msg, std::span<uint8_t> sig, std::span<const uint8_t, 64 * random> seed) const
+  {
+    impl->sign(msg, sig, seed);
+  }
+
+  // Given n non-empty messages, this routine signs all of them, writing i -th
+  // signature to sigs[i * sig_len(), (i + 1) * sig_len()), spreading the work
+  // across worker threads of given pool. For randomized signing, n 64 -bytes
+  // seeds must be provided ( concatenated ). See `dilithium{2,3,5}::sign_batch`.
+  // Throws if lengths of signatures or seeds don't match number of messages.
+  template<const bool random = false>
+  inline void sign_batch(std::span<const std::span<const uint8_t>> msgs,
+                         std::span<uint8_t> sigs,
+                         std::span<const uint8_t> seeds = {},
+                         thread_pool::pool_t& pool = thread_pool::default_pool()) const
+  {
+    if ((sigs.size() != msgs.size() * sig_len()) || (seeds.size() != msgs.size() * 64 * random)) {
+      throw std::invalid_argument("dilithium: signatures or seeds don't match number of messages");
+    }
+    impl->sign_batch(msgs, sigs, seeds, pool);
+  }
+
+private:
+  struct iface_t
+  {
+    virtual ~iface_t() = default;
+    virtual size_t sig_len() const = 0;
+    virtual void sign(std::span<const uint8_t> msg, std::span<uint8_t> sig, std::span<const uint8_t> seed) const = 0;
+    virtual void sign_batch(std::span<const std::span<const uint8_t>> msgs,
+                            std::span<uint8_t> sigs,
+                            std::span<const uint8_t> seeds,
+                            thread_pool::pool_t& pool) const = 0;
+  };
+
+  // Signer of one security level. Its members are defined out of class ( and
+  // not inline ), so that they can be instantiated once, in the library, see
+  // `DILITHIUM_EXTERN_TEMPLATES` ( below ).
+  template<typename P>
+  struct impl_t final : iface_t
+  {
+    static constexpr size_t siglen = dilithium_utils::sig_len<P::k, P::l, P::γ1, P::ω>();
+
+    prepared_seckey_t<P::k, P::l> key;
+
+    explicit impl_t(std::span<const uint8_t, dilithium_utils::sec_key_len<P::k, P::l, P::η, P::d>()> seckey);
+    ~impl_t() override;
+
+    size_t sig_len() const override;
+    void sign(std::span<const uint8_t> msg, std::span<uint8_t> sig, std::span<const uint8_t> seed) const override;
+    void sign_batch(std::span<const std::span<const uint8_t>> msgs,
+                    std::span<uint8_t> sigs,
+                    std::span<const uint8_t> seeds,
+                    thread_pool::pool_t& pool) const override;
+  };
+
+  level_t lvl;
+  std::unique_ptr<const iface_t> impl;
+};
+
+// Dilithium verifier of runtime chosen security level, holding public key in its
+// prepared form ( see `prepare_pubkey` ). Same as `signer_t`, security level is
+// dispatched on once, when the verifier is constructed, and it can be shared by
+// many threads.
+struct verifier_t
+{
+public:
+  // Prepares given public key, of given security level, for verification.
+  // Throws if length of public key doesn't match the level.
+  inline verifier_t(const level_t lv, std::span<const uint8_t> pubkey)
+    : lvl(lv)
+  {
+    impl = dispatch(lv, [&]<typename P>(P) -> std::unique_ptr<const iface_t> {
+      constexpr size_t pklen = dilithium_utils::pub_key_len<P::k, P::d>();
+      if (pubkey.size() != pklen) {
+        throw std::invalid_argument("dilithium: public key length doesn't match security level");
+      }
+
+      return std::make_unique<const impl_t<P>>(pubkey.template first<pklen>());
+    });
+  }
+
+  // Security level of the verifier.
+  inline level_t level() const { return lvl; }
+
+  // Byte length of signatures, accepted by the verifier.
+  inline size_t sig_len() const { return impl->sig_len(); }
+
+  // Given a message and a signature, this routine verifies the signature,
+  // returning truth value only when it's valid. Signature of any other length
+  // than `sig_len()` is rejected.
+  inline bool verify(std::span<const uint8_t> msg, std::span<const uint8_t> sig) const
+  {
+    return impl->verify(msg, sig);
+  }
+
+  // Given n messages and n signatures ( concatenated, each `sig_len()` -bytes ),
+  // this routine verifies all of them, writing 1 to results[i] only when i -th
+  // signature is valid, otherwise writing 0, spreading the work across worker
+  // threads of given pool. Throws if lengths of signatures or results don't
+  // match number of messages.
+  inline void verify_batch(std::span<const std::span<const uint8_t>> msgs,
+                           std::span<const uint8_t> sigs,
+                           std::span<uint8_t> results,
+                           thread_pool::pool_t& pool = thread_pool::default_pool()) const
+  {
+    const size_t siglen = sig_len();
+
+    if ((sigs.size() != msgs.size() * siglen) || (results.size() != msgs.size())) {
+      throw std::invalid_argument("dilithium: signatures or results don't match number of messages");
+    }
+
+    pool.parallel_for(msgs.size(), [&](const size_t i) {
+      results[i] = static_cast<uint8_t>(impl->verify(msgs[i], sigs.subspan(i * siglen, siglen)));
+    });
+  }
+
+private:
+  struct iface_t
+  {
+    virtual ~iface_t() = default;
+    virtual size_t sig_len() const = 0;
+    virtual bool verify(std::span<const uint8_t> msg, std::span<const uint8_t> sig) const = 0;
+  };
+
+  // Verifier of one security level, see `signer_t::impl_t`.
+  template<typename P>
+  struct impl_t final : iface_t
+  {
+    static constexpr size_t siglen = dilithium_utils::sig_len<P::k, P::l, P::γ1, P::ω>();
+
+    prepared_pubkey_t<P::k, P::l, P::d> key;
+
+    explicit impl_t(std::span<const uint8_t, dilithium_utils::pub_key_len<P::k, P::d>()> pubkey);
+
+    size_t sig_len() const override;
+    bool verify(std::span<const uint8_t> msg, std::span<const uint8_t> sig) const override;
+  };
+
+  level_t lvl;
+  std::unique_ptr<const iface_t> impl;
+};
+
+
+template<typename P>
+signer_t::impl_t<P>::impl_t(std::span<const uint8_t, dilithium_utils::sec_key_len<P::k, P::l, P::η, P::d>()> seckey)
+{
+  prepare_seckey<P::k, P::l, P::d, P::η>(seckey, key);
+}
+
+template<typename P>
+signer_t::impl_t<P>::~impl_t()
+{
+  key.wipe();
+}
+
+template<typename P>
+size_t
+signer_t::impl_t<P>::sig_len() const
+{
+  return siglen;
+}
+
+template<typename P>
+void
+signer_t::impl_t<P>::sign(std::span<const uint8_t> msg, std::span<uint8_t> sig, std::span<const uint8_t> seed) const
+{
+  if (sig.size() != siglen) {
+    throw std::invalid_argument("dilithium: signature length doesn't match security level");
+  }
+  auto _sig = sig.template first<siglen>();
+
+  if (seed.empty()) {
+    dilithium::sign<P::k, P::l, P::d, P::η, P::γ1, P::γ2, P::τ, P::β, P::ω, false>(key, msg, _sig, {});
+  } else {
+    if (seed.size() != 64) {
+      throw std::invalid_argument("dilithium: signing seed must be 64 -bytes");
+    }
+    dilithium::sign<P::k, P::l, P::d, P::η, P::γ1, P::γ2, P::τ, P::β, P::ω, true>(key, msg, _sig, seed.template first<64>());
+  }
+}
+
+template<typename P>
+void
+signer_t::impl_t<P>::sign_batch(std::span<const std::span<const uint8_t>> msgs,
+                                std::span<uint8_t> sigs,
+                                std::span<const uint8_t> seeds,
+                                thread_pool::pool_t& pool) const
+{
+  if (seeds.empty()) {
+    dilithium_batch::sign_batch<P::k, P::l, P::d, P::η, P::γ1, P::γ2, P::τ, P::β, P::ω, false>(key, msgs, sigs, seeds, pool);
+  } else {
+    dilithium_batch::sign_batch<P::k, P::l, P::d, P::η, P::γ1, P::γ2, P::τ, P::β, P::ω, true>(key, msgs, sigs, seeds, pool);
+  }
+}
+
+template<typename P>
+verifier_t::impl_t<P>::impl_t(std::span<const uint8_t, dilithium_utils::pub_key_len<P::k, P::d>()> pubkey)
+{
+  prepare_pubkey<P::k, P::l, P::d>(pubkey, key);
+}
+
+template<typename P>
+size_t
+verifier_t::impl_t<P>::sig_len() const
+{
+  return siglen;
+}
+
+template<typename P>
+bool
+verifier_t::impl_t<P>::verify(std::span<const uint8_t> msg, std::span<const uint8_t> sig) const
+{
+  if (sig.size() != siglen) {
+    return false;
+  }
+
+  return dilithium::verify<P::k, P::l, P::d, P::γ1, P::γ2, P::τ, P::β, P::ω>(key, msg, sig.template first<siglen>());
+}
+
+// When linking against precompiled `libdilithium.{a,so}` ( see `make lib` ),
+// define `DILITHIUM_EXTERN_TEMPLATES`, so that signers and verifiers of all
+// three security levels are not instantiated in every translation unit, which
+// includes this header, rather they are taken from the library.
+#if defined(DILITHIUM_EXTERN_TEMPLATES)
+extern template struct signer_t::impl_t<params_t<level_t::dilithium2>>;
+extern template struct signer_t::impl_t<params_t<level_t::dilithium3>>;
+extern template struct signer_t::impl_t<params_t<level_t::dilithium5>>;
+extern template struct verifier_t::impl_t<params_t<level_t::dilithium2>>;
+extern template struct verifier_t::impl_t<params_t<level_t::dilithium3>>;
+extern template struct verifier_t::impl_t<params_t<level_t::dilithium5>>;
+#endif
+
+}
@@ -1,20 +1,78 @@
 #pragma once
 #include "bit_packing.hpp"
+#include "compact.hpp"
+#include "exec.hpp"
 #include "field.hpp"
+#include "keccak_xn.hpp"
 #include "ntt.hpp"
 #include "params.hpp"
 #include "poly.hpp"
 #include "shake128.hpp"
 #include "shake256.hpp"
 #include <array>
+#include <cassert>
 #include <cstdint>
 #include <cstring>
+#include <type_traits>
 
 // Sampling polynomials/ vector of polynomials related routines
 namespace sampling {
 
 using poly_t = std::span<field::zq_t, ntt::N>;
 
+// Given a byte array, squeezed out of SHAKE128 Xof, this routine interprets each
+// consecutive 3 -bytes as a 23 -bit integer, accepting it as next coefficient
+// of polynomial ( starting at index n ), only when it's < q. Returns index of
+// next coefficient to be sampled, which is N once polynomial is fully sampled.
+//
+// This is the rejection sampling step of `expand_a`.
+static inline constexpr size_t
+rej_uniform(std::span<const uint8_t> buf, std::span<field::zq_t, ntt::N> poly, size_t n)
+{
+  for (size_t boff = 0; (boff + 3 <= buf.size()) && (n < ntt::N); boff += 3) {
+    const uint32_t t0 = static_cast<uint32_t>(buf[boff + 2] & 0b01111111);
+    const uint32_t t1 = static_cast<uint32_t>(buf[boff + 1]);
+    const uint32_t t2 = static_cast<uint32_t>(buf[boff + 0]);
+
+    const uint32_t t3 = (t0 << 16) ^ (t1 << 8) ^ (t2 << 0);
+    if (t3 < field::Q) {
+      poly[n] = field::zq_t(t3);
+      n++;
+    }
+  }
+
+  return n;
+}
+
+// Samples element ( i, j ) of matrix A, from 32 -bytes seed ρ, squeezing SHAKE128
+// Xof, absorbed with ρ || (256 * i + j), until all coefficients are accepted by
+// `rej_uniform`. Shared by all forms of `expand_a` ( below ).
+DILITHIUM_SHARED inline constexpr void
+expand_a_poly(std::span<const uint8_t, 32> rho, const size_t i, const size_t j, poly_t poly)
+{
+  std::array<uint8_t, rho.size() + 2> msg{};
+  auto _msg = std::span(msg);
+
+  const uint16_t nonce = static_cast<uint16_t>(i * 256ul + j);
+
+  std::memcpy(_msg.template subspan<0, rho.size()>().data(), rho.data(), rho.size());
+  msg[32] = static_cast<uint8_t>(nonce >> 0);
+  msg[33] = static_cast<uint8_t>(nonce >> 8);
+
+  shake128::shake128_t hasher;
+  hasher.absorb(_msg);
+  hasher.finalize();
+
+  std::array<uint8_t, shake128::RATE / 8> buf{};
+  auto _buf = std::span(buf);
+
+  size_t n = 0;
+  while (n < ntt::N) {
+    hasher.squeeze(_buf);
+    n = rej_uniform(_buf, poly, n);
+  }
+}
+
 // Given a 32 -bytes uniform seed ρ, a k x l matrix is deterministically sampled ( using the method of rejection
 // sampling ), where each coefficient is a degree-255 polynomial ∈ R_q | q = 2^23 - 2^13 + 1
 //
@@ -22,50 +80,150 @@ using poly_t = std::span<field::zq_t, ntt::N>;
 //
 // See `Expanding the Matrix A` point in section 5.3 of Dilithium specification,
 // https://pq-crystals.org/dilithium/data/dilithium-specification-round3-20210208.pdf
+//
+// Matrix dimension is taken at runtime, see `compact.hpp`, while `expand_a<k, l>`
+// ( below ) forwards to this routine, with or without sequential execution
+// policy.
+DILITHIUM_SHARED inline constexpr void
+expand_a(std::span<const uint8_t, 32> rho, std::span<field::zq_t> mat, const size_t k, const size_t l)
+{
+  assert(mat.size() == k * l * ntt::N);
+
+  for (size_t i = 0; i < k; i++) {
+    for (size_t j = 0; j < l; j++) {
+      expand_a_poly(rho, i, j, poly_t(mat.subspan((i * l + j) * ntt::N, ntt::N)));
+    }
+  }
+}
+
 template<size_t k, size_t l>
 static inline constexpr void
 expand_a(std::span<const uint8_t, 32> rho, std::span<field::zq_t, k * l * ntt::N> mat)
 {
-  std::array<uint8_t, rho.size() + 2> msg{};
-  auto _msg = std::span(msg);
+  expand_a(rho, std::span<field::zq_t>(mat), k, l);
+}
 
-  std::memcpy(_msg.template subspan<0, rho.size()>().data(), rho.data(), rho.size());
+// Samples k x l matrix from 32 -bytes seed ρ, see `expand_a` ( above ), running
+// its k x l independent SHAKE128 streams as per given execution policy ( see
+// `exec.hpp` ).
+template<size_t k, size_t l, typename policy_t>
+static inline void
+expand_a(std::span<const uint8_t, 32> rho, std::span<field::zq_t, k * l * ntt::N> mat, const policy_t& policy)
+{
+  if constexpr (std::is_same_v<policy_t, exec::sequential_t>) {
+    expand_a(rho, std::span<field::zq_t>(mat), k, l);
+  } else {
+    policy.for_each(k * l, [&](const size_t idx) {
+      expand_a_poly(rho, idx / l, idx % l, poly_t(mat.subspan(idx * ntt::N, ntt::N)));
+    });
+  }
+}
+
+// Lane-sliced `expand_a` ( see above ), sampling L independent k x l matrices at
+// once, j -th of them from seed rhos[32 * j, 32 * (j + 1)), running L SHAKE128
+// instances in lockstep on a multi-lane Keccak permutation, until each lane has
+// sampled all of its coefficients. Matrices are written lane-sliced i.e. j -th
+// coefficient of a polynomial of i -th lane lives at index j * L + i, see
+// `lanes.hpp`.
+template<size_t k, size_t l, size_t L>
+static inline void
+expand_a_xn(std::span<const uint8_t, 32 * L> rhos, std::span<field::zq_t, k * l * ntt::N * L> mat)
+{
+  constexpr size_t blen = shake128::RATE / 8;
+
+  std::array<uint8_t, 2> nonce_bytes{};
+  std::array<uint8_t, blen * L> buf{};
+  std::array<field::zq_t, ntt::N * L> polys{};
+  auto _buf = std::span(buf);
 
   for (size_t i = 0; i < k; i++) {
     for (size_t j = 0; j < l; j++) {
-      const size_t off = (i * l + j) * ntt::N;
       const uint16_t nonce = static_cast<uint16_t>(i * 256ul + j);
 
-      msg[32] = static_cast<uint8_t>(nonce >> 0);
-      msg[33] = static_cast<uint8_t>(nonce >> 8);
+      nonce_bytes[0] = static_cast<uint8_t>(nonce >> 0);
+      nonce_bytes[1] = static_cast<uint8_t>(nonce >> 8);
 
-      shake128::shake128_t hasher;
-      hasher.absorb(_msg);
-      hasher.finalize();
+      std::array<std::array<std::span<const uint8_t>, 2>, L> msgs{};
+      for (size_t ln = 0; ln < L; ln++) {
+        msgs[ln] = { rhos.subspan(ln * 32, 32), nonce_bytes };
+      }
+
+      keccak_xn::shake128_xn_t<L> hasher;
+      hasher.absorb_finalize(msgs);
+
+      std::array<size_t, L> n{};
+      bool pending = true;
 
-      std::array<uint8_t, shake128::RATE / 8> buf{};
-      auto _buf = std::span(buf);
+      while (pending) {
+        hasher.squeeze(_buf, blen);
 
-      size_t n = 0;
-      while (n < ntt::N) {
-        hasher.squeeze(_buf);
+        pending = false;
+        for (size_t ln = 0; ln < L; ln++) {
+          auto poly = poly_t(std::span(polys).subspan(ln * ntt::N, ntt::N));
 
-        for (size_t boff = 0; (boff < _buf.size()) && (n < ntt::N); boff += 3) {
-          const uint32_t t0 = static_cast<uint32_t>(_buf[boff + 2] & 0b01111111);
-          const uint32_t t1 = static_cast<uint32_t>(_buf[boff + 1]);
-          const uint32_t t2 = static_cast<uint32_t>(_buf[boff + 0]);
+          n[ln] = rej_uniform(_buf.subspan(ln * blen, blen), poly, n[ln]);
+          pending |= n[ln] < ntt::N;
+        }
+      }
 
-          const uint32_t t3 = (t0 << 16) ^ (t1 << 8) ^ (t2 << 0);
-          if (t3 < field::Q) {
-            mat[off + n] = field::zq_t(t3);
-            n++;
-          }
+      const size_t off = (i * l + j) * ntt::N * L;
+      for (size_t ln = 0; ln < L; ln++) {
+        for (size_t idx = 0; idx < ntt::N; idx++) {
+          mat[off + idx * L + ln] = polys[ln * ntt::N + idx];
         }
       }
     }
   }
 }
 
+// Given a byte array, squeezed out of SHAKE256 Xof, this routine consumes bytes
+// of the array, placing next coefficients ∈ [-η, η] ( starting at index n ) of a
+// polynomial. Returns number of coefficients sampled so far, which is N once
+// polynomial is fully sampled.
+//
+// This is the rejection sampling step of `expand_s`.
+template<uint32_t η>
+static inline constexpr size_t
+eta_step(std::span<const uint8_t> buf, std::span<field::zq_t, ntt::N> poly, size_t n)
+  requires(dilithium_params::check_η(η))
+{
+  constexpr auto eta_ = field::zq_t(η);
+
+  for (size_t boff = 0; (boff < buf.size()) && (n < ntt::N); boff++) {
+    const uint8_t t0 = buf[boff] & 0x0f;
+    const uint8_t t1 = buf[boff] >> 4;
+
+    if constexpr (η == 2u) {
+      const uint32_t t2 = static_cast<uint32_t>(t0 % 5);
+      const bool flg0 = t0 < 15;
+
+      poly[n] = eta_ - field::zq_t(t2);
+      n += flg0 * 1;
+
+      const uint32_t t3 = static_cast<uint32_t>(t1 % 5);
+      const bool flg1 = (t1 < 15) & (n < ntt::N);
+      const field::zq_t br[]{ poly[0], eta_ - field::zq_t(t3) };
+
+      poly[flg1 * n] = br[flg1];
+      n += flg1 * 1;
+    } else {
+      const bool flg0 = t0 < 9;
+
+      poly[n] = eta_ - field::zq_t(static_cast<uint32_t>(t0));
+      n += flg0 * 1;
+
+      const bool flg1 = (t1 < 9) & (n < ntt::N);
+      const auto t2 = eta_ - field::zq_t(static_cast<uint32_t>(t1));
+      const field::zq_t br[]{ poly[0], t2 };
+
+      poly[flg1 * n] = br[flg1];
+      n += flg1 * 1;
+    }
+  }
+
+  return n;
+}
+
 // Uniform rejection sampling k -many degree-255 polynomials s.t. each coefficient of
 // those polynomials ∈ [-η, η].
 //
@@ -78,19 +236,24 @@ expand_a(std::span<const uint8_t, 32> rho, std::span<field::zq_t, k * l * ntt::N
 //
 // See `Sampling the vectors s1 and s2` point in section 5.3 of Dilithium
 // specification https://pq-crystals.org/dilithium/data/dilithium-specification-round3-20210208.pdf
-template<uint32_t η, size_t k, uint16_t nonce>
-static inline constexpr void
-expand_s(std::span<const uint8_t, 64> rho_prime, std::span<field::zq_t, k * ntt::N> vec)
-  requires(dilithium_params::check_η(η) && dilithium_params::check_nonce(nonce))
+//
+// Vector dimension ( and starting nonce ) is taken at runtime, see
+// `compact.hpp`, while `expand_s<η, k, nonce>` ( below ) forwards to this
+// routine.
+template<uint32_t η>
+DILITHIUM_SHARED inline constexpr void
+expand_s(std::span<const uint8_t, 64> rho_prime, const uint16_t nonce, std::span<field::zq_t> vec)
+  requires(dilithium_params::check_η(η))
 {
-  constexpr auto eta_ = field::zq_t(η);
+  assert(dilithium_params::check_nonce(nonce));
+  assert(vec.size() % ntt::N == 0);
 
   std::array<uint8_t, rho_prime.size() + 2> msg{};
   auto _msg = std::span(msg);
 
   std::memcpy(_msg.template subspan<0, rho_prime.size()>().data(), rho_prime.data(), rho_prime.size());
 
-  for (size_t i = 0; i < k; i++) {
+  for (size_t i = 0; i < vec.size() / ntt::N; i++) {
     const size_t off = i * ntt::N;
     const uint16_t nonce_ = nonce + static_cast<uint16_t>(i);
 
@@ -107,42 +270,94 @@ expand_s(std::span<const uint8_t, 64> rho_prime, std::span<field::zq_t, k * ntt:
     size_t n = 0;
     while (n < ntt::N) {
       hasher.squeeze(_buf);
+      n = eta_step<η>(_buf, poly_t(vec.subspan(off, ntt::N)), n);
+    }
+  }
+}
+
+template<uint32_t η, size_t k, uint16_t nonce>
+static inline constexpr void
+expand_s(std::span<const uint8_t, 64> rho_prime, std::span<field::zq_t, k * ntt::N> vec)
+  requires(dilithium_params::check_η(η) && dilithium_params::check_nonce(nonce))
+{
+  expand_s<η>(rho_prime, nonce, std::span<field::zq_t>(vec));
+}
+
+// Lane-sliced `expand_s` ( see above ), sampling L independent secret vectors at
+// once, j -th of them from seed seeds[64 * j, 64 * (j + 1)), into `vecs[j]`
+// ( of k x N coefficients ), running L SHAKE256 instances in lockstep on a
+// multi-lane Keccak permutation, until each lane has sampled all of its
+// coefficients.
+template<uint32_t η, size_t k, uint16_t nonce, size_t L>
+static inline void
+expand_s_xn(std::span<const uint8_t, 64 * L> seeds, const std::array<std::span<field::zq_t>, L>& vecs)
+  requires(dilithium_params::check_η(η) && dilithium_params::check_nonce(nonce))
+{
+  constexpr size_t blen = shake256::RATE / 8;
 
-      for (size_t boff = 0; (boff < _buf.size()) && (n < ntt::N); boff++) {
-        const uint8_t t0 = _buf[boff] & 0x0f;
-        const uint8_t t1 = _buf[boff] >> 4;
+  std::array<uint8_t, 2> nonce_bytes{};
+  std::array<uint8_t, blen * L> buf{};
+  auto _buf = std::span(buf);
 
-        if constexpr (η == 2u) {
-          const uint32_t t2 = static_cast<uint32_t>(t0 % 5);
-          const bool flg0 = t0 < 15;
+  for (size_t i = 0; i < k; i++) {
+    const size_t off = i * ntt::N;
+    const uint16_t nonce_ = nonce + static_cast<uint16_t>(i);
 
-          vec[off + n] = eta_ - field::zq_t(t2);
-          n += flg0 * 1;
+    nonce_bytes[0] = static_cast<uint8_t>(nonce_ >> 0);
+    nonce_bytes[1] = static_cast<uint8_t>(nonce_ >> 8);
 
-          const uint32_t t3 = static_cast<uint32_t>(t1 % 5);
-          const bool flg1 = (t1 < 15) & (n < ntt::N);
-          const field::zq_t br[]{ vec[off], eta_ - field::zq_t(t3) };
+    std::array<std::array<std::span<const uint8_t>, 2>, L> msgs{};
+    for (size_t j = 0; j < L; j++) {
+      msgs[j] = { seeds.subspan(j * 64, 64), nonce_bytes };
+    }
 
-          vec[off + flg1 * n] = br[flg1];
-          n += flg1 * 1;
-        } else {
-          const bool flg0 = t0 < 9;
+    keccak_xn::shake256_xn_t<L> hasher;
+    hasher.absorb_finalize(msgs);
 
-          vec[off + n] = eta_ - field::zq_t(static_cast<uint32_t>(t0));
-          n += flg0 * 1;
+    std::array<size_t, L> n{};
+    bool pending = true;
 
-          const bool flg1 = (t1 < 9) & (n < ntt::N);
-          const auto t2 = eta_ - field::zq_t(static_cast<uint32_t>(t1));
-          const field::zq_t br[]{ vec[off], t2 };
+    while (pending) {
+      hasher.squeeze(_buf, blen);
 
-          vec[off + flg1 * n] = br[flg1];
-          n += flg1 * 1;
-        }
+      pending = false;
+      for (size_t j = 0; j < L; j++) {
+        n[j] = eta_step<η>(_buf.subspan(j * blen, blen), poly_t(vecs[j].subspan(off, ntt::N)), n[j]);
+        pending |= n[j] < ntt::N;
       }
     }
   }
 }
 
+// Samples one polynomial of masking vector, from 64 -bytes seed and 2 -bytes
+// nonce ( already offset by position of polynomial in the vector ), decoding
+// output of SHAKE256 Xof, absorbed with seed || nonce, into coefficients ∈
+// [-(γ1-1), γ1]. Shared by all forms of `expand_mask` ( below ).
+template<uint32_t γ1>
+DILITHIUM_SHARED inline constexpr void
+expand_mask_poly(std::span<const uint8_t, 64> seed, const uint16_t nonce, poly_t poly)
+  requires(dilithium_params::check_γ1(γ1))
+{
+  constexpr size_t gbw = std::bit_width(2 * γ1 - 1u);
+
+  std::array<uint8_t, seed.size() + 2> msg{};
+  std::array<uint8_t, ntt::N * gbw / 8> buf{};
+
+  auto _msg = std::span(msg);
+
+  std::memcpy(_msg.template subspan<0, seed.size()>().data(), seed.data(), seed.size());
+  msg[64] = static_cast<uint8_t>(nonce >> 0);
+  msg[65] = static_cast<uint8_t>(nonce >> 8);
+
+  shake256::shake256_t hasher;
+  hasher.absorb(_msg);
+  hasher.finalize();
+  hasher.squeeze(buf);
+
+  bit_packing::decode<gbw>(buf, poly);
+  poly::sub_from_x<γ1>(poly);
+}
+
 // Given a 64 -bytes seed and 2 -bytes nonce, this routine does uniform sampling
 // from output of Shake256 Xof, computing a l x 1 vector of degree-255
 // polynomials s.t. each coefficient ∈ [-(γ1-1), γ1]
@@ -150,38 +365,136 @@ expand_s(std::span<const uint8_t, 64> rho_prime, std::span<field::zq_t, k * ntt:
 // See `Sampling the vectors y` point in section 5.3 of Dilithium
 // specification
 // https://pq-crystals.org/dilithium/data/dilithium-specification-round3-20210208.pdf
+//
+// Vector dimension is taken at runtime, see `compact.hpp`, while
+// `expand_mask<γ1, l>` ( below ) forwards to this routine, with or without
+// sequential execution policy.
+template<uint32_t γ1>
+DILITHIUM_SHARED inline constexpr void
+expand_mask(std::span<const uint8_t, 64> seed, const uint16_t nonce, std::span<field::zq_t> vec)
+  requires(dilithium_params::check_γ1(γ1))
+{
+  assert(vec.size() % ntt::N == 0);
+
+  const size_t l = vec.size() / ntt::N;
+
+  for (size_t i = 0; i < l; i++) {
+    expand_mask_poly<γ1>(seed, nonce + static_cast<uint16_t>(i), poly_t(vec.subspan(i * ntt::N, ntt::N)));
+  }
+}
+
 template<uint32_t γ1, size_t l>
 static inline constexpr void
 expand_mask(std::span<const uint8_t, 64> seed, const uint16_t nonce, std::span<field::zq_t, l * ntt::N> vec)
   requires(dilithium_params::check_γ1(γ1))
 {
-  constexpr size_t gbw = std::bit_width(2 * γ1 - 1u);
+  expand_mask<γ1>(seed, nonce, std::span<field::zq_t>(vec));
+}
 
-  std::array<uint8_t, seed.size() + 2> msg{};
-  std::array<uint8_t, ntt::N * gbw / 8> buf{};
+// Samples l x 1 masking vector from 64 -bytes seed and 2 -bytes nonce, see
+// `expand_mask` ( above ), running its l independent SHAKE256 streams as per
+// given execution policy ( see `exec.hpp` ).
+template<uint32_t γ1, size_t l, typename policy_t>
+static inline void
+expand_mask(std::span<const uint8_t, 64> seed,
+            const uint16_t nonce,
+            std::span<field::zq_t, l * ntt::N> vec,
+            const policy_t& policy)
+  requires(dilithium_params::check_γ1(γ1))
+{
+  if constexpr (std::is_same_v<policy_t, exec::sequential_t>) {
+    expand_mask<γ1>(seed, nonce, std::span<field::zq_t>(vec));
+  } else {
+    policy.for_each(l, [&](const size_t i) {
+      expand_mask_poly<γ1>(seed, nonce + static_cast<uint16_t>(i), poly_t(vec.subspan(i * ntt::N, ntt::N)));
+    });
+  }
+}
 
-  auto _msg = std::span(msg);
-  auto _buf = std::span(buf);
+// Lane-sliced `expand_mask` ( see above ), sampling L independent masking vectors
+// at once, j -th of them from seed seeds[64 * j, 64 * (j + 1)) and nonce
+// `nonces[j]`, into `vecs[j]` ( of l x N coefficients ), running L SHAKE256
+// instances in lockstep on a multi-lane Keccak permutation.
+template<uint32_t γ1, size_t l, size_t L>
+static inline void
+expand_mask_xn(std::span<const uint8_t, 64 * L> seeds,
+               const std::array<uint16_t, L>& nonces,
+               const std::array<std::span<field::zq_t>, L>& vecs)
+  requires(dilithium_params::check_γ1(γ1))
+{
+  constexpr size_t gbw = std::bit_width(2 * γ1 - 1u);
+  constexpr size_t blen = ntt::N * gbw / 8;
 
-  std::memcpy(_msg.template subspan<0, seed.size()>().data(), seed.data(), seed.size());
+  std::array<std::array<uint8_t, 2>, L> nonce_bytes{};
+  std::array<uint8_t, blen * L> buf{};
+  auto _buf = std::span(buf);
 
   for (size_t i = 0; i < l; i++) {
     const size_t off = i * ntt::N;
-    const uint16_t nonce_ = nonce + static_cast<uint16_t>(i);
 
-    msg[64] = static_cast<uint8_t>(nonce_ >> 0);
-    msg[65] = static_cast<uint8_t>(nonce_ >> 8);
+    std::array<std::array<std::span<const uint8_t>, 2>, L> msgs{};
+    for (size_t j = 0; j < L; j++) {
+      const uint16_t nonce_ = nonces[j] + static_cast<uint16_t>(i);
 
-    shake256::shake256_t hasher;
-    hasher.absorb(_msg);
-    hasher.finalize();
-    hasher.squeeze(_buf);
+      nonce_bytes[j][0] = static_cast<uint8_t>(nonce_ >> 0);
+      nonce_bytes[j][1] = static_cast<uint8_t>(nonce_ >> 8);
 
-    bit_packing::decode<gbw>(buf, poly_t(vec.subspan(off, ntt::N)));
-    poly::sub_from_x<γ1>(poly_t(vec.subspan(off, ntt::N)));
+      msgs[j] = { seeds.subspan(j * 64, 64), nonce_bytes[j] };
+    }
+
+    keccak_xn::shake256_xn_t<L> hasher;
+    hasher.absorb_finalize(msgs);
+    hasher.squeeze(_buf, blen);
+
+    for (size_t j = 0; j < L; j++) {
+      auto poly = poly_t(vecs[j].subspan(off, ntt::N));
+
+      bit_packing::decode<gbw>(std::span<const uint8_t, blen>(_buf.subspan(j * blen, blen)), poly);
+      poly::sub_from_x<γ1>(poly);
+    }
   }
 }
 
+// Given 8 -bytes sign bits and a byte array, squeezed out of SHAKE256 Xof, this
+// routine consumes bytes of the array, placing next +/- 1 coefficient ( starting
+// at index i ) of a polynomial, being hashed to a ball. Returns index of next
+// coefficient to be placed, which is N once polynomial is fully sampled.
+//
+// This is the rejection sampling step of `sample_in_ball`.
+template<uint32_t τ>
+static inline constexpr size_t
+ball_step(std::span<const uint8_t, 8> tau_bits,
+          std::span<const uint8_t> buf,
+          std::span<field::zq_t, ntt::N> poly,
+          size_t i)
+  requires(dilithium_params::check_τ(τ))
+{
+  constexpr size_t frm = ntt::N - τ;
+
+  for (size_t off = 0; (off < buf.size()) && (i < ntt::N); off++) {
+    const size_t tau_bit = i - frm;
+
+    const size_t tau_byte_off = tau_bit >> 3;
+    const size_t tau_bit_off = tau_bit & 7ul;
+
+    const uint8_t s = (tau_bits[tau_byte_off] >> tau_bit_off) & 0b1;
+    const bool s_ = static_cast<bool>(s);
+
+    const auto tmp = buf[off];
+    const bool flg = tmp <= static_cast<uint8_t>(i);
+
+    const field::zq_t br0[]{ poly[i], poly[tmp] };
+    const field::zq_t br1[]{ poly[tmp], field::zq_t::one() - field::zq_t(2u * s_) };
+
+    poly[i] = br0[flg];
+    poly[tmp] = br1[flg];
+
+    i += 1ul * flg;
+  }
+
+  return i;
+}
+
 // Given a 32 -bytes seed, this routine creates a degree-255 polynomial with τ
 // -many coefficients set to +/- 1, while remaining (256 - τ) -many set to 0.
 //
@@ -204,32 +517,11 @@ sample_in_ball(std::span<const uint8_t, 32> seed, std::span<field::zq_t, ntt::N>
   hasher.finalize();
   hasher.squeeze(_tau_bits);
 
-  constexpr size_t frm = ntt::N - τ;
-  size_t i = frm;
+  size_t i = ntt::N - τ;
 
   while (i < ntt::N) {
     hasher.squeeze(_buf);
-
-    for (size_t off = 0; (off < _buf.size()) && (i < ntt::N); off++) {
-      const size_t tau_bit = i - frm;
-
-      const size_t tau_byte_off = tau_bit >> 3;
-      const size_t tau_bit_off = tau_bit & 7ul;
-
-      const uint8_t s = (_tau_bits[tau_byte_off] >> tau_bit_off) & 0b1;
-      const bool s_ = static_cast<bool>(s);
-
-      const auto tmp = _buf[off];
-      const bool flg = tmp <= static_cast<uint8_t>(i);
-
-      const field::zq_t br0[]{ poly[i], poly[tmp] };
-      const field::zq_t br1[]{ poly[tmp], field::zq_t::one() - field::zq_t(2u * s_) };
-
-      poly[i] = br0[flg];
-      poly[tmp] = br1[flg];
-
-      i += 1ul * flg;
-    }
+    i = ball_step<τ>(_tau_bits, _buf, poly, i);
   };
 }
 
@@ -0,0 +1,126 @@
+#pragma once
+#include "dilithium.hpp"
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+// Concurrent cache of prepared Dilithium secret keys, expanded from 32 -bytes
+// seed-only secret keys
+namespace seckey_cache {
+
+// Thread-safe cache of prepared Dilithium secret keys ( see
+// `dilithium::prepared_seckey_t` ), each expanded from the 32 -bytes seed, which
+// was used for generating its key pair ( see `dilithium::keygen` ). So a seed is
+// expanded once per process, instead of decoding serialized secret key before
+// every signature.
+//
+// Entries are keyed by ρ, first 32 -bytes of H(seed), which is public ( it's part
+// of public key ), so that cache never holds the seed itself. A process holds a
+// handful of signing keys, hence cache is unbounded, entries stay resident until
+// they are erased or cache is cleared. Prepared secret keys are wiped once the
+// last reference to them is dropped.
+template<size_t k, size_t l, size_t d, uint32_t η>
+  requires(dilithium_params::check_keygen_params(k, l, d, η))
+struct cache_t
+{
+public:
+  using prepared_t = dilithium::prepared_seckey_t<k, l>;
+  using entry_t = std::shared_ptr<const prepared_t>;
+
+  inline cache_t() = default;
+
+  cache_t(const cache_t&) = delete;
+  cache_t& operator=(const cache_t&) = delete;
+
+  // Given a 32 -bytes seed, returns prepared secret key of its key pair, either
+  // from cache ( on hit ) or by expanding the seed ( on miss ), in which case
+  // the prepared secret key is admitted into cache.
+  //
+  // Returned prepared secret key stays valid for as long as it's held by the
+  // caller, even if it gets erased from cache meanwhile.
+  inline entry_t get(std::span<const uint8_t, 32> seed)
+  {
+    const key_t key = key_of(seed);
+
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+
+      auto it = entries.find(key);
+      if (it != entries.end()) {
+        metrics::on_cache<k, l>(metrics::cache_t::seckey, metrics::cache_event_t::hit);
+        return it->second;
+      }
+    }
+
+    metrics::on_cache<k, l>(metrics::cache_t::seckey, metrics::cache_event_t::miss);
+
+    // Expand seed outside of the lock, it's the expensive part.
+    std::shared_ptr<prepared_t> prepared(new prepared_t(), [](prepared_t* ptr) {
+      ptr->wipe();
+      delete ptr;
+    });
+    dilithium::prepare_seckey_from_seed<k, l, d, η>(seed, *prepared);
+
+    std::lock_guard<std::mutex> lock(mtx);
+
+    // Some other thread may have admitted it, meanwhile.
+    return entries.try_emplace(key, std::move(prepared)).first->second;
+  }
+
+  // Drops prepared secret key of given seed, if cached.
+  inline void erase(std::span<const uint8_t, 32> seed)
+  {
+    const key_t key = key_of(seed);
+
+    std::lock_guard<std::mutex> lock(mtx);
+    entries.erase(key);
+  }
+
+  // Returns number of prepared secret keys, currently held in cache.
+  inline size_t size() const
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    return entries.size();
+  }
+
+  // Drops all cached secret keys.
+  inline void clear()
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    entries.clear();
+  }
+
+private:
+  using key_t = std::array<uint8_t, 32>;
+
+  // Cache key is output of SHAKE256 Xof, so any 8 -bytes of it are as good a
+  // hash as any other.
+  struct key_hash_t
+  {
+    inline size_t operator()(const key_t& key) const
+    {
+      uint64_t v = 0;
+      std::memcpy(&v, key.data(), sizeof(v));
+      return static_cast<size_t>(v);
+    }
+  };
+
+  // Computes ρ i.e. first 32 -bytes of H(seed), see `dilithium::expand_seed`.
+  static inline key_t key_of(std::span<const uint8_t, 32> seed)
+  {
+    key_t key{};
+
+    shake256::shake256_t hasher;
+    hasher.absorb(seed);
+    hasher.finalize();
+    hasher.squeeze(key);
+
+    return key;
+  }
+
+  mutable std::mutex mtx;
+  std::unordered_map<key_t, entry_t, key_hash_t> entries;
+};
+
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include "metrics.hpp"
+#include "probes.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+// Opt-in profiling of Dilithium signing loop i.e. how many attempts each
+// signature took and which bound check rejected each failed attempt.
+//
+// Enabled by compiling with `-DDILITHIUM_PROFILE_SIGN`, otherwise every hook
+// compiles to nothing. Define it consistently for all translation units, as
+// level wrappers ( say `dilithium3::sign` ) are inline functions.
+//
+// Hooks also forward to library-wide metrics ( see `metrics.hpp` ) and fire USDT
+// probes ( see `probes.hpp` ), which are enabled independently, so that every
+// signing path feeds all of them.
+namespace sign_profile {
+
+#if defined(DILITHIUM_PROFILE_SIGN)
+constexpr bool ENABLED = true;
+#else
+constexpr bool ENABLED = false;
+#endif
+
+// Bound checks of a signing attempt, in the order they are run, see
+// `dilithium::respond`.
+enum class reject_t : size_t
+{
+  z_norm = 0,   // ||z||∞ >= γ1 - β
+  r0_norm = 1,  // ||r0||∞ >= γ2 - β
+  ct0_norm = 2, // ||ct0||∞ >= γ2
+  hint_cnt = 3, // number of 1s in h > ω
+};
+
+// Number of buckets in histogram of attempts per signature, last one counts
+// signatures which took that many or more attempts.
+constexpr size_t HIST_LEN = 32;
+
+// Signing loop counters, of one parameter set, on one thread.
+//
+// Each rejected attempt is attributed to the first bound check it failed, so
+// that `attempts == signatures + sum(rejections)`, as long as every attempt is
+// made as part of computing a signature on the same thread.
+struct counters_t
+{
+  uint64_t signatures = 0;
+  uint64_t attempts = 0;
+  uint64_t max_attempts = 0;
+  std::array<uint64_t, 4> rejections{};
+  std::array<uint64_t, HIST_LEN> attempts_hist{};
+
+  // Returns number of attempts rejected by given bound check.
+  inline uint64_t rejected_by(const reject_t check) const { return rejections[static_cast<size_t>(check)]; }
+};
+
+// Returns counters of the parameter set, accumulated by calling thread. Being
+// thread-local, they are updated and read without any synchronization.
+template<size_t k, size_t l, uint32_t γ1, uint32_t γ2, uint32_t τ, uint32_t β, size_t ω>
+inline counters_t&
+counters()
+{
+  static thread_local counters_t cnt;
+  return cnt;
+}
+
+// While alive, makes `on_reject`, called on the same thread, store bound check
+// which rejected the attempt into `dst`, instead of reporting it. Lets one run
+// signing attempts speculatively and later report rejections of only those
+// attempts, which count towards the signature ( see
+// `dilithium_batch::sign_speculative` ), keeping every hook's totals in sync.
+struct defer_t
+{
+  inline explicit defer_t(std::optional<reject_t>& dst)
+    : prev(target)
+  {
+    dst.reset();
+    target = &dst;
+  }
+  inline ~defer_t() { target = prev; }
+
+  defer_t(const defer_t&) = delete;
+  defer_t& operator=(const defer_t&) = delete;
+
+  static inline thread_local std::optional<reject_t>* target = nullptr;
+
+private:
+  std::optional<reject_t>* prev;
+};
+
+// Records that a signing attempt got rejected by given bound check, unless a
+// `defer_t` is alive on calling thread.
+template<size_t k, size_t l, uint32_t γ1, uint32_t γ2, uint32_t τ, uint32_t β, size_t ω>
+static inline void
+on_reject(const reject_t check)
+{
+  if (defer_t::target != nullptr) {
+    *defer_t::target = check;
+    return;
+  }
+
+  metrics::on_sign_reject<k, l>(static_cast<size_t>(check));
+  DILITHIUM_PROBE_ARG(attempt_reject, k, l, static_cast<size_t>(check));
+
+  if constexpr (ENABLED) {
+    auto& cnt = counters<k, l, γ1, γ2, τ, β, ω>();
+
+    cnt.attempts++;
+    cnt.rejections[static_cast<size_t>(check)]++;
+  }
+}
+
+// Records that a signature got computed, after given number of attempts, last
+// of which got accepted.
+template<size_t k, size_t l, uint32_t γ1, uint32_t γ2, uint32_t τ, uint32_t β, size_t ω>
+static inline void
+on_signature(const size_t attempts)
+{
+  metrics::on_sign<k, l>(attempts);
+  DILITHIUM_PROBE_ARG(attempt_accept, k, l, attempts);
+
+  if constexpr (ENABLED) {
+    auto& cnt = counters<k, l, γ1, γ2, τ, β, ω>();
+
+    cnt.attempts++;
+    cnt.signatures++;
+    cnt.max_attempts = std::max<uint64_t>(cnt.max_attempts, attempts);
+    cnt.attempts_hist[std::min(attempts, HIST_LEN) - 1]++;
+  }
+}
+
+// Resets counters of the parameter set, accumulated by calling thread.
+template<size_t k, size_t l, uint32_t γ1, uint32_t γ2, uint32_t τ, uint32_t β, size_t ω>
+inline void
+reset()
+{
+  counters<k, l, γ1, γ2, τ, β, ω>() = counters_t{};
+}
+
+}
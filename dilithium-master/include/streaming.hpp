@@ -0,0 +1,146 @@
+#pragma once
+#include "dilithium.hpp"
+#include <memory>
+
+// Incremental ( init/ update/ final ) Dilithium signing and verification, for
+// messages which are not available in memory at once
+namespace dilithium_stream {
+
+// Streaming Dilithium signing context. Message is fed in arbitrary many chunks
+// ( see `update` ), which are absorbed straight into SHAKE256 computing
+// μ = H(tr || M), so that memory consumption doesn't depend on message length.
+//
+// Usage: `init` with a secret key, `update` with consecutive chunks of message,
+// then `final` producing signature, which is same as `dilithium::sign` produces
+// for whole message. Context must be initialized again, before signing another
+// message.
+template<size_t k,
+         size_t l,
+         size_t d,
+         uint32_t η,
+         uint32_t γ1,
+         uint32_t γ2,
+         uint32_t τ,
+         uint32_t β,
+         size_t ω,
+         bool randomized = false>
+  requires(dilithium_params::check_signing_params(k, l, d, η, γ1, γ2, τ, β, ω))
+struct sign_ctx_t
+{
+public:
+  using seckey_t = dilithium::prepared_seckey_t<k, l>;
+
+  // Prepares given serialized secret key and starts signing a new message.
+  inline void init(std::span<const uint8_t, dilithium_utils::sec_key_len<k, l, η, d>()> seckey)
+  {
+    auto prepared = std::make_shared<seckey_t>();
+    dilithium::prepare_seckey<k, l, d, η>(seckey, *prepared);
+
+    init(std::move(prepared));
+  }
+
+  // Starts signing a new message under an already prepared secret key, which
+  // may be shared with other contexts.
+  inline void init(std::shared_ptr<const seckey_t> seckey)
+  {
+    key = std::move(seckey);
+
+    hasher.reset();
+    hasher.absorb(key->tr);
+  }
+
+  // Absorbs next chunk of message, can be called arbitrary many times.
+  inline void update(std::span<const uint8_t> chunk) { hasher.absorb(chunk); }
+
+  // Finishes absorbing message and computes its signature. For randomized
+  // signing, 64 -bytes uniform random seed must be provided.
+  inline void final(std::span<uint8_t, dilithium_utils::sig_len<k, l, γ1, ω>()> sig,
+                    std::span<const uint8_t, 64 * randomized> seed)
+  {
+    std::array<uint8_t, 64> mu{};
+    std::array<uint8_t, 64> rho_prime{};
+
+    hasher.finalize();
+    hasher.squeeze(mu);
+
+    dilithium::workspace_t<k, l, γ2> ws;
+
+    dilithium::derive_rho_prime<k, l, randomized>(*key, mu, seed, rho_prime);
+    dilithium::sign_from_seeds<k, l, d, η, γ1, γ2, τ, β, ω>(*key, mu, rho_prime, sig, ws);
+
+    ws.wipe();
+    dilithium_utils::wipe(std::span(mu));
+    dilithium_utils::wipe(std::span(rho_prime));
+  }
+
+private:
+  std::shared_ptr<const seckey_t> key;
+  shake256::shake256_t hasher;
+};
+
+// Streaming Dilithium verification context, counterpart of `sign_ctx_t`.
+//
+// Usage: `init` with a public key, `update` with consecutive chunks of message,
+// then `final` with signature, returning truth value only when signature is
+// valid for whole message. Context must be initialized again, before verifying
+// another message. See `dilithium::verify` for meaning of `variable_time`.
+template<size_t k,
+         size_t l,
+         size_t d,
+         uint32_t γ1,
+         uint32_t γ2,
+         uint32_t τ,
+         uint32_t β,
+         size_t ω,
+         bool variable_time = false>
+  requires(dilithium_params::check_verify_params(k, l, d, γ1, γ2, τ, β, ω))
+struct verify_ctx_t
+{
+public:
+  using pubkey_t = dilithium::prepared_pubkey_t<k, l, d>;
+
+  // Prepares given serialized public key and starts verifying a new message.
+  inline void init(std::span<const uint8_t, dilithium_utils::pub_key_len<k, d>()> pubkey)
+  {
+    auto prepared = std::make_shared<pubkey_t>();
+    dilithium::prepare_pubkey<k, l, d>(pubkey, *prepared);
+
+    init(std::move(prepared));
+  }
+
+  // Starts verifying a new message under an already prepared public key, say
+  // the one obtained from a `pubkey_cache::cache_t`.
+  inline void init(std::shared_ptr<const pubkey_t> pubkey)
+  {
+    key = std::move(pubkey);
+
+    hasher.reset();
+    hasher.absorb(key->tr);
+  }
+
+  // Absorbs next chunk of message, can be called arbitrary many times.
+  inline void update(std::span<const uint8_t> chunk) { hasher.absorb(chunk); }
+
+  // Finishes absorbing message and verifies given signature.
+  inline bool final(std::span<const uint8_t, dilithium_utils::sig_len<k, l, γ1, ω>()> sig)
+  {
+    dilithium::workspace_t<k, l, γ2> ws;
+
+    if (!dilithium::decode_signature<k, l, γ1, β, ω>(sig, ws.z, ws.h)) {
+      return false;
+    }
+
+    std::array<uint8_t, 64> mu{};
+
+    hasher.finalize();
+    hasher.squeeze(mu);
+
+    return dilithium::verify_from_mu<k, l, d, γ1, γ2, τ, β, ω, variable_time>(*key, mu, sig, ws);
+  }
+
+private:
+  std::shared_ptr<const pubkey_t> key;
+  shake256::shake256_t hasher;
+};
+
+}
@@ -0,0 +1,240 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool, used for spreading independent Dilithium
+// operations ( or independent parts of one operation ) across CPU cores
+namespace thread_pool {
+
+using task_t = std::function<void()>;
+
+// Fixed size pool of worker threads, each owning a double-ended task queue.
+//
+// A worker pushes and pops tasks at the back of its own queue ( LIFO, for cache
+// locality ), while idle workers steal tasks from front of other workers'
+// queues ( FIFO, oldest and likely largest tasks first ). Tasks submitted from
+// threads which don't belong to the pool are distributed over queues in round
+// robin fashion.
+//
+// Thread waiting for completion of a `parallel_for` keeps executing queued
+// tasks meanwhile, so that `parallel_for` can be safely nested i.e. called from
+// a task, which itself is being executed by the pool.
+struct pool_t
+{
+public:
+  // Spawns `thread_cnt` -many worker threads. Pool with zero worker threads is
+  // allowed, in that case everything is executed by the calling thread.
+  inline explicit pool_t(const size_t thread_cnt = default_thread_count())
+    : queue_cnt(std::max<size_t>(thread_cnt, 1))
+    , queues(std::make_unique<queue_t[]>(queue_cnt))
+  {
+    workers.reserve(thread_cnt);
+    for (size_t i = 0; i < thread_cnt; i++) {
+      workers.emplace_back([this, i]() { worker_loop(i); });
+    }
+  }
+
+  pool_t(const pool_t&) = delete;
+  pool_t& operator=(const pool_t&) = delete;
+
+  inline ~pool_t()
+  {
+    {
+      std::lock_guard<std::mutex> lock(sleep_mtx);
+      stopping = true;
+    }
+    sleep_cv.notify_all();
+
+    for (auto& w : workers) {
+      w.join();
+    }
+  }
+
+  // Returns number of worker threads in this pool.
+  inline size_t size() const { return workers.size(); }
+
+  // Invokes `fn(i)` for each i ∈ [0, cnt), spreading invocations across worker
+  // threads and the calling thread, returning only when all of them have
+  // finished. Indices are handed out dynamically, one at a time, so uneven
+  // per-index cost is balanced.
+  //
+  // If some `fn(i)` throws, no more indices are handed out and, once all
+  // invocations already running have finished, first exception thrown is
+  // rethrown on the calling thread.
+  template<typename F>
+  inline void parallel_for(const size_t cnt, F&& fn)
+  {
+    if (cnt == 0) {
+      return;
+    }
+
+    const size_t helper_cnt = std::min(cnt, size() + 1) - 1;
+    if (helper_cnt == 0) {
+      for (size_t i = 0; i < cnt; i++) {
+        fn(i);
+      }
+      return;
+    }
+
+    std::atomic<size_t> next_idx{ 0 };
+    std::atomic<size_t> pending{ helper_cnt };
+    std::atomic<bool> failed{ false };
+    std::exception_ptr error;
+
+    // Never lets an exception out, as a helper task runs on a worker thread,
+    // while calling thread must not leave this frame before helpers are done.
+    auto drain = [&]() {
+      size_t i;
+      while ((i = next_idx.fetch_add(1, std::memory_order_relaxed)) < cnt) {
+        try {
+          fn(i);
+        } catch (...) {
+          if (!failed.exchange(true, std::memory_order_acq_rel)) {
+            error = std::current_exception();
+          }
+          next_idx.store(cnt, std::memory_order_relaxed);
+        }
+      }
+    };
+
+    for (size_t i = 0; i < helper_cnt; i++) {
+      push([&]() {
+        drain();
+        pending.fetch_sub(1, std::memory_order_release);
+      });
+    }
+
+    drain();
+
+    // Helper tasks refer to this stack frame, so wait for all of them to
+    // finish, not only for all indices to be claimed.
+    while (pending.load(std::memory_order_acquire) != 0) {
+      if (!try_run_one()) {
+        std::this_thread::yield();
+      }
+    }
+
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  // Number of worker threads, spawned by default.
+  static inline size_t default_thread_count() { return std::max<size_t>(std::thread::hardware_concurrency(), 1); }
+
+private:
+  struct queue_t
+  {
+    std::mutex mtx;
+    std::deque<task_t> tasks;
+  };
+
+  const size_t queue_cnt;
+  std::unique_ptr<queue_t[]> queues;
+  std::vector<std::thread> workers;
+
+  std::mutex sleep_mtx;
+  std::condition_variable sleep_cv;
+  std::atomic<size_t> queued{ 0 };
+  std::atomic<size_t> next_queue{ 0 };
+  bool stopping = false;
+
+  // Pool, which current thread is a worker of, along with its queue index.
+  static inline thread_local const pool_t* current_pool = nullptr;
+  static inline thread_local size_t current_index = 0;
+
+  inline void push(task_t task)
+  {
+    const size_t idx = (current_pool == this) ? current_index
+                                              : next_queue.fetch_add(1, std::memory_order_relaxed) % queue_cnt;
+
+    {
+      std::lock_guard<std::mutex> lock(queues[idx].mtx);
+      queues[idx].tasks.push_back(std::move(task));
+    }
+
+    queued.fetch_add(1, std::memory_order_release);
+
+    // Taking the lock ensures that a worker, which has just seen empty queues,
+    // is already waiting on condition variable, so that it doesn't miss this
+    // notification.
+    { std::lock_guard<std::mutex> lock(sleep_mtx); }
+    sleep_cv.notify_one();
+  }
+
+  // Pops one task from own queue ( if current thread is a worker of this pool )
+  // or steals one from some other queue, executing it. Returns false, if no
+  // task was found.
+  inline bool try_run_one()
+  {
+    task_t task;
+
+    const bool is_worker = current_pool == this;
+    const size_t own = is_worker ? current_index : 0;
+
+    if (is_worker) {
+      std::lock_guard<std::mutex> lock(queues[own].mtx);
+      if (!queues[own].tasks.empty()) {
+        task = std::move(queues[own].tasks.back());
+        queues[own].tasks.pop_back();
+      }
+    }
+
+    for (size_t i = is_worker ? 1 : 0; !task && (i < queue_cnt); i++) {
+      const size_t victim = (own + i) % queue_cnt;
+
+      std::lock_guard<std::mutex> lock(queues[victim].mtx);
+      if (!queues[victim].tasks.empty()) {
+        task = std::move(queues[victim].tasks.front());
+        queues[victim].tasks.pop_front();
+      }
+    }
+
+    if (!task) {
+      return false;
+    }
+
+    queued.fetch_sub(1, std::memory_order_relaxed);
+    task();
+    return true;
+  }
+
+  inline void worker_loop(const size_t idx)
+  {
+    current_pool = this;
+    current_index = idx;
+
+    while (true) {
+      if (try_run_one()) {
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock(sleep_mtx);
+      sleep_cv.wait(lock, [this]() { return stopping || (queued.load(std::memory_order_acquire) != 0); });
+
+      if (stopping && (queued.load(std::memory_order_acquire) == 0)) {
+        break;
+      }
+    }
+  }
+};
+
+// Returns process-wide thread pool, lazily created on first use, with as many
+// worker threads as there are hardware threads.
+inline pool_t&
+default_pool()
+{
+  static pool_t pool;
+  return pool;
+}
+
+}
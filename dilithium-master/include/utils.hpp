@@ -4,6 +4,7 @@
 #include <cassert>
 #include <charconv>
 #include <iomanip>
+#include <span>
 #include <sstream>
 #include <vector>
 
@@ -54,6 +55,19 @@ sig_len()
   return siglen;
 }
 
+// Overwrites each element of given array with zero bytes, through a volatile
+// pointer, so that compiler can't elide it as a dead store, even when the array
+// is never read again. Used for wiping secret intermediates.
+template<typename T, size_t N>
+static inline void
+wipe(std::span<T, N> arr)
+{
+  volatile uint8_t* ptr = reinterpret_cast<volatile uint8_t*>(arr.data());
+  for (size_t i = 0; i < arr.size_bytes(); i++) {
+    ptr[i] = 0;
+  }
+}
+
 // Given a bytearray of length N, this function converts it to human readable
 // hex string of length N << 1 | N >= 0
 static inline const std::string
@@ -0,0 +1,229 @@
+#include "dilithium.h"
+#include "runtime.hpp"
+
+// Precompiled signers and verifiers of all three security levels, which
+// translation units built with `DILITHIUM_EXTERN_TEMPLATES` link against, see
+// `runtime.hpp`.
+namespace dilithium {
+
+template struct signer_t::impl_t<params_t<level_t::dilithium2>>;
+template struct signer_t::impl_t<params_t<level_t::dilithium3>>;
+template struct signer_t::impl_t<params_t<level_t::dilithium5>>;
+template struct verifier_t::impl_t<params_t<level_t::dilithium2>>;
+template struct verifier_t::impl_t<params_t<level_t::dilithium3>>;
+template struct verifier_t::impl_t<params_t<level_t::dilithium5>>;
+
+}
+
+// C ABI, see `dilithium.h`. Exceptions never cross it, they are turned into
+// status codes.
+
+struct dilithium_signer
+{
+  dilithium::signer_t signer;
+};
+
+struct dilithium_verifier
+{
+  dilithium::verifier_t verifier;
+};
+
+// Maps C security level to `dilithium::level_t`, returning false if it's not
+// one of 2, 3, 5.
+static inline bool
+to_level(const int level, dilithium::level_t& lv)
+{
+  switch (level) {
+    case 2:
+      lv = dilithium::level_t::dilithium2;
+      return true;
+    case 3:
+      lv = dilithium::level_t::dilithium3;
+      return true;
+    case 5:
+      lv = dilithium::level_t::dilithium5;
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Signs a message, under given signer, see `dilithium_sign`.
+static inline int
+sign_with(const dilithium::signer_t& signer, const uint8_t* msg, const size_t msg_len, const uint8_t* rnd, uint8_t* sig)
+{
+  const auto _msg = std::span(msg, msg_len);
+  const auto _sig = std::span(sig, signer.sig_len());
+
+  if (rnd == nullptr) {
+    signer.sign(_msg, _sig, {});
+  } else {
+    signer.sign<true>(_msg, _sig, std::span<const uint8_t, 64>(rnd, 64));
+  }
+
+  return DILITHIUM_OK;
+}
+
+// Verifies a signature, under given verifier, see `dilithium_verify`.
+static inline int
+verify_with(const dilithium::verifier_t& verifier,
+            const uint8_t* msg,
+            const size_t msg_len,
+            const uint8_t* sig,
+            const size_t sig_len)
+{
+  const bool flg = verifier.verify(std::span(msg, msg_len), std::span(sig, sig_len));
+  return flg ? DILITHIUM_OK : DILITHIUM_ERR_INVALID;
+}
+
+extern "C" size_t
+dilithium_pubkey_len(const int level)
+{
+  dilithium::level_t lv;
+  return to_level(level, lv) ? dilithium::pub_key_len(lv) : 0;
+}
+
+extern "C" size_t
+dilithium_seckey_len(const int level)
+{
+  dilithium::level_t lv;
+  return to_level(level, lv) ? dilithium::sec_key_len(lv) : 0;
+}
+
+extern "C" size_t
+dilithium_sig_len(const int level)
+{
+  dilithium::level_t lv;
+  return to_level(level, lv) ? dilithium::sig_len(lv) : 0;
+}
+
+extern "C" int
+dilithium_keygen(const int level, const uint8_t seed[32], uint8_t* pubkey, uint8_t* seckey)
+{
+  dilithium::level_t lv;
+  if (!to_level(level, lv)) {
+    return DILITHIUM_ERR_LEVEL;
+  }
+
+  try {
+    dilithium::keygen(lv,
+                      std::span<const uint8_t, 32>(seed, 32),
+                      std::span(pubkey, dilithium::pub_key_len(lv)),
+                      std::span(seckey, dilithium::sec_key_len(lv)));
+    return DILITHIUM_OK;
+  } catch (...) {
+    return DILITHIUM_ERR_INTERNAL;
+  }
+}
+
+extern "C" int
+dilithium_sign(const int level,
+               const uint8_t* seckey,
+               const uint8_t* msg,
+               const size_t msg_len,
+               const uint8_t* rnd,
+               uint8_t* sig)
+{
+  dilithium::level_t lv;
+  if (!to_level(level, lv)) {
+    return DILITHIUM_ERR_LEVEL;
+  }
+
+  try {
+    const dilithium::signer_t signer(lv, std::span(seckey, dilithium::sec_key_len(lv)));
+    return sign_with(signer, msg, msg_len, rnd, sig);
+  } catch (...) {
+    return DILITHIUM_ERR_INTERNAL;
+  }
+}
+
+extern "C" int
+dilithium_verify(const int level,
+                 const uint8_t* pubkey,
+                 const uint8_t* msg,
+                 const size_t msg_len,
+                 const uint8_t* sig,
+                 const size_t sig_len)
+{
+  dilithium::level_t lv;
+  if (!to_level(level, lv)) {
+    return DILITHIUM_ERR_LEVEL;
+  }
+
+  try {
+    const dilithium::verifier_t verifier(lv, std::span(pubkey, dilithium::pub_key_len(lv)));
+    return verify_with(verifier, msg, msg_len, sig, sig_len);
+  } catch (...) {
+    return DILITHIUM_ERR_INTERNAL;
+  }
+}
+
+extern "C" dilithium_signer*
+dilithium_signer_new(const int level, const uint8_t* seckey, const size_t seckey_len)
+{
+  dilithium::level_t lv;
+  if (!to_level(level, lv)) {
+    return nullptr;
+  }
+
+  try {
+    return new dilithium_signer{ dilithium::signer_t(lv, std::span(seckey, seckey_len)) };
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+extern "C" int
+dilithium_signer_sign(const dilithium_signer* signer,
+                      const uint8_t* msg,
+                      const size_t msg_len,
+                      const uint8_t* rnd,
+                      uint8_t* sig)
+{
+  try {
+    return sign_with(signer->signer, msg, msg_len, rnd, sig);
+  } catch (...) {
+    return DILITHIUM_ERR_INTERNAL;
+  }
+}
+
+extern "C" void
+dilithium_signer_free(dilithium_signer* signer)
+{
+  delete signer;
+}
+
+extern "C" dilithium_verifier*
+dilithium_verifier_new(const int level, const uint8_t* pubkey, const size_t pubkey_len)
+{
+  dilithium::level_t lv;
+  if (!to_level(level, lv)) {
+    return nullptr;
+  }
+
+  try {
+    return new dilithium_verifier{ dilithium::verifier_t(lv, std::span(pubkey, pubkey_len)) };
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+extern "C" int
+dilithium_verifier_verify(const dilithium_verifier* verifier,
+                          const uint8_t* msg,
+                          const size_t msg_len,
+                          const uint8_t* sig,
+                          const size_t sig_len)
+{
+  try {
+    return verify_with(verifier->verifier, msg, msg_len, sig, sig_len);
+  } catch (...) {
+    return DILITHIUM_ERR_INTERNAL;
+  }
+}
+
+extern "C" void
+dilithium_verifier_free(dilithium_verifier* verifier)
+{
+  delete verifier;
+}
@@ -0,0 +1,160 @@
+#include "dilithium3.hpp"
+#include <cstdio>
+#include <vector>
+
+#define DUDECT_IMPLEMENTATION
+#define DUDECT_VISIBLITY_STATIC
+#include "dudect.h"
+
+// Number of accepted signing attempts, precomputed for each class.
+constexpr size_t TABLE_LEN = 32;
+
+// One signing attempt, known to be accepted i.e. passing all bound checks.
+struct attempt_t
+{
+  std::array<field::zq_t, dilithium3::l * ntt::N> s1{};
+  std::array<field::zq_t, dilithium3::k * ntt::N> s2{};
+  std::array<field::zq_t, dilithium3::k * ntt::N> t0{};
+  std::array<uint8_t, 64> mu{};
+  std::array<uint8_t, 64> rho_prime{};
+  uint16_t kappa = 0;
+};
+
+static std::array<field::zq_t, dilithium3::k * dilithium3::l * ntt::N> A{};
+static dilithium3::workspace_t ws;
+
+// Class 0 attempts are all made using same ( fixed ) secret key, while class 1
+// attempts use a fresh random secret key each.
+static std::array<std::vector<attempt_t>, 2> attempts{};
+
+// Samples secret vectors s1, s2 ( from given seed ) and t0 ( uniform random ),
+// keeping them in NTT representation, as consumed by `sign_attempt`.
+static void
+sample_secret(std::span<const uint8_t, 64> seed, prng::prng_t& prng, attempt_t& at)
+{
+  constexpr uint32_t t0_rng = 1u << (dilithium3::d - 1);
+
+  sampling::expand_s<dilithium3::η, dilithium3::l, 0>(seed, at.s1);
+  sampling::expand_s<dilithium3::η, dilithium3::k, dilithium3::l>(seed, at.s2);
+
+  for (size_t i = 0; i < at.t0.size(); i++) {
+    std::array<uint8_t, 2> buf{};
+    prng.read(buf);
+
+    const uint32_t v = ((static_cast<uint32_t>(buf[1]) << 8) | buf[0]) & ((1u << dilithium3::d) - 1u);
+    at.t0[i] = field::zq_t(t0_rng) - field::zq_t(v);
+  }
+
+  polyvec::ntt<dilithium3::l>(at.s1);
+  polyvec::ntt<dilithium3::k>(at.s2);
+  polyvec::ntt<dilithium3::k>(at.t0);
+}
+
+// Finds, for each class, TABLE_LEN -many ( μ, ρ', κ ) s.t. signing attempt is
+// accepted, so that measured attempts never differ in their rejection outcome.
+static void
+prepare_attempts()
+{
+  prng::prng_t prng;
+
+  std::array<uint8_t, 32> rho{};
+  prng.read(rho);
+  sampling::expand_a<dilithium3::k, dilithium3::l>(rho, A);
+
+  std::array<uint8_t, 64> fixed_seed{};
+
+  for (size_t cls = 0; cls < attempts.size(); cls++) {
+    attempts[cls].resize(TABLE_LEN);
+
+    for (auto& at : attempts[cls]) {
+      std::array<uint8_t, 64> seed = fixed_seed;
+      if (cls == 1) {
+        prng.read(seed);
+      }
+
+      sample_secret(seed, prng, at);
+      prng.read(at.mu);
+      prng.read(at.rho_prime);
+
+      while (!dilithium::sign_attempt<dilithium3::k,
+                                      dilithium3::l,
+                                      dilithium3::γ1,
+                                      dilithium3::γ2,
+                                      dilithium3::τ,
+                                      dilithium3::β,
+                                      dilithium3::ω>(A, at.s1, at.s2, at.t0, at.mu, at.rho_prime, at.kappa, ws)) {
+        at.kappa += static_cast<uint16_t>(dilithium3::l);
+      }
+    }
+  }
+}
+
+uint8_t
+do_one_computation(uint8_t* const data)
+{
+  const auto& at = attempts[data[0] & 1][data[1] % TABLE_LEN];
+
+  const bool accepted = dilithium::sign_attempt<dilithium3::k,
+                                                dilithium3::l,
+                                                dilithium3::γ1,
+                                                dilithium3::γ2,
+                                                dilithium3::τ,
+                                                dilithium3::β,
+                                                dilithium3::ω>(A, at.s1, at.s2, at.t0, at.mu, at.rho_prime, at.kappa, ws);
+
+  uint8_t ret_val = static_cast<uint8_t>(accepted);
+  ret_val ^= ws.c_tilde[0] ^ ws.c_tilde[ws.c_tilde.size() - 1];
+  ret_val ^= static_cast<uint8_t>(ws.z[0].raw() ^ ws.h[ws.h.size() - 1].raw());
+
+  return ret_val;
+}
+
+void
+prepare_inputs(dudect_config_t* const c, uint8_t* const input_data, uint8_t* const classes)
+{
+  randombytes(input_data, c->number_measurements * c->chunk_size);
+
+  for (size_t i = 0; i < c->number_measurements; i++) {
+    classes[i] = randombit();
+    input_data[i * c->chunk_size] = classes[i];
+  }
+}
+
+// Ensure that time taken by an accepted signing attempt doesn't depend on
+// secret key, i.e. early exits of `sign_attempt` are only driven by rejection
+// outcome of the attempt.
+dudect_state_t
+test_dilithium3_sign_attempt()
+{
+  constexpr size_t chunk_size = 2;
+  constexpr size_t number_measurements = 1e4;
+
+  dudect_config_t config = {
+    chunk_size,
+    number_measurements,
+  };
+  dudect_ctx_t ctx;
+  dudect_init(&ctx, &config);
+
+  dudect_state_t state = DUDECT_NO_LEAKAGE_EVIDENCE_YET;
+  while (state == DUDECT_NO_LEAKAGE_EVIDENCE_YET) {
+    state = dudect_main(&ctx);
+  }
+
+  dudect_free(&ctx);
+
+  printf("Detected timing leakage in \"%s\", defined in file \"%s\"\n", __func__, __FILE_NAME__);
+  return state;
+}
+
+int
+main()
+{
+  prepare_attempts();
+
+  if (test_dilithium3_sign_attempt() != DUDECT_NO_LEAKAGE_EVIDENCE_YET) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
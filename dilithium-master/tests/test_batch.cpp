@@ -0,0 +1,287 @@
+#include "dilithium3.hpp"
+#include "dilithium5.hpp"
+#include <atomic>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// Ensure that batch verification of Dilithium3 signatures agrees with verifying
+// each of them separately, when jobs are spread over a few public keys and some
+// of the signatures/ messages are tampered with.
+static inline void
+test_dilithium3_verify_batch(thread_pool::pool_t& pool)
+{
+  constexpr size_t key_cnt = 3;
+  constexpr size_t job_cnt = 40;
+  constexpr size_t mlen = 33;
+
+  std::vector<std::array<uint8_t, dilithium3::PubKeyLen>> pubkeys(key_cnt);
+  std::vector<std::array<uint8_t, dilithium3::SecKeyLen>> seckeys(key_cnt);
+  std::vector<std::vector<uint8_t>> msgs(job_cnt, std::vector<uint8_t>(mlen));
+  std::vector<std::array<uint8_t, dilithium3::SigLen>> sigs(job_cnt);
+
+  prng::prng_t prng;
+
+  for (size_t i = 0; i < key_cnt; i++) {
+    std::array<uint8_t, 32> seed{};
+    prng.read(seed);
+
+    dilithium3::keygen(seed, pubkeys[i], seckeys[i]);
+  }
+
+  std::vector<dilithium3::verify_job_t> jobs;
+  std::vector<bool> expected(job_cnt);
+
+  for (size_t i = 0; i < job_cnt; i++) {
+    // First key is used much more often than others, making its group large
+    // enough to be split across workers.
+    const size_t kidx = (i % 4 == 0) ? (1 + (i / 4) % 2) : 0;
+
+    prng.read(msgs[i]);
+    dilithium3::sign(seckeys[kidx], msgs[i], sigs[i], {});
+
+    if (i == 0 || i == 4) {
+      // First signature of a group fails cheap checks.
+      sigs[i][dilithium3::SigLen - 1] = static_cast<uint8_t>(dilithium3::ω + 1);
+    } else if (i % 5 == 1) {
+      sigs[i][i] ^= 0x80;
+    } else if (i % 7 == 3) {
+      msgs[i][0] ^= 0x01;
+    }
+
+    jobs.push_back({ pubkeys[kidx], msgs[i], sigs[i] });
+    expected[i] = dilithium3::verify(pubkeys[kidx], msgs[i], sigs[i]);
+  }
+
+  const auto bitmap = dilithium3::verify_batch(jobs, pool);
+
+  EXPECT_EQ(bitmap.size(), job_cnt);
+  EXPECT_EQ(bitmap, expected);
+  EXPECT_TRUE(std::count(bitmap.begin(), bitmap.end(), true) > 0);
+  EXPECT_TRUE(std::count(bitmap.begin(), bitmap.end(), false) > 0);
+}
+
+TEST(Dilithium, Dilithium3BatchVerification)
+{
+  thread_pool::pool_t serial(0);
+  thread_pool::pool_t parallel(3);
+
+  test_dilithium3_verify_batch(serial);
+  test_dilithium3_verify_batch(parallel);
+  test_dilithium3_verify_batch(thread_pool::default_pool());
+
+  EXPECT_TRUE(dilithium3::verify_batch({}).empty());
+}
+
+// Ensure that nested `parallel_for` invocations, on a work-stealing thread pool,
+// visit each index exactly once.
+TEST(Dilithium, WorkStealingThreadPool)
+{
+  constexpr size_t outer = 16;
+  constexpr size_t inner = 64;
+
+  thread_pool::pool_t pool(4);
+  std::vector<std::atomic<uint32_t>> visits(outer * inner);
+
+  pool.parallel_for(outer, [&](const size_t i) {
+    pool.parallel_for(inner, [&](const size_t j) { visits[i * inner + j].fetch_add(1); });
+  });
+
+  EXPECT_TRUE(std::all_of(visits.begin(), visits.end(), [](const auto& v) { return v.load() == 1; }));
+}
+
+// Ensure that an exception thrown by some invocation of `parallel_for` body, be
+// it on a worker or on the calling thread, reaches the caller, only after all
+// running invocations have finished, and that the pool stays usable afterwards.
+TEST(Dilithium, ThreadPoolException)
+{
+  constexpr size_t cnt = 256;
+
+  thread_pool::pool_t serial(0);
+  thread_pool::pool_t parallel(4);
+
+  for (auto* pool : { &serial, &parallel }) {
+    std::atomic<size_t> running{ 0 };
+    std::atomic<size_t> visited{ 0 };
+
+    EXPECT_THROW(pool->parallel_for(cnt,
+                                    [&](const size_t i) {
+                                      running.fetch_add(1);
+                                      visited.fetch_add(1);
+                                      if (i % 64 == 63) {
+                                        running.fetch_sub(1);
+                                        throw std::runtime_error("failed");
+                                      }
+                                      std::this_thread::yield();
+                                      running.fetch_sub(1);
+                                    }),
+                 std::runtime_error);
+
+    EXPECT_EQ(running.load(), 0u);
+    if (pool == &serial) {
+      EXPECT_EQ(visited.load(), 64u);
+    }
+
+    std::atomic<size_t> sum{ 0 };
+    pool->parallel_for(cnt, [&](const size_t i) { sum.fetch_add(i); });
+    EXPECT_EQ(sum.load(), cnt * (cnt - 1) / 2);
+  }
+}
+
+// Ensure that speculatively evaluating a few signing attempts at once, produces
+// same signature as sequential signing does, for different number of attempts
+// per round, both with deterministic and randomized signing.
+TEST(Dilithium, SpeculativeSigning)
+{
+  thread_pool::pool_t serial(0);
+  thread_pool::pool_t parallel(3);
+
+  std::array<uint8_t, 32> seed{};
+  std::array<uint8_t, 64> rnd{};
+  std::array<uint8_t, dilithium5::PubKeyLen> pkey{};
+  std::array<uint8_t, dilithium5::SecKeyLen> skey{};
+  std::array<uint8_t, dilithium5::SigLen> sig0{};
+  std::array<uint8_t, dilithium5::SigLen> sig1{};
+  std::array<uint8_t, 32> msg{};
+
+  prng::prng_t prng;
+  prng.read(seed);
+  dilithium5::keygen(seed, pkey, skey);
+
+  for (size_t i = 0; i < 8; i++) {
+    prng.read(msg);
+    prng.read(rnd);
+
+    dilithium5::sign(skey, msg, sig0, {});
+
+    for (const size_t width : { 0ul, 1ul, 2ul, 5ul }) {
+      dilithium5::sign_speculative(skey, msg, sig1, {}, serial, width);
+      EXPECT_EQ(sig0, sig1);
+
+      dilithium5::sign_speculative(skey, msg, sig1, {}, parallel, width);
+      EXPECT_EQ(sig0, sig1);
+    }
+
+    dilithium5::sign<true>(skey, msg, sig0, rnd);
+    dilithium5::sign_speculative<true>(skey, msg, sig1, rnd, parallel);
+
+    EXPECT_EQ(sig0, sig1);
+    EXPECT_TRUE(dilithium5::verify(pkey, msg, sig1));
+  }
+}
+
+// Ensure that batch signing of many messages under one prepared secret key,
+// produces same signatures as signing each of them separately, both with
+// deterministic and randomized signing, when number of messages isn't a
+// multiple of lane count.
+TEST(Dilithium, BatchSigning)
+{
+  constexpr size_t msg_cnt = 2 * keccak_xn::DEFAULT_LANES + 3;
+
+  thread_pool::pool_t serial(0);
+  thread_pool::pool_t parallel(3);
+
+  std::array<uint8_t, 32> seed{};
+  std::array<uint8_t, dilithium3::PubKeyLen> pkey{};
+  std::array<uint8_t, dilithium3::SecKeyLen> skey{};
+
+  prng::prng_t prng;
+  prng.read(seed);
+  dilithium3::keygen(seed, pkey, skey);
+
+  auto prepared = std::make_unique<dilithium3::prepared_seckey_t>();
+  dilithium3::prepare_seckey(skey, *prepared);
+
+  std::vector<std::vector<uint8_t>> msgs(msg_cnt);
+  std::vector<std::span<const uint8_t>> msg_spans;
+  std::vector<uint8_t> rnds(msg_cnt * 64);
+
+  for (size_t i = 0; i < msg_cnt; i++) {
+    msgs[i].resize(1 + i * 13);
+    prng.read(msgs[i]);
+    msg_spans.push_back(msgs[i]);
+  }
+  prng.read(rnds);
+
+  std::vector<uint8_t> expected(msg_cnt * dilithium3::SigLen);
+  std::vector<uint8_t> expected_rnd(msg_cnt * dilithium3::SigLen);
+
+  for (size_t i = 0; i < msg_cnt; i++) {
+    auto sig = std::span<uint8_t, dilithium3::SigLen>(expected.data() + i * dilithium3::SigLen, dilithium3::SigLen);
+    auto sig_rnd =
+      std::span<uint8_t, dilithium3::SigLen>(expected_rnd.data() + i * dilithium3::SigLen, dilithium3::SigLen);
+    auto rnd = std::span<const uint8_t, 64>(rnds.data() + i * 64, 64);
+
+    dilithium3::sign(skey, msgs[i], sig, {});
+    dilithium3::sign<true>(skey, msgs[i], sig_rnd, rnd);
+  }
+
+  for (auto* pool : { &serial, &parallel }) {
+    std::vector<uint8_t> computed(msg_cnt * dilithium3::SigLen);
+
+    dilithium3::sign_batch(*prepared, msg_spans, computed, {}, *pool);
+    EXPECT_EQ(computed, expected);
+
+    dilithium3::sign_batch<true>(*prepared, msg_spans, computed, rnds, *pool);
+    EXPECT_EQ(computed, expected_rnd);
+  }
+
+  std::vector<uint8_t> short_sigs((msg_cnt - 1) * dilithium3::SigLen);
+  EXPECT_THROW(dilithium3::sign_batch(*prepared, msg_spans, short_sigs, {}, serial), std::invalid_argument);
+
+  std::vector<uint8_t> computed(msg_cnt * dilithium3::SigLen);
+  EXPECT_THROW(dilithium3::sign_batch(*prepared, msg_spans, computed, rnds, serial), std::invalid_argument);
+  EXPECT_THROW(dilithium3::sign_batch<true>(*prepared, msg_spans, computed, {}, serial), std::invalid_argument);
+}
+
+// Ensure that spreading per-polynomial work of a single key generation, signing
+// and verification across threads, produces same key pair and signature, and
+// same verification outcome, as running it on calling thread does.
+TEST(Dilithium, IntraOpParallelism)
+{
+  thread_pool::pool_t serial(0);
+  thread_pool::pool_t parallel(3);
+
+  std::array<uint8_t, 32> seed{};
+  std::array<uint8_t, 64> rnd{};
+  std::array<uint8_t, dilithium5::PubKeyLen> pkey0{};
+  std::array<uint8_t, dilithium5::SecKeyLen> skey0{};
+  std::array<uint8_t, dilithium5::PubKeyLen> pkey1{};
+  std::array<uint8_t, dilithium5::SecKeyLen> skey1{};
+  std::array<uint8_t, dilithium5::SigLen> sig0{};
+  std::array<uint8_t, dilithium5::SigLen> sig1{};
+  std::array<uint8_t, 32> msg{};
+
+  prng::prng_t prng;
+  prng.read(seed);
+
+  dilithium5::keygen(seed, pkey0, skey0);
+
+  for (auto* pool : { &serial, &parallel }) {
+    const exec::parallel_t policy{ *pool };
+
+    dilithium5::keygen(seed, pkey1, skey1, policy);
+    EXPECT_EQ(pkey0, pkey1);
+    EXPECT_EQ(skey0, skey1);
+
+    for (size_t i = 0; i < 4; i++) {
+      prng.read(msg);
+      prng.read(rnd);
+
+      dilithium5::sign(skey0, msg, sig0, {});
+      dilithium5::sign(skey0, msg, sig1, {}, policy);
+      EXPECT_EQ(sig0, sig1);
+
+      dilithium5::sign<true>(skey0, msg, sig0, rnd);
+      dilithium5::sign<true>(skey0, msg, sig1, rnd, policy);
+      EXPECT_EQ(sig0, sig1);
+
+      EXPECT_TRUE(dilithium5::verify(pkey0, msg, sig1, policy));
+      EXPECT_TRUE(dilithium5::verify<true>(pkey0, msg, sig1, policy));
+
+      sig1[i] ^= 0x01;
+      EXPECT_FALSE(dilithium5::verify(pkey0, msg, sig1, policy));
+    }
+  }
+}
@@ -0,0 +1,93 @@
+#include "dilithium.h"
+#include "prng.hpp"
+#include "runtime.hpp"
+#include <gtest/gtest.h>
+
+// Ensure that C ABI, at given security level, computes same as the C++ API and
+// reports errors as status codes.
+static inline void
+test_c_api(const int level, const dilithium::level_t lv)
+{
+  const size_t pklen = dilithium::pub_key_len(lv);
+  const size_t sklen = dilithium::sec_key_len(lv);
+  const size_t siglen = dilithium::sig_len(lv);
+
+  EXPECT_EQ(dilithium_pubkey_len(level), pklen);
+  EXPECT_EQ(dilithium_seckey_len(level), sklen);
+  EXPECT_EQ(dilithium_sig_len(level), siglen);
+
+  std::array<uint8_t, 32> seed{};
+  std::array<uint8_t, 64> rnd{};
+  std::array<uint8_t, 32> msg{};
+  std::vector<uint8_t> pkey(pklen), pkey_cpp(pklen);
+  std::vector<uint8_t> skey(sklen), skey_cpp(sklen);
+  std::vector<uint8_t> sig(siglen), sig_cpp(siglen);
+
+  prng::prng_t prng;
+  prng.read(seed);
+  prng.read(rnd);
+  prng.read(msg);
+
+  EXPECT_EQ(dilithium_keygen(level, seed.data(), pkey.data(), skey.data()), DILITHIUM_OK);
+  dilithium::keygen(lv, seed, pkey_cpp, skey_cpp);
+  EXPECT_EQ(pkey, pkey_cpp);
+  EXPECT_EQ(skey, skey_cpp);
+
+  const dilithium::signer_t signer(lv, skey_cpp);
+
+  EXPECT_EQ(dilithium_sign(level, skey.data(), msg.data(), msg.size(), nullptr, sig.data()), DILITHIUM_OK);
+  signer.sign(msg, sig_cpp, {});
+  EXPECT_EQ(sig, sig_cpp);
+  EXPECT_EQ(dilithium_verify(level, pkey.data(), msg.data(), msg.size(), sig.data(), sig.size()), DILITHIUM_OK);
+  EXPECT_EQ(dilithium_verify(level, pkey.data(), msg.data(), msg.size(), sig.data(), sig.size() - 1),
+            DILITHIUM_ERR_INVALID);
+
+  EXPECT_EQ(dilithium_sign(level, skey.data(), msg.data(), msg.size(), rnd.data(), sig.data()), DILITHIUM_OK);
+  signer.sign<true>(msg, sig_cpp, rnd);
+  EXPECT_EQ(sig, sig_cpp);
+
+  dilithium_signer* csigner = dilithium_signer_new(level, skey.data(), skey.size());
+  dilithium_verifier* cverifier = dilithium_verifier_new(level, pkey.data(), pkey.size());
+  ASSERT_NE(csigner, nullptr);
+  ASSERT_NE(cverifier, nullptr);
+
+  EXPECT_EQ(dilithium_signer_sign(csigner, msg.data(), msg.size(), nullptr, sig.data()), DILITHIUM_OK);
+  EXPECT_EQ(dilithium_verifier_verify(cverifier, msg.data(), msg.size(), sig.data(), sig.size()), DILITHIUM_OK);
+
+  sig[siglen / 2] ^= 1;
+  EXPECT_EQ(dilithium_verifier_verify(cverifier, msg.data(), msg.size(), sig.data(), sig.size()),
+            DILITHIUM_ERR_INVALID);
+
+  dilithium_signer_free(csigner);
+  dilithium_verifier_free(cverifier);
+
+  EXPECT_EQ(dilithium_signer_new(level, pkey.data(), pkey.size()), nullptr);
+  EXPECT_EQ(dilithium_verifier_new(level, skey.data(), skey.size()), nullptr);
+}
+
+TEST(Dilithium, CABI)
+{
+  using dilithium::level_t;
+
+  test_c_api(2, level_t::dilithium2);
+  test_c_api(3, level_t::dilithium3);
+  test_c_api(5, level_t::dilithium5);
+
+  std::array<uint8_t, 32> seed{};
+  std::array<uint8_t, 32> msg{};
+  std::vector<uint8_t> pkey(dilithium_pubkey_len(2));
+  std::vector<uint8_t> skey(dilithium_seckey_len(2));
+  std::vector<uint8_t> sig(dilithium_sig_len(2));
+
+  EXPECT_EQ(dilithium_pubkey_len(4), 0ul);
+  EXPECT_EQ(dilithium_seckey_len(4), 0ul);
+  EXPECT_EQ(dilithium_sig_len(4), 0ul);
+  EXPECT_EQ(dilithium_keygen(4, seed.data(), pkey.data(), skey.data()), DILITHIUM_ERR_LEVEL);
+  EXPECT_EQ(dilithium_sign(4, skey.data(), msg.data(), msg.size(), nullptr, sig.data()), DILITHIUM_ERR_LEVEL);
+  EXPECT_EQ(dilithium_verify(4, pkey.data(), msg.data(), msg.size(), sig.data(), sig.size()), DILITHIUM_ERR_LEVEL);
+  EXPECT_EQ(dilithium_signer_new(4, skey.data(), skey.size()), nullptr);
+  EXPECT_EQ(dilithium_verifier_new(4, pkey.data(), pkey.size()), nullptr);
+
+  dilithium_signer_free(nullptr);
+  dilithium_verifier_free(nullptr);
+}
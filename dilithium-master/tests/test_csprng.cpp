@@ -0,0 +1,117 @@
+#include "csprng.hpp"
+#include "dilithium3.hpp"
+#include <gtest/gtest.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Ensure that CSPRNG serves reads of arbitrary length, crossing buffer refills,
+// ratchets and reseeding, and that independent generators don't output same bytes.
+TEST(Dilithium, BufferedCSPRNG)
+{
+  csprng::csprng_t rng0;
+  csprng::csprng_t rng1;
+
+  std::array<uint8_t, 64> a{};
+  std::array<uint8_t, 64> b{};
+
+  rng0.read(a);
+  rng1.read(b);
+  EXPECT_NE(a, b);
+
+  std::vector<uint8_t> large(csprng::RESEED_INTERVAL + 3 * csprng::csprng_t::BUFFER_LEN + 7);
+  rng0.read(large);
+  EXPECT_NE(std::count(large.begin(), large.end(), 0), static_cast<ptrdiff_t>(large.size()));
+
+  for (size_t len = 1; len < 200; len += 13) {
+    std::vector<uint8_t> bytes(len);
+    rng0.read(bytes);
+  }
+
+  rng0.read(a);
+  rng0.read(b);
+  EXPECT_NE(a, b);
+
+  // Consecutive refills, each followed by a ratchet, don't repeat.
+  std::vector<uint8_t> blk0(csprng::csprng_t::BUFFER_LEN);
+  std::vector<uint8_t> blk1(csprng::csprng_t::BUFFER_LEN);
+
+  rng1.read(blk0);
+  rng1.read(blk1);
+  EXPECT_NE(blk0, blk1);
+}
+
+// Ensure that thread-local CSPRNG of a forked child process doesn't output same
+// bytes as the one of its parent.
+TEST(Dilithium, ForkSafeCSPRNG)
+{
+  auto& rng = csprng::local();
+
+  std::array<uint8_t, 16> warm{};
+  rng.read(warm);
+
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+
+  const pid_t pid = fork();
+  ASSERT_GE(pid, 0);
+
+  if (pid == 0) {
+    std::array<uint8_t, 64> child{};
+    csprng::local().read(child);
+
+    const ssize_t n = write(fds[1], child.data(), child.size());
+    _exit(n == static_cast<ssize_t>(child.size()) ? 0 : 1);
+  }
+
+  std::array<uint8_t, 64> parent{};
+  std::array<uint8_t, 64> child{};
+  rng.read(parent);
+
+  size_t off = 0;
+  while (off < child.size()) {
+    const ssize_t n = read(fds[0], child.data() + off, child.size() - off);
+    ASSERT_GT(n, 0);
+    off += static_cast<size_t>(n);
+  }
+
+  int status = 0;
+  waitpid(pid, &status, 0);
+  close(fds[0]);
+  close(fds[1]);
+
+  EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  EXPECT_NE(parent, child);
+}
+
+// Ensure that randomized signing, with seed drawn from thread-local CSPRNG,
+// produces valid and distinct signatures.
+TEST(Dilithium, RandomizedSigningWithCSPRNG)
+{
+  using namespace dilithium3;
+
+  std::array<uint8_t, 32> seed{};
+  std::array<uint8_t, PubKeyLen> pkey{};
+  std::array<uint8_t, SecKeyLen> skey{};
+  std::array<uint8_t, SigLen> sig0{};
+  std::array<uint8_t, SigLen> sig1{};
+  std::array<uint8_t, 32> msg{};
+
+  csprng::local().read(seed);
+  csprng::local().read(msg);
+
+  keygen(seed, pkey, skey);
+
+  sign<true>(skey, msg, sig0);
+  sign<true>(skey, msg, sig1);
+
+  EXPECT_TRUE(verify(pkey, msg, sig0));
+  EXPECT_TRUE(verify(pkey, msg, sig1));
+  EXPECT_NE(sig0, sig1);
+
+  auto prepared = std::make_unique<prepared_seckey_t>();
+  prepare_seckey(skey, *prepared);
+
+  sign<true>(*prepared, msg, sig0);
+  EXPECT_TRUE(verify(pkey, msg, sig0));
+  EXPECT_NE(sig0, sig1);
+}
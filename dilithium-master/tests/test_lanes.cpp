@@ -0,0 +1,202 @@
+#include "dilithium2.hpp"
+#include "dilithium3.hpp"
+#include "keccak_xn.hpp"
+#include <gtest/gtest.h>
+#include <vector>
+
+// Ensure that each lane of multi-lane SHAKE{128, 256} Xof produces same output
+// as scalar Xof would, when lanes absorb messages of different lengths ( some
+// of them spanning multiple blocks ), split into multiple segments.
+template<size_t rate, size_t lanes, typename scalar_xof_t>
+static inline void
+test_multi_lane_xof()
+{
+  constexpr size_t olen = 3 * (rate / 8) + 5;
+
+  prng::prng_t prng;
+
+  std::array<std::vector<uint8_t>, lanes> msgs{};
+  std::array<std::array<std::span<const uint8_t>, 2>, lanes> segs{};
+
+  for (size_t j = 0; j < lanes; j++) {
+    msgs[j].resize(j * 71 + (j & 1) * (rate / 8));
+    prng.read(msgs[j]);
+
+    const size_t split = msgs[j].size() / 3;
+    segs[j] = { std::span<const uint8_t>(msgs[j]).subspan(0, split), std::span<const uint8_t>(msgs[j]).subspan(split) };
+  }
+
+  std::vector<uint8_t> out(olen * lanes);
+
+  keccak_xn::xof_t<rate, lanes> xof;
+  xof.absorb_finalize(segs);
+  xof.squeeze(std::span(out).subspan(0, 7 * lanes), 7);
+  xof.squeeze(std::span(out).subspan(7 * lanes), olen - 7);
+
+  for (size_t j = 0; j < lanes; j++) {
+    std::vector<uint8_t> expected(olen);
+
+    scalar_xof_t hasher;
+    hasher.absorb(msgs[j]);
+    hasher.finalize();
+    hasher.squeeze(expected);
+
+    std::vector<uint8_t> computed(olen);
+    std::copy_n(out.begin() + j * 7, 7, computed.begin());
+    std::copy_n(out.begin() + 7 * lanes + j * (olen - 7), olen - 7, computed.begin() + 7);
+
+    EXPECT_EQ(computed, expected);
+  }
+}
+
+TEST(Dilithium, MultiLaneShakeXof)
+{
+  test_multi_lane_xof<shake128::RATE, 1, shake128::shake128_t>();
+  test_multi_lane_xof<shake128::RATE, 4, shake128::shake128_t>();
+  test_multi_lane_xof<shake256::RATE, 5, shake256::shake256_t>();
+  test_multi_lane_xof<shake256::RATE, 8, shake256::shake256_t>();
+}
+
+// Ensure that lane-sliced verification of Dilithium2 signatures, each under a
+// distinct public key, agrees with verifying each of them separately, when
+// number of signatures isn't a multiple of lane count and some of them are
+// tampered with.
+template<size_t L>
+static inline void
+test_dilithium2_verify_lanes(thread_pool::pool_t& pool)
+{
+  constexpr size_t job_cnt = 2 * L + 3;
+  constexpr size_t mlen = 32;
+
+  std::vector<uint8_t> pubkeys(job_cnt * dilithium2::PubKeyLen);
+  std::vector<uint8_t> sigs(job_cnt * dilithium2::SigLen);
+  std::vector<std::vector<uint8_t>> msgs(job_cnt, std::vector<uint8_t>(mlen));
+  std::vector<std::span<const uint8_t>> msg_spans;
+
+  std::vector<uint8_t> expected(job_cnt);
+  std::vector<uint8_t> computed(job_cnt);
+
+  prng::prng_t prng;
+
+  for (size_t i = 0; i < job_cnt; i++) {
+    std::array<uint8_t, 32> seed{};
+    std::array<uint8_t, dilithium2::SecKeyLen> seckey{};
+
+    auto pubkey = std::span<uint8_t, dilithium2::PubKeyLen>(pubkeys.data() + i * dilithium2::PubKeyLen,
+                                                            dilithium2::PubKeyLen);
+    auto sig = std::span<uint8_t, dilithium2::SigLen>(sigs.data() + i * dilithium2::SigLen, dilithium2::SigLen);
+
+    prng.read(seed);
+    prng.read(msgs[i]);
+
+    dilithium2::keygen(seed, pubkey, seckey);
+    dilithium2::sign(seckey, msgs[i], sig, {});
+
+    if (i % 4 == 1) {
+      sig[i] ^= 0x01;
+    } else if (i % 5 == 2) {
+      msgs[i][i % mlen] ^= 0x80;
+    } else if (i % 7 == 3) {
+      sig[dilithium2::SigLen - 1] ^= 0xff;
+    }
+
+    msg_spans.push_back(msgs[i]);
+    expected[i] = dilithium2::verify(pubkey, msgs[i], sig);
+  }
+
+  dilithium_batch::verify_lanes<dilithium2::k,
+                                dilithium2::l,
+                                dilithium2::d,
+                                dilithium2::γ1,
+                                dilithium2::γ2,
+                                dilithium2::τ,
+                                dilithium2::β,
+                                dilithium2::ω,
+                                L>(pubkeys, msg_spans, sigs, computed, pool);
+
+  EXPECT_EQ(computed, expected);
+  EXPECT_TRUE(std::count(computed.begin(), computed.end(), 1) > 0);
+  EXPECT_TRUE(std::count(computed.begin(), computed.end(), 0) > 0);
+}
+
+TEST(Dilithium, LaneSlicedBatchVerification)
+{
+  thread_pool::pool_t serial(0);
+  thread_pool::pool_t parallel(2);
+
+  test_dilithium2_verify_lanes<1>(serial);
+  test_dilithium2_verify_lanes<4>(serial);
+  test_dilithium2_verify_lanes<lanes::DEFAULT_LANES>(parallel);
+
+  std::vector<uint8_t> results;
+  dilithium2::verify_lanes({}, {}, {}, results);
+  EXPECT_TRUE(results.empty());
+
+  // Lengths not matching number of messages are rejected, before touching them.
+  std::vector<uint8_t> pubkeys(dilithium2::PubKeyLen);
+  std::vector<uint8_t> sigs(dilithium2::SigLen);
+  std::vector<uint8_t> msg(32);
+  std::vector<std::span<const uint8_t>> msgs{ msg, msg };
+
+  results.resize(msgs.size());
+  EXPECT_THROW(dilithium2::verify_lanes(pubkeys, msgs, sigs, results), std::invalid_argument);
+}
+
+// Ensure that lane-sliced batch key generation produces same key pairs as
+// generating each of them separately, when number of seeds isn't a multiple of
+// lane count, both for η = 2 and η = 4.
+template<size_t k, size_t l, size_t d, uint32_t η, size_t L>
+static inline void
+test_keygen_batch(thread_pool::pool_t& pool)
+{
+  constexpr size_t seed_cnt = 2 * L + 3;
+  constexpr size_t pklen = dilithium_utils::pub_key_len<k, d>();
+  constexpr size_t sklen = dilithium_utils::sec_key_len<k, l, η, d>();
+
+  std::vector<uint8_t> seeds(seed_cnt * 32);
+  std::vector<uint8_t> pubkeys(seed_cnt * pklen);
+  std::vector<uint8_t> seckeys(seed_cnt * sklen);
+
+  prng::prng_t prng;
+  prng.read(seeds);
+
+  dilithium_batch::keygen_batch<k, l, d, η, L>(seeds, pubkeys, seckeys, pool);
+
+  for (size_t i = 0; i < seed_cnt; i++) {
+    std::array<uint8_t, pklen> pubkey{};
+    std::array<uint8_t, sklen> seckey{};
+
+    auto seed = std::span<const uint8_t, 32>(seeds.data() + i * 32, 32);
+    dilithium::keygen<k, l, d, η>(seed, pubkey, seckey);
+
+    EXPECT_TRUE(std::equal(pubkey.begin(), pubkey.end(), pubkeys.begin() + i * pklen));
+    EXPECT_TRUE(std::equal(seckey.begin(), seckey.end(), seckeys.begin() + i * sklen));
+  }
+}
+
+TEST(Dilithium, LaneSlicedBatchKeygen)
+{
+  thread_pool::pool_t serial(0);
+  thread_pool::pool_t parallel(2);
+
+  test_keygen_batch<dilithium2::k, dilithium2::l, dilithium2::d, dilithium2::η, 1>(serial);
+  test_keygen_batch<dilithium2::k, dilithium2::l, dilithium2::d, dilithium2::η, 4>(parallel);
+  test_keygen_batch<dilithium3::k, dilithium3::l, dilithium3::d, dilithium3::η, lanes::DEFAULT_LANES>(parallel);
+
+  std::array<uint8_t, 32> seed{};
+  std::array<uint8_t, dilithium3::PubKeyLen> pubkey{};
+  std::array<uint8_t, dilithium3::SecKeyLen> seckey{};
+  std::array<uint8_t, dilithium3::PubKeyLen> pubkey_{};
+  std::array<uint8_t, dilithium3::SecKeyLen> seckey_{};
+
+  dilithium3::keygen(seed, pubkey, seckey);
+  dilithium3::keygen_batch(seed, pubkey_, seckey_);
+
+  EXPECT_EQ(pubkey, pubkey_);
+  EXPECT_EQ(seckey, seckey_);
+
+  // Lengths not matching number of seeds are rejected, before touching them.
+  std::array<uint8_t, 2 * 32> seeds{};
+  EXPECT_THROW(dilithium3::keygen_batch(seeds, pubkey_, seckey_), std::invalid_argument);
+  EXPECT_THROW(dilithium3::keygen_batch(std::span(seeds).first(33), pubkey_, seckey_), std::invalid_argument);
+}
@@ -0,0 +1,232 @@
+#include "dilithium3.hpp"
+#include "gadgets.hpp"
+#include "lanes.hpp"
+#include "masking.hpp"
+#include <gtest/gtest.h>
+
+// Ensure that arithmetic shares recombine to the masked secret, before and after
+// being refreshed, and that a linear map applied share by share computes same
+// as the map applied on the secret.
+template<size_t order>
+static inline void
+test_arithmetic_masking()
+{
+  constexpr size_t n = 3 * ntt::N;
+
+  prng::prng_t prng;
+
+  std::array<field::zq_t, n> secret{};
+  std::array<field::zq_t, n> recombined{};
+  masking::random_fill<n>(secret, prng);
+
+  auto shares = std::make_unique<masking::shares_t<n, order>>();
+
+  shares->mask(secret);
+  shares->unmask(recombined);
+  EXPECT_EQ(secret, recombined);
+
+  if constexpr (order > 0) {
+    EXPECT_NE(shares->share[0], secret);
+  }
+
+  shares->refresh();
+  shares->unmask(recombined);
+  EXPECT_EQ(secret, recombined);
+
+  shares->apply([](std::span<field::zq_t, n> share) { polyvec::ntt<3>(share); });
+  shares->unmask(recombined);
+
+  polyvec::ntt<3>(secret);
+  EXPECT_EQ(secret, recombined);
+
+  // Same, with interleaved shares.
+  auto sliced = std::make_unique<masking::sliced_shares_t<n, order>>();
+
+  sliced->mask(secret);
+  sliced->unmask(recombined);
+  EXPECT_EQ(secret, recombined);
+
+  sliced->refresh();
+  sliced->unmask(recombined);
+  EXPECT_EQ(secret, recombined);
+
+  lanes::intt<3, order + 1>(sliced->data());
+  sliced->unmask(recombined);
+
+  polyvec::intt<3>(secret);
+  EXPECT_EQ(secret, recombined);
+}
+
+TEST(Dilithium, ArithmeticMasking)
+{
+  test_arithmetic_masking<0>();
+  test_arithmetic_masking<1>();
+  test_arithmetic_masking<2>();
+  test_arithmetic_masking<3>();
+}
+
+// Ensure that Boolean masking gadgets, conversions between Boolean and
+// arithmetic masking and masked SHAKE256 compute same as their unmasked
+// counterparts.
+template<size_t order>
+static inline void
+test_gadgets()
+{
+  constexpr size_t L = order + 1;
+  constexpr uint32_t α0 = (field::Q - 1) / 16;
+  constexpr uint32_t α1 = (field::Q - 1) / 44;
+
+  prng::prng_t prng;
+  gadgets::random_t<prng::prng_t> rnd(prng);
+
+  auto bmask = [&](const uint32_t v) {
+    auto res = gadgets::constant<uint32_t, L>(v);
+    gadgets::refresh(res, rnd);
+    return res;
+  };
+
+  for (size_t i = 0; i < 256; i++) {
+    // Edge cases first, then random elements of Z_q
+    const uint32_t a = i < 4 ? std::array<uint32_t, 4>{ 0, 1, α0 / 2, field::Q - 1 }[i] : rnd.next_zq();
+    const uint32_t b = rnd.next_zq();
+
+    const auto ba = bmask(a);
+    const auto bb = bmask(b);
+
+    EXPECT_EQ(gadgets::unmask(gadgets::sec_add(ba, bb, rnd)), a + b);
+    EXPECT_EQ(gadgets::unmask(gadgets::sec_add_modq(ba, bb, rnd)), (a + b) % field::Q);
+    EXPECT_EQ(gadgets::unmask(gadgets::sec_and(ba, bb, rnd)), a & b);
+
+    const auto aa = gadgets::b2a(ba, rnd);
+    EXPECT_EQ(gadgets::unmask(gadgets::a2b(aa, rnd)), a);
+
+    field::zq_t sum = field::zq_t::zero();
+    for (size_t j = 0; j < L; j++) {
+      sum += field::zq_t(aa[j]);
+    }
+    EXPECT_EQ(sum.raw(), a);
+
+    const auto h0 = gadgets::highbits<α0>(ba, rnd);
+    const auto h1 = gadgets::highbits<α1>(ba, rnd);
+    EXPECT_EQ(gadgets::unmask(h0), reduction::highbits<α0>(field::zq_t(a)).raw());
+    EXPECT_EQ(gadgets::unmask(h1), reduction::highbits<α1>(field::zq_t(a)).raw());
+
+    const uint32_t bound = b >> 1;
+    EXPECT_EQ(gadgets::unmask(gadgets::sec_lt(aa, b, bound, rnd)), ((a + b) % field::Q) < bound);
+  }
+
+  std::array<uint8_t, 64> secret{};
+  std::array<uint8_t, 64 * L> masked{};
+  std::vector<uint8_t> msg(200);
+  std::array<uint8_t, 300> digest0{};
+  std::array<uint8_t, 300 * L> digest1{};
+  std::array<uint8_t, 300> digest2{};
+
+  prng.read(secret);
+  prng.read(msg);
+  gadgets::mask_bytes<64, L>(secret, masked, rnd);
+
+  shake256::shake256_t hasher;
+  hasher.absorb(secret);
+  hasher.absorb(msg);
+  hasher.finalize();
+  hasher.squeeze(digest0);
+
+  gadgets::shake256_t<L> xof;
+  xof.template absorb_masked<64>(masked, rnd);
+  xof.absorb(msg, rnd);
+  xof.finalize(rnd);
+  xof.template squeeze<300>(digest1, rnd);
+
+  for (size_t i = 0; i < digest2.size(); i++) {
+    for (size_t j = 0; j < L; j++) {
+      digest2[i] ^= digest1[j * digest2.size() + i];
+    }
+  }
+
+  EXPECT_EQ(digest0, digest2);
+}
+
+TEST(Dilithium, MaskingGadgets)
+{
+  test_gadgets<0>();
+  test_gadgets<1>();
+  test_gadgets<2>();
+  test_gadgets<3>();
+}
+
+// Ensure that key pair doesn't depend on masking order of key generation.
+TEST(Dilithium, MaskedKeygen)
+{
+  using namespace dilithium3;
+
+  std::array<uint8_t, 32> seed{};
+  std::array<uint8_t, PubKeyLen> pkey0{};
+  std::array<uint8_t, SecKeyLen> skey0{};
+  std::array<uint8_t, PubKeyLen> pkey1{};
+  std::array<uint8_t, SecKeyLen> skey1{};
+
+  prng::prng_t prng;
+  prng.read(seed);
+
+  dilithium::keygen<k, l, d, η, 0>(seed, pkey0, skey0);
+
+  dilithium::keygen<k, l, d, η, 1>(seed, pkey1, skey1);
+  EXPECT_EQ(pkey0, pkey1);
+  EXPECT_EQ(skey0, skey1);
+
+  dilithium::keygen<k, l, d, η, 3>(seed, pkey1, skey1);
+  EXPECT_EQ(pkey0, pkey1);
+  EXPECT_EQ(skey0, skey1);
+}
+
+// Ensure that masked signing computes same signature as unmasked one, for both
+// deterministic and randomized signing, at different masking orders, signing
+// `cnt` -many random messages.
+template<size_t order>
+static inline void
+test_masked_signing(const size_t cnt)
+{
+  using namespace dilithium3;
+
+  std::array<uint8_t, 32> seed{};
+  std::array<uint8_t, 64> rnd{};
+  std::array<uint8_t, PubKeyLen> pkey{};
+  std::array<uint8_t, SecKeyLen> skey{};
+  std::array<uint8_t, SigLen> sig0{};
+  std::array<uint8_t, SigLen> sig1{};
+  std::vector<uint8_t> msg(64);
+
+  prng::prng_t prng;
+  prng.read(seed);
+
+  keygen(seed, pkey, skey);
+
+  auto masked = std::make_unique<masked_seckey_t<order>>();
+  prepare_masked_seckey<order>(skey, *masked);
+
+  for (size_t i = 0; i < cnt; i++) {
+    prng.read(msg);
+    prng.read(rnd);
+
+    sign(skey, msg, sig0, {});
+    sign(*masked, msg, sig1, {});
+    EXPECT_EQ(sig0, sig1);
+    EXPECT_TRUE(verify(pkey, msg, sig1));
+
+    sign<true>(skey, msg, sig0, rnd);
+    sign<true>(*masked, msg, sig1, rnd);
+    EXPECT_EQ(sig0, sig1);
+  }
+
+  masked->wipe();
+}
+
+TEST(Dilithium, MaskedSigning)
+{
+  // Cost of masked non-linear steps grows quadratically with order.
+  test_masked_signing<0>(4);
+  test_masked_signing<1>(4);
+  test_masked_signing<2>(2);
+  test_masked_signing<3>(1);
+}
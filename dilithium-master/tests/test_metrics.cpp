@@ -0,0 +1,128 @@
+#include "dilithium2.hpp"
+#include "dilithium3.hpp"
+#include <gtest/gtest.h>
+#include <numeric>
+#include <thread>
+
+// Returns number of events recorded between two snapshots, of a parameter set.
+static inline uint64_t
+delta(const uint64_t before, const uint64_t after)
+{
+  return after - before;
+}
+
+// Ensure that library-wide metrics account for every keygen, sign and verify
+// call, signing attempt and its rejection, verification failure by reason and
+// cache lookup, along with latency of each timed operation, including those
+// made by other threads, which have exited since. When compiled without
+// `-DDILITHIUM_METRICS` ( see `make metrics_test` ), nothing must be recorded.
+TEST(Dilithium, LibraryWideMetrics)
+{
+  using op_t = metrics::op_t;
+  using verify_fail_t = metrics::verify_fail_t;
+  using cache_t = metrics::cache_t;
+  using cache_event_t = metrics::cache_event_t;
+
+  constexpr size_t sig_cnt = 16;
+
+  std::array<uint8_t, 32> seed{};
+  std::array<uint8_t, dilithium3::PubKeyLen> pkey{};
+  std::array<uint8_t, dilithium3::SecKeyLen> skey{};
+  std::array<uint8_t, dilithium3::SigLen> sig{};
+  std::array<uint8_t, 32> msg{};
+
+  prng::prng_t prng;
+  prng.read(seed);
+
+  const auto before = dilithium3::metrics_snapshot();
+  const auto before_d2 = metrics::snapshot().of<dilithium2::k, dilithium2::l>();
+
+  dilithium3::keygen(seed, pkey, skey);
+
+  for (size_t i = 0; i < sig_cnt; i++) {
+    prng.read(msg);
+    dilithium3::sign(skey, msg, sig, {});
+  }
+
+  // Last signature is valid, then it's corrupted such that each check rejects it.
+  EXPECT_TRUE(dilithium3::verify(pkey, msg, sig));
+
+  auto bad = sig;
+  bad[0] ^= 1;
+  EXPECT_FALSE(dilithium3::verify(pkey, msg, bad));
+
+  bad = sig;
+  bad[32] = bad[33] = bad[34] = 0xff;
+  EXPECT_FALSE(dilithium3::verify(pkey, msg, bad));
+
+  bad = sig;
+  bad[dilithium3::SigLen - 1] = static_cast<uint8_t>(dilithium3::ω + 1);
+  EXPECT_FALSE(dilithium3::verify(pkey, msg, bad));
+
+  dilithium3::pubkey_cache_t cache(1ul << 20);
+  for (size_t i = 0; i < 4; i++) {
+    EXPECT_TRUE(dilithium3::verify(cache, pkey, msg, sig));
+  }
+
+  std::thread([&]() {
+    std::array<uint8_t, dilithium3::PubKeyLen> pkey_{};
+    std::array<uint8_t, dilithium3::SecKeyLen> skey_{};
+
+    dilithium3::keygen(seed, pkey_, skey_);
+  }).join();
+
+  std::vector<uint8_t> seeds(3 * 32);
+  std::vector<uint8_t> pkeys(3 * dilithium3::PubKeyLen);
+  std::vector<uint8_t> skeys(3 * dilithium3::SecKeyLen);
+
+  prng.read(seeds);
+  dilithium3::keygen_batch(seeds, pkeys, skeys);
+
+  const auto after = dilithium3::metrics_snapshot();
+  const auto after_d2 = metrics::snapshot().of<dilithium2::k, dilithium2::l>();
+
+  const uint64_t rejected = std::accumulate(after.sign_rejections.begin(), after.sign_rejections.end(), uint64_t{ 0 }) -
+                            std::accumulate(before.sign_rejections.begin(), before.sign_rejections.end(), uint64_t{ 0 });
+
+  if constexpr (metrics::ENABLED) {
+    EXPECT_EQ(delta(before.calls_of(op_t::keygen), after.calls_of(op_t::keygen)), 5ul);
+    EXPECT_EQ(delta(before.calls_of(op_t::sign), after.calls_of(op_t::sign)), sig_cnt);
+    EXPECT_EQ(delta(before.calls_of(op_t::verify), after.calls_of(op_t::verify)), 8ul);
+
+    EXPECT_EQ(delta(before.sign_attempts, after.sign_attempts), sig_cnt + rejected);
+
+    EXPECT_EQ(delta(before.failed_by(verify_fail_t::challenge), after.failed_by(verify_fail_t::challenge)), 1ul);
+    EXPECT_EQ(delta(before.failed_by(verify_fail_t::z_norm), after.failed_by(verify_fail_t::z_norm)), 1ul);
+    EXPECT_EQ(delta(before.failed_by(verify_fail_t::hint_encoding), after.failed_by(verify_fail_t::hint_encoding)),
+              1ul);
+    EXPECT_EQ(delta(before.failed_by(verify_fail_t::hint_cnt), after.failed_by(verify_fail_t::hint_cnt)), 0ul);
+
+    EXPECT_EQ(delta(before.events_of(cache_t::pubkey, cache_event_t::miss),
+                    after.events_of(cache_t::pubkey, cache_event_t::miss)),
+              1ul);
+    EXPECT_EQ(delta(before.events_of(cache_t::pubkey, cache_event_t::hit),
+                    after.events_of(cache_t::pubkey, cache_event_t::hit)),
+              3ul);
+
+    // Every call is timed once, from its public entry point, including batched
+    // keygen and verifications rejected by cheap checks.
+    EXPECT_EQ(delta(before.latency_of(op_t::keygen).count(), after.latency_of(op_t::keygen).count()), 5ul);
+    EXPECT_EQ(delta(before.latency_of(op_t::sign).count(), after.latency_of(op_t::sign).count()), sig_cnt);
+    EXPECT_EQ(delta(before.latency_of(op_t::verify).count(), after.latency_of(op_t::verify).count()), 8ul);
+    EXPECT_GT(delta(before.latency_of(op_t::sign).sum_ns, after.latency_of(op_t::sign).sum_ns), 0ul);
+    EXPECT_GT(after.latency_of(op_t::sign).quantile_ns(0.5), 0ul);
+  } else {
+    EXPECT_EQ(after.calls_of(op_t::keygen), 0ul);
+    EXPECT_EQ(after.calls_of(op_t::sign), 0ul);
+    EXPECT_EQ(after.calls_of(op_t::verify), 0ul);
+    EXPECT_EQ(after.sign_attempts, 0ul);
+    EXPECT_EQ(rejected, 0ul);
+    EXPECT_EQ(after.failed_by(verify_fail_t::challenge), 0ul);
+    EXPECT_EQ(after.events_of(cache_t::pubkey, cache_event_t::hit), 0ul);
+    EXPECT_EQ(after.latency_of(op_t::sign).count(), 0ul);
+  }
+
+  // Other parameter sets are untouched.
+  EXPECT_EQ(delta(before_d2.calls_of(op_t::keygen), after_d2.calls_of(op_t::keygen)), 0ul);
+  EXPECT_EQ(delta(before_d2.calls_of(op_t::sign), after_d2.calls_of(op_t::sign)), 0ul);
+}
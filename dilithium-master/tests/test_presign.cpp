@@ -0,0 +1,139 @@
+#include "dilithium3.hpp"
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+// Ensure that signing using prepared secret key produces same signature as
+// signing using serialized secret key.
+TEST(Dilithium, PreparedSecretKeySigning)
+{
+  std::array<uint8_t, 32> seed{};
+  std::array<uint8_t, dilithium3::PubKeyLen> pkey{};
+  std::array<uint8_t, dilithium3::SecKeyLen> skey{};
+  std::array<uint8_t, dilithium3::SigLen> sig0{};
+  std::array<uint8_t, dilithium3::SigLen> sig1{};
+  std::array<uint8_t, 47> msg{};
+
+  prng::prng_t prng;
+  prng.read(seed);
+  prng.read(msg);
+
+  dilithium3::keygen(seed, pkey, skey);
+
+  auto prepared = std::make_unique<dilithium3::prepared_seckey_t>();
+  dilithium3::prepare_seckey(skey, *prepared);
+
+  dilithium3::sign(skey, msg, sig0, {});
+  dilithium3::sign(*prepared, msg, sig1, {});
+
+  EXPECT_EQ(sig0, sig1);
+  EXPECT_TRUE(dilithium3::verify(pkey, msg, sig1));
+}
+
+// Ensure that signing and verification, reusing one caller-provided workspace
+// across many calls ( without clearing it in between ), produce same results as
+// the ones using a workspace of their own.
+TEST(Dilithium, WorkspaceReuse)
+{
+  static_assert(dilithium3::WorkspaceLen == sizeof(dilithium3::workspace_t));
+
+  std::array<uint8_t, 32> seed{};
+  std::array<uint8_t, dilithium3::PubKeyLen> pkey{};
+  std::array<uint8_t, dilithium3::SecKeyLen> skey{};
+  std::array<uint8_t, dilithium3::SigLen> sig0{};
+  std::array<uint8_t, dilithium3::SigLen> sig1{};
+  std::array<uint8_t, 33> msg{};
+
+  prng::prng_t prng;
+  prng.read(seed);
+
+  dilithium3::keygen(seed, pkey, skey);
+
+  auto prepared = std::make_unique<dilithium3::prepared_seckey_t>();
+  dilithium3::prepare_seckey(skey, *prepared);
+
+  auto pprepared = std::make_unique<dilithium3::prepared_pubkey_t>();
+  dilithium3::prepare_pubkey(pkey, *pprepared);
+
+  auto ws = std::make_unique<dilithium3::workspace_t>();
+
+  for (size_t i = 0; i < 8; i++) {
+    prng.read(msg);
+
+    dilithium3::sign(*prepared, msg, sig0, {});
+    dilithium3::sign(*prepared, msg, sig1, {}, *ws);
+    EXPECT_EQ(sig0, sig1);
+
+    EXPECT_TRUE(dilithium3::verify(*pprepared, msg, sig1, *ws));
+
+    sig1[i] ^= 0x01;
+    EXPECT_FALSE(dilithium3::verify(*pprepared, msg, sig1, *ws));
+  }
+
+  ws->wipe();
+}
+
+// Ensure that offline/ online randomized signing, using a pool of precomputed
+// commitments, produces valid signatures, when pool is kept filled by
+// background threads and concurrently drained by multiple signers, as well as
+// when there is no background thread at all.
+static inline void
+test_dilithium3_presign(const size_t thread_cnt)
+{
+  constexpr size_t signer_cnt = 3;
+  constexpr size_t sig_cnt = 8;
+
+  std::array<uint8_t, 32> seed{};
+  std::array<uint8_t, dilithium3::PubKeyLen> pkey{};
+  std::array<uint8_t, dilithium3::SecKeyLen> skey{};
+
+  prng::prng_t prng;
+  prng.read(seed);
+
+  dilithium3::keygen(seed, pkey, skey);
+
+  auto prepared = std::make_shared<dilithium3::prepared_seckey_t>();
+  dilithium3::prepare_seckey(skey, *prepared);
+
+  dilithium3::presign_pool_t pool(prepared, 16, thread_cnt);
+  if (thread_cnt > 0) {
+    pool.wait_ready(4);
+    EXPECT_GE(pool.size(), 4ul);
+  }
+
+  std::vector<std::array<uint8_t, 32>> msgs(signer_cnt * sig_cnt);
+  std::vector<std::array<uint8_t, dilithium3::SigLen>> sigs(signer_cnt * sig_cnt);
+
+  for (auto& msg : msgs) {
+    prng.read(msg);
+  }
+
+  std::vector<std::thread> signers;
+  for (size_t t = 0; t < signer_cnt; t++) {
+    signers.emplace_back([&, t]() {
+      for (size_t i = t * sig_cnt; i < (t + 1) * sig_cnt; i++) {
+        pool.sign_online(msgs[i], sigs[i]);
+      }
+    });
+  }
+
+  for (auto& t : signers) {
+    t.join();
+  }
+
+  std::array<uint8_t, dilithium3::SigLen> det_sig{};
+
+  for (size_t i = 0; i < msgs.size(); i++) {
+    EXPECT_TRUE(dilithium3::verify(pkey, msgs[i], sigs[i]));
+
+    dilithium3::sign(skey, msgs[i], det_sig, {});
+    EXPECT_NE(sigs[i], det_sig);
+  }
+}
+
+TEST(Dilithium, OfflineOnlineRandomizedSigning)
+{
+  test_dilithium3_presign(0);
+  test_dilithium3_presign(1);
+  test_dilithium3_presign(2);
+}
@@ -0,0 +1,206 @@
+#include "dilithium2.hpp"
+#include "dilithium5.hpp"
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+// Generates a Dilithium2 keypair from a fresh random seed and signs a random
+// message of mlen -bytes with it.
+static inline void
+dilithium2_keypair_and_signature(std::span<uint8_t, dilithium2::PubKeyLen> pubkey,
+                                 std::span<uint8_t> msg,
+                                 std::span<uint8_t, dilithium2::SigLen> sig)
+{
+  std::array<uint8_t, 32> seed{};
+  std::array<uint8_t, dilithium2::SecKeyLen> seckey{};
+
+  prng::prng_t prng;
+  prng.read(seed);
+  prng.read(msg);
+
+  dilithium2::keygen(seed, pubkey, seckey);
+  dilithium2::sign(seckey, msg, sig, {});
+}
+
+// Ensure that verifying signatures, while looking up prepared public keys in
+// cache, produces same result as verifying them using serialized public keys,
+// and that hit/ miss counters are accounted correctly.
+TEST(Dilithium, PreparedPublicKeyCacheVerification)
+{
+  std::array<uint8_t, dilithium2::PubKeyLen> pubkey{};
+  std::array<uint8_t, 32> msg{};
+  std::array<uint8_t, dilithium2::SigLen> sig{};
+
+  dilithium2_keypair_and_signature(pubkey, msg, sig);
+
+  dilithium2::pubkey_cache_t cache(1ul << 20);
+
+  for (size_t i = 0; i < 8; i++) {
+    EXPECT_TRUE(dilithium2::verify(cache, pubkey, msg, sig));
+  }
+
+  auto stats = cache.stats();
+  EXPECT_EQ(stats.misses, 1ul);
+  EXPECT_EQ(stats.hits, 7ul);
+  EXPECT_EQ(cache.size(), 1ul);
+
+  sig[0] ^= 1;
+  EXPECT_FALSE(dilithium2::verify(cache, pubkey, msg, sig));
+  EXPECT_FALSE(dilithium2::verify(pubkey, msg, sig));
+  sig[0] ^= 1;
+
+  dilithium2::prepared_pubkey_t prepared{};
+  dilithium2::prepare_pubkey(pubkey, prepared);
+  EXPECT_TRUE(dilithium2::verify(prepared, msg, sig));
+
+  msg[0] ^= 1;
+  EXPECT_FALSE(dilithium2::verify(prepared, msg, sig));
+}
+
+// Ensure that cache never grows beyond its memory budget and that frequently
+// used public keys are not evicted by a stream of one-off public keys.
+TEST(Dilithium, PreparedPublicKeyCacheEviction)
+{
+  constexpr size_t cnt = 6;
+
+  std::vector<std::array<uint8_t, dilithium2::PubKeyLen>> pubkeys(cnt);
+  std::vector<std::array<uint8_t, 32>> msgs(cnt);
+  std::vector<std::array<uint8_t, dilithium2::SigLen>> sigs(cnt);
+
+  for (size_t i = 0; i < cnt; i++) {
+    dilithium2_keypair_and_signature(pubkeys[i], msgs[i], sigs[i]);
+  }
+
+  // Room for exactly two prepared public keys, in a single shard.
+  dilithium2::pubkey_cache_t cache(2 * dilithium2::pubkey_cache_t::ENTRY_SIZE, 1);
+  EXPECT_EQ(cache.capacity(), 2ul);
+
+  // Make first two public keys hot.
+  for (size_t i = 0; i < 16; i++) {
+    EXPECT_TRUE(dilithium2::verify(cache, pubkeys[i & 1], msgs[i & 1], sigs[i & 1]));
+  }
+
+  // One-off public keys must not displace hot ones.
+  for (size_t i = 2; i < cnt; i++) {
+    EXPECT_TRUE(dilithium2::verify(cache, pubkeys[i], msgs[i], sigs[i]));
+    EXPECT_LE(cache.size(), cache.capacity());
+  }
+
+  const auto before = cache.stats();
+  EXPECT_TRUE(dilithium2::verify(cache, pubkeys[0], msgs[0], sigs[0]));
+  EXPECT_TRUE(dilithium2::verify(cache, pubkeys[1], msgs[1], sigs[1]));
+  const auto after = cache.stats();
+
+  EXPECT_EQ(after.hits - before.hits, 2ul);
+  EXPECT_EQ(after.misses, before.misses);
+
+  // Once a new public key becomes hotter than a resident one, it is admitted.
+  for (size_t i = 0; i < 32; i++) {
+    EXPECT_TRUE(dilithium2::verify(cache, pubkeys[2], msgs[2], sigs[2]));
+  }
+
+  EXPECT_GE(cache.stats().evictions, 1ul);
+  EXPECT_EQ(cache.size(), cache.capacity());
+}
+
+// Ensure that cache can be concurrently used from multiple threads.
+TEST(Dilithium, PreparedPublicKeyCacheConcurrentAccess)
+{
+  constexpr size_t key_cnt = 4;
+  constexpr size_t thread_cnt = 4;
+  constexpr size_t itr_cnt = 16;
+
+  std::vector<std::array<uint8_t, dilithium5::PubKeyLen>> pubkeys(key_cnt);
+  std::vector<std::array<uint8_t, 32>> msgs(key_cnt);
+  std::vector<std::array<uint8_t, dilithium5::SigLen>> sigs(key_cnt);
+
+  prng::prng_t prng;
+
+  for (size_t i = 0; i < key_cnt; i++) {
+    std::array<uint8_t, 32> seed{};
+    std::array<uint8_t, dilithium5::SecKeyLen> seckey{};
+
+    prng.read(seed);
+    prng.read(msgs[i]);
+
+    dilithium5::keygen(seed, pubkeys[i], seckey);
+    dilithium5::sign(seckey, msgs[i], sigs[i], {});
+  }
+
+  dilithium5::pubkey_cache_t cache(1ul << 22, 4);
+  std::vector<uint8_t> results(thread_cnt * itr_cnt, 0);
+  std::vector<std::thread> threads;
+
+  for (size_t t = 0; t < thread_cnt; t++) {
+    threads.emplace_back([&, t]() {
+      for (size_t i = 0; i < itr_cnt; i++) {
+        const size_t j = (t + i) % key_cnt;
+        results[t * itr_cnt + i] = dilithium5::verify(cache, pubkeys[j], msgs[j], sigs[j]);
+      }
+    });
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_TRUE(std::all_of(results.begin(), results.end(), [](auto v) { return v == 1; }));
+
+  const auto stats = cache.stats();
+  EXPECT_EQ(stats.hits + stats.misses, thread_cnt * itr_cnt);
+  EXPECT_EQ(cache.size(), key_cnt);
+}
+
+// Ensure that, once a shard holds more entries than eviction victims are
+// sampled from, hot public keys still survive a long stream of one-off ones,
+// and that prepared public keys, taken from cache, are same as the ones
+// prepared from scratch.
+TEST(Dilithium, PreparedPublicKeyCacheSampledEviction)
+{
+  constexpr size_t hot_cnt = 16;
+  constexpr size_t cold_cnt = 256;
+  constexpr size_t capacity = 64;
+
+  using cache_t = dilithium2::pubkey_cache_t;
+  using pubkey_t = std::array<uint8_t, dilithium2::PubKeyLen>;
+
+  prng::prng_t prng;
+
+  std::vector<pubkey_t> hot(hot_cnt);
+  for (auto& pk : hot) {
+    prng.read(pk);
+  }
+
+  cache_t cache(capacity * cache_t::ENTRY_SIZE, 1);
+  EXPECT_EQ(cache.capacity(), capacity);
+
+  for (size_t r = 0; r < 4; r++) {
+    for (const auto& pk : hot) {
+      cache.get(pk);
+    }
+  }
+
+  pubkey_t cold{};
+  for (size_t i = 0; i < cold_cnt; i++) {
+    prng.read(cold);
+    cache.get(cold);
+    EXPECT_LE(cache.size(), cache.capacity());
+  }
+
+  const auto before = cache.stats();
+  for (const auto& pk : hot) {
+    const auto entry = cache.get(pk);
+
+    dilithium2::prepared_pubkey_t prepared{};
+    dilithium2::prepare_pubkey(pk, prepared);
+
+    EXPECT_EQ(entry->A, prepared.A);
+    EXPECT_EQ(entry->t1, prepared.t1);
+    EXPECT_EQ(entry->tr, prepared.tr);
+  }
+  const auto after = cache.stats();
+
+  EXPECT_EQ(after.hits - before.hits, hot_cnt);
+  EXPECT_EQ(after.misses, before.misses);
+  EXPECT_EQ(cache.size(), cache.capacity());
+}
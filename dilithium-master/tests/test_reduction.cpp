@@ -56,3 +56,24 @@ TEST(Dilithium, MakingAndUsingOfHintBits)
   test_decompose<((field::Q - 1u) / 32u) << 1, 997u>();
   test_decompose<((field::Q - 1u) / 32u) << 1, 1981u>();
 }
+
+// Ensure that variable-time `use_hint` agrees with constant-time one, for each
+// element of Z_q and both values of hint bit.
+template<uint32_t alpha>
+static void
+test_use_hint_vartime()
+{
+  for (uint32_t v = 0; v < field::Q; v++) {
+    const field::zq_t r{ v };
+
+    for (const auto h : { field::zq_t::zero(), field::zq_t::one() }) {
+      EXPECT_EQ(reduction::use_hint_vartime<alpha>(h, r), reduction::use_hint<alpha>(h, r));
+    }
+  }
+}
+
+TEST(Dilithium, VariableTimeUseHint)
+{
+  test_use_hint_vartime<((field::Q - 1u) / 88u) << 1>();
+  test_use_hint_vartime<((field::Q - 1u) / 32u) << 1>();
+}
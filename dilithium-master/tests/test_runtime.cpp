@@ -0,0 +1,95 @@
+#include "prng.hpp"
+#include "runtime.hpp"
+#include <gtest/gtest.h>
+
+// Ensure that runtime dispatched key generation, signing and verification, at
+// given security level, compute same as the compile-time API of that level.
+template<typename P>
+static inline void
+test_runtime_dispatch(const dilithium::level_t lv)
+{
+  constexpr size_t pklen = dilithium_utils::pub_key_len<P::k, P::d>();
+  constexpr size_t sklen = dilithium_utils::sec_key_len<P::k, P::l, P::η, P::d>();
+  constexpr size_t siglen = dilithium_utils::sig_len<P::k, P::l, P::γ1, P::ω>();
+  constexpr size_t n = 4;
+
+  EXPECT_EQ(dilithium::pub_key_len(lv), pklen);
+  EXPECT_EQ(dilithium::sec_key_len(lv), sklen);
+  EXPECT_EQ(dilithium::sig_len(lv), siglen);
+
+  std::array<uint8_t, 32> seed{};
+  std::array<uint8_t, 64> rnd{};
+  std::vector<uint8_t> pkey(pklen);
+  std::vector<uint8_t> skey(sklen);
+  std::array<uint8_t, pklen> pkey_ct{};
+  std::array<uint8_t, sklen> skey_ct{};
+  std::array<uint8_t, siglen> sig_ct{};
+  std::vector<uint8_t> sig(siglen);
+
+  prng::prng_t prng;
+  prng.read(seed);
+  prng.read(rnd);
+
+  dilithium::keygen(lv, seed, pkey, skey);
+  dilithium::keygen<P::k, P::l, P::d, P::η>(seed, pkey_ct, skey_ct);
+  EXPECT_TRUE(std::equal(pkey.begin(), pkey.end(), pkey_ct.begin()));
+  EXPECT_TRUE(std::equal(skey.begin(), skey.end(), skey_ct.begin()));
+
+  const dilithium::signer_t signer(lv, skey);
+  const dilithium::verifier_t verifier(lv, pkey);
+
+  EXPECT_EQ(signer.level(), lv);
+  EXPECT_EQ(verifier.level(), lv);
+  EXPECT_EQ(signer.sig_len(), siglen);
+  EXPECT_EQ(verifier.sig_len(), siglen);
+
+  std::vector<std::vector<uint8_t>> msgs(n, std::vector<uint8_t>(32));
+  std::vector<std::span<const uint8_t>> msg_spans;
+  for (auto& msg : msgs) {
+    prng.read(msg);
+    msg_spans.emplace_back(msg);
+  }
+
+  signer.sign(msgs[0], sig, {});
+  dilithium::sign<P::k, P::l, P::d, P::η, P::γ1, P::γ2, P::τ, P::β, P::ω>(skey_ct, msgs[0], sig_ct, {});
+  EXPECT_TRUE(std::equal(sig.begin(), sig.end(), sig_ct.begin()));
+  EXPECT_TRUE(verifier.verify(msgs[0], sig));
+  EXPECT_FALSE(verifier.verify(msgs[1], sig));
+  EXPECT_FALSE(verifier.verify(msgs[0], std::span(sig).first(siglen - 1)));
+
+  signer.sign<true>(msgs[0], sig, rnd);
+  dilithium::sign<P::k, P::l, P::d, P::η, P::γ1, P::γ2, P::τ, P::β, P::ω, true>(skey_ct, msgs[0], sig_ct, rnd);
+  EXPECT_TRUE(std::equal(sig.begin(), sig.end(), sig_ct.begin()));
+
+  std::vector<uint8_t> sigs(n * siglen);
+  std::vector<uint8_t> results(n);
+
+  signer.sign_batch(msg_spans, sigs);
+  sigs[siglen + 7] ^= 1;
+  verifier.verify_batch(msg_spans, sigs, results);
+
+  EXPECT_EQ(results, std::vector<uint8_t>({ 1, 0, 1, 1 }));
+
+  EXPECT_THROW(dilithium::signer_t(lv, pkey), std::invalid_argument);
+  EXPECT_THROW(dilithium::verifier_t(lv, skey), std::invalid_argument);
+
+  // Buffers of wrong length are rejected, in release builds too.
+  EXPECT_THROW(dilithium::keygen(lv, seed, skey, skey), std::invalid_argument);
+  EXPECT_THROW(dilithium::keygen(lv, seed, pkey, pkey), std::invalid_argument);
+  EXPECT_THROW(signer.sign(msgs[0], std::span(sig).first(siglen - 1), {}), std::invalid_argument);
+  EXPECT_THROW(signer.sign_batch(msg_spans, std::span(sigs).first(siglen)), std::invalid_argument);
+  EXPECT_THROW(signer.sign_batch<true>(msg_spans, sigs, rnd), std::invalid_argument);
+  EXPECT_THROW(verifier.verify_batch(msg_spans, std::span(sigs).first(siglen), results), std::invalid_argument);
+  EXPECT_THROW(verifier.verify_batch(msg_spans, sigs, std::span(results).first(1)), std::invalid_argument);
+}
+
+TEST(Dilithium, RuntimeLevelDispatch)
+{
+  using dilithium::level_t;
+
+  test_runtime_dispatch<dilithium::params_t<level_t::dilithium2>>(level_t::dilithium2);
+  test_runtime_dispatch<dilithium::params_t<level_t::dilithium3>>(level_t::dilithium3);
+  test_runtime_dispatch<dilithium::params_t<level_t::dilithium5>>(level_t::dilithium5);
+
+  EXPECT_THROW(dilithium::sig_len(static_cast<level_t>(4)), std::invalid_argument);
+}
@@ -0,0 +1,64 @@
+#include "dilithium3.hpp"
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+// Ensure that secret key prepared from seed-only secret key ( directly or via
+// cache ) signs same as secret key generated by `keygen` from same seed does,
+// that public key written alongside is same, and that a seed is expanded once,
+// even when looked up concurrently.
+TEST(Dilithium, SeedOnlySecretKey)
+{
+  std::array<uint8_t, dilithium3::SeedKeyLen> seed{};
+  std::array<uint8_t, 64> rnd{};
+  std::array<uint8_t, dilithium3::PubKeyLen> pkey0{};
+  std::array<uint8_t, dilithium3::PubKeyLen> pkey1{};
+  std::array<uint8_t, dilithium3::SecKeyLen> skey{};
+  std::array<uint8_t, dilithium3::SigLen> sig0{};
+  std::array<uint8_t, dilithium3::SigLen> sig1{};
+  std::array<uint8_t, 47> msg{};
+
+  prng::prng_t prng;
+  prng.read(seed);
+  prng.read(rnd);
+  prng.read(msg);
+
+  dilithium3::keygen(seed, pkey0, skey);
+
+  auto prepared = std::make_unique<dilithium3::prepared_seckey_t>();
+  dilithium3::prepare_seckey_from_seed(seed, *prepared, pkey1);
+  EXPECT_EQ(pkey0, pkey1);
+
+  dilithium3::sign(skey, msg, sig0, {});
+  dilithium3::sign(*prepared, msg, sig1, {});
+  EXPECT_EQ(sig0, sig1);
+
+  dilithium3::seckey_cache_t cache;
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < 4; i++) {
+    threads.emplace_back([&]() { cache.get(seed); });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(cache.size(), 1ul);
+  EXPECT_EQ(cache.get(seed), cache.get(seed));
+
+  dilithium3::sign<true>(skey, msg, sig0, rnd);
+  dilithium3::sign<true>(cache, seed, msg, sig1, rnd);
+  EXPECT_EQ(sig0, sig1);
+  EXPECT_TRUE(dilithium3::verify(pkey0, msg, sig1));
+
+  seed[0] ^= 0x01;
+  dilithium3::sign(cache, seed, msg, sig1, {});
+  EXPECT_EQ(cache.size(), 2ul);
+  EXPECT_FALSE(dilithium3::verify(pkey0, msg, sig1));
+
+  cache.erase(seed);
+  EXPECT_EQ(cache.size(), 1ul);
+
+  cache.clear();
+  EXPECT_EQ(cache.size(), 0ul);
+}
@@ -0,0 +1,100 @@
+#define DILITHIUM_PROFILE_SIGN
+#include "dilithium3.hpp"
+#include <gtest/gtest.h>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+// Ensure that signing loop profiler accounts for every signing attempt, made
+// by calling thread, i.e. each one is either accepted or attributed to exactly
+// one failing bound check, while counters of other threads stay untouched.
+TEST(Dilithium, SigningLoopProfiler)
+{
+  constexpr size_t sig_cnt = 24;
+
+  std::array<uint8_t, 32> seed{};
+  std::array<uint8_t, dilithium3::PubKeyLen> pkey{};
+  std::array<uint8_t, dilithium3::SecKeyLen> skey{};
+  std::array<uint8_t, dilithium3::SigLen> sig{};
+  std::array<uint8_t, 32> msg{};
+
+  prng::prng_t prng;
+  prng.read(seed);
+
+  dilithium3::keygen(seed, pkey, skey);
+  dilithium3::reset_sign_counters();
+
+  for (size_t i = 0; i < sig_cnt; i++) {
+    prng.read(msg);
+    dilithium::sign<dilithium3::k,
+                    dilithium3::l,
+                    dilithium3::d,
+                    dilithium3::η,
+                    dilithium3::γ1,
+                    dilithium3::γ2,
+                    dilithium3::τ,
+                    dilithium3::β,
+                    dilithium3::ω>(skey, msg, sig, {});
+  }
+
+  const auto& cnt = dilithium3::sign_counters();
+
+  const uint64_t rejected = std::accumulate(cnt.rejections.begin(), cnt.rejections.end(), uint64_t{ 0 });
+  const uint64_t hist_sum = std::accumulate(cnt.attempts_hist.begin(), cnt.attempts_hist.end(), uint64_t{ 0 });
+
+  EXPECT_EQ(cnt.signatures, sig_cnt);
+  EXPECT_EQ(cnt.attempts, cnt.signatures + rejected);
+  EXPECT_EQ(hist_sum, sig_cnt);
+  EXPECT_GE(cnt.max_attempts, 1ul);
+  EXPECT_GT(cnt.rejected_by(sign_profile::reject_t::z_norm), 0ul);
+
+  std::thread([]() { EXPECT_EQ(dilithium3::sign_counters().signatures, 0ul); }).join();
+
+  dilithium3::reset_sign_counters();
+  EXPECT_EQ(dilithium3::sign_counters().attempts, 0ul);
+}
+
+// Ensure that speculative signing reports rejections of only those attempts,
+// which precede the accepted one, so that its counters match the ones of
+// signing same messages one attempt after another.
+TEST(Dilithium, SpeculativeSigningProfiler)
+{
+  constexpr size_t sig_cnt = 16;
+
+  thread_pool::pool_t pool(3);
+
+  std::array<uint8_t, 32> seed{};
+  std::array<uint8_t, dilithium3::PubKeyLen> pkey{};
+  std::array<uint8_t, dilithium3::SecKeyLen> skey{};
+  std::array<uint8_t, dilithium3::SigLen> sig{};
+  std::vector<std::array<uint8_t, 32>> msgs(sig_cnt);
+
+  prng::prng_t prng;
+  prng.read(seed);
+
+  dilithium3::keygen(seed, pkey, skey);
+  for (auto& msg : msgs) {
+    prng.read(msg);
+  }
+
+  dilithium3::reset_sign_counters();
+  for (const auto& msg : msgs) {
+    dilithium3::sign(skey, msg, sig, {});
+  }
+  const auto expected = dilithium3::sign_counters();
+
+  for (const size_t width : { 0ul, 2ul, 5ul }) {
+    dilithium3::reset_sign_counters();
+    for (const auto& msg : msgs) {
+      dilithium3::sign_speculative(skey, msg, sig, {}, pool, width);
+    }
+    const auto& cnt = dilithium3::sign_counters();
+
+    EXPECT_EQ(cnt.signatures, expected.signatures);
+    EXPECT_EQ(cnt.attempts, expected.attempts);
+    EXPECT_EQ(cnt.rejections, expected.rejections);
+    EXPECT_EQ(cnt.attempts_hist, expected.attempts_hist);
+  }
+
+  dilithium3::reset_sign_counters();
+}
@@ -88,6 +88,12 @@ test_dilithium2_signing(const size_t mlen)
   flg3 = dilithium2::verify(_pkey0, _msg1, _sig0);
 
   EXPECT_TRUE(flg0 & !flg1 & !flg2 & !flg3);
+
+  // Variable-time verification must agree with constant-time one
+  EXPECT_EQ(dilithium2::verify<true>(_pkey0, _msg0, _sig0), flg0);
+  EXPECT_EQ(dilithium2::verify<true>(_pkey0, _msg0, _sig1), flg1);
+  EXPECT_EQ(dilithium2::verify<true>(_pkey1, _msg0, _sig0), flg2);
+  EXPECT_EQ(dilithium2::verify<true>(_pkey0, _msg1, _sig0), flg3);
 }
 
 TEST(Dilithium, Dilithium2KeygenSignVerifyFlow)
@@ -156,6 +162,12 @@ test_dilithium3_signing(const size_t mlen)
   flg3 = dilithium3::verify(_pkey0, _msg1, _sig0);
 
   EXPECT_TRUE(flg0 & !flg1 & !flg2 & !flg3);
+
+  // Variable-time verification must agree with constant-time one
+  EXPECT_EQ(dilithium3::verify<true>(_pkey0, _msg0, _sig0), flg0);
+  EXPECT_EQ(dilithium3::verify<true>(_pkey0, _msg0, _sig1), flg1);
+  EXPECT_EQ(dilithium3::verify<true>(_pkey1, _msg0, _sig0), flg2);
+  EXPECT_EQ(dilithium3::verify<true>(_pkey0, _msg1, _sig0), flg3);
 }
 
 TEST(Dilithium, Dilithium3KeygenSignVerifyFlow)
@@ -224,6 +236,12 @@ test_dilithium5_signing(const size_t mlen)
   flg3 = dilithium5::verify(_pkey0, _msg1, _sig0);
 
   EXPECT_TRUE(flg0 & !flg1 & !flg2 & !flg3);
+
+  // Variable-time verification must agree with constant-time one
+  EXPECT_EQ(dilithium5::verify<true>(_pkey0, _msg0, _sig0), flg0);
+  EXPECT_EQ(dilithium5::verify<true>(_pkey0, _msg0, _sig1), flg1);
+  EXPECT_EQ(dilithium5::verify<true>(_pkey1, _msg0, _sig0), flg2);
+  EXPECT_EQ(dilithium5::verify<true>(_pkey0, _msg1, _sig0), flg3);
 }
 
 TEST(Dilithium, Dilithium5KeygenSignVerifyFlow)
@@ -232,3 +250,60 @@ TEST(Dilithium, Dilithium5KeygenSignVerifyFlow)
     test_dilithium5_signing(mlen);
   }
 }
+
+// Ensure that malformed or out-of-bound signatures are caught by cheap checks,
+// which verification runs before any expensive work, while a good signature
+// passes them.
+TEST(Dilithium, EarlyRejectionOfMalformedSignatures)
+{
+  constexpr size_t gamma1_bw = std::bit_width(dilithium3::γ1);
+  constexpr size_t zoff = 32;
+  constexpr size_t hoff = zoff + 32 * dilithium3::l * gamma1_bw;
+
+  std::array<uint8_t, 32> seed{};
+  std::array<uint8_t, dilithium3::PubKeyLen> pkey{};
+  std::array<uint8_t, dilithium3::SecKeyLen> skey{};
+  std::array<uint8_t, 32> msg{};
+  std::array<uint8_t, dilithium3::SigLen> sig{};
+
+  prng::prng_t prng;
+  prng.read(seed);
+  prng.read(msg);
+
+  dilithium3::keygen(seed, pkey, skey);
+  dilithium3::sign(skey, msg, sig, {});
+
+  std::array<field::zq_t, dilithium3::l * ntt::N> z{};
+  std::array<field::zq_t, dilithium3::k * ntt::N> h{};
+
+  auto check = [&](std::span<const uint8_t, dilithium3::SigLen> s) {
+    using namespace dilithium3;
+    return dilithium::decode_signature<k, l, γ1, β, ω>(s, z, h);
+  };
+
+  EXPECT_TRUE(check(sig));
+  EXPECT_TRUE(dilithium3::verify(pkey, msg, sig));
+
+  // Encoded coefficient 0 decodes to z = γ1, which is out of bound
+  auto sig_z = sig;
+  std::fill_n(sig_z.begin() + zoff, gamma1_bw, 0);
+
+  EXPECT_FALSE(check(sig_z));
+  EXPECT_FALSE(dilithium3::verify(pkey, msg, sig_z));
+
+  // Hint bit position counter exceeding ω, is malformed
+  auto sig_h = sig;
+  sig_h[dilithium3::SigLen - 1] = dilithium3::ω + 1;
+
+  EXPECT_FALSE(check(sig_h));
+  EXPECT_FALSE(dilithium3::verify(pkey, msg, sig_h));
+
+  // Non-zero padding after last hint bit position, is malformed
+  if (sig[dilithium3::SigLen - 1] < dilithium3::ω) {
+    auto sig_p = sig;
+    sig_p[hoff + dilithium3::ω - 1] ^= 0xff;
+
+    EXPECT_FALSE(check(sig_p));
+    EXPECT_FALSE(dilithium3::verify(pkey, msg, sig_p));
+  }
+}
@@ -0,0 +1,159 @@
+#include "dilithium3.hpp"
+#include <gtest/gtest.h>
+#include <vector>
+
+// Ensure that streaming signing and verification, with message fed in chunks of
+// varying length ( including empty ones ), agree with one-shot signing and
+// verification of whole message, both for deterministic and randomized signing.
+TEST(Dilithium, StreamingSignVerify)
+{
+  constexpr size_t mlen = 3 * shake256::RATE / 8 + 29;
+
+  std::array<uint8_t, 32> seed{};
+  std::array<uint8_t, 64> rnd{};
+  std::array<uint8_t, dilithium3::PubKeyLen> pkey{};
+  std::array<uint8_t, dilithium3::SecKeyLen> skey{};
+  std::array<uint8_t, dilithium3::SigLen> sig0{};
+  std::array<uint8_t, dilithium3::SigLen> sig1{};
+  std::vector<uint8_t> msg(mlen);
+
+  prng::prng_t prng;
+  prng.read(seed);
+  prng.read(rnd);
+  prng.read(msg);
+
+  dilithium3::keygen(seed, pkey, skey);
+
+  const auto feed = [&](auto& ctx, std::span<const uint8_t> m) {
+    size_t off = 0;
+    for (size_t clen = 0; off < m.size(); clen = (clen * 3 + 1) % 211) {
+      const size_t len = std::min(clen, m.size() - off);
+      ctx.update(m.subspan(off, len));
+      off += len;
+    }
+  };
+
+  auto sctx = std::make_unique<dilithium3::sign_ctx_t<>>();
+  sctx->init(skey);
+  feed(*sctx, msg);
+  sctx->final(sig1, {});
+
+  dilithium3::sign(skey, msg, sig0, {});
+  EXPECT_EQ(sig0, sig1);
+
+  auto rctx = std::make_unique<dilithium3::sign_ctx_t<true>>();
+  rctx->init(skey);
+  feed(*rctx, msg);
+  rctx->final(sig1, rnd);
+
+  dilithium3::sign<true>(skey, msg, sig0, rnd);
+  EXPECT_EQ(sig0, sig1);
+
+  dilithium3::verify_ctx_t<> vctx;
+  vctx.init(pkey);
+  feed(vctx, msg);
+  EXPECT_TRUE(vctx.final(sig1));
+
+  dilithium3::pubkey_cache_t cache(1ul << 20);
+  dilithium3::verify_ctx_t<true> vtctx;
+  vtctx.init(cache.get(pkey));
+  feed(vtctx, std::span<const uint8_t>(msg).subspan(0, mlen - 1));
+  EXPECT_FALSE(vtctx.final(sig1));
+
+  vtctx.init(cache.get(pkey));
+  feed(vtctx, msg);
+  EXPECT_TRUE(vtctx.final(sig1));
+
+  sig1[0] ^= 0x01;
+  vctx.init(pkey);
+  feed(vctx, msg);
+  EXPECT_FALSE(vctx.final(sig1));
+}
+
+// Ensure that signing and verification given externally computed message
+// representative μ agree with signing and verification given message itself.
+TEST(Dilithium, ExternalMuSignVerify)
+{
+  std::array<uint8_t, 32> seed{};
+  std::array<uint8_t, 64> rnd{};
+  std::array<uint8_t, 64> mu{};
+  std::array<uint8_t, dilithium3::PubKeyLen> pkey{};
+  std::array<uint8_t, dilithium3::SecKeyLen> skey{};
+  std::array<uint8_t, dilithium3::SigLen> sig0{};
+  std::array<uint8_t, dilithium3::SigLen> sig1{};
+  std::array<uint8_t, 173> msg{};
+
+  prng::prng_t prng;
+  prng.read(seed);
+  prng.read(rnd);
+  prng.read(msg);
+
+  dilithium3::keygen(seed, pkey, skey);
+  dilithium3::compute_mu(pkey, msg, mu);
+
+  auto prepared = std::make_unique<dilithium3::prepared_seckey_t>();
+  dilithium3::prepare_seckey(skey, *prepared);
+
+  dilithium3::sign(skey, msg, sig0, {});
+  dilithium3::sign_mu(skey, mu, sig1, {});
+  EXPECT_EQ(sig0, sig1);
+
+  dilithium3::sign<true>(skey, msg, sig0, rnd);
+  dilithium3::sign_mu<true>(*prepared, mu, sig1, rnd);
+  EXPECT_EQ(sig0, sig1);
+
+  auto pprepared = std::make_unique<dilithium3::prepared_pubkey_t>();
+  dilithium3::prepare_pubkey(pkey, *pprepared);
+
+  EXPECT_TRUE(dilithium3::verify_mu(pkey, mu, sig1));
+  EXPECT_TRUE(dilithium3::verify_mu<true>(*pprepared, mu, sig1));
+
+  mu[63] ^= 0x80;
+  EXPECT_FALSE(dilithium3::verify_mu(pkey, mu, sig1));
+  EXPECT_FALSE(dilithium3::verify_mu<true>(*pprepared, mu, sig1));
+}
+
+// Ensure that signing and verification of a message, provided as a sequence of
+// non-contiguous parts, agree with signing and verification of concatenated
+// message.
+TEST(Dilithium, ScatterGatherSignVerify)
+{
+  std::array<uint8_t, 32> seed{};
+  std::array<uint8_t, dilithium3::PubKeyLen> pkey{};
+  std::array<uint8_t, dilithium3::SecKeyLen> skey{};
+  std::array<uint8_t, dilithium3::SigLen> sig0{};
+  std::array<uint8_t, dilithium3::SigLen> sig1{};
+
+  std::array<uint8_t, 16> header{};
+  std::vector<uint8_t> payload(shake256::RATE / 8 + 3);
+  std::array<uint8_t, 8> trailer{};
+
+  prng::prng_t prng;
+  prng.read(seed);
+  prng.read(header);
+  prng.read(payload);
+  prng.read(trailer);
+
+  dilithium3::keygen(seed, pkey, skey);
+
+  std::vector<uint8_t> msg;
+  msg.insert(msg.end(), header.begin(), header.end());
+  msg.insert(msg.end(), payload.begin(), payload.end());
+  msg.insert(msg.end(), trailer.begin(), trailer.end());
+
+  const std::array<std::span<const uint8_t>, 4> parts{ header, payload, std::span<const uint8_t>{}, trailer };
+
+  dilithium3::sign(skey, msg, sig0, {});
+  dilithium3::sign(skey, parts, sig1, {});
+  EXPECT_EQ(sig0, sig1);
+
+  auto prepared = std::make_unique<dilithium3::prepared_pubkey_t>();
+  dilithium3::prepare_pubkey(pkey, *prepared);
+
+  EXPECT_TRUE(dilithium3::verify(pkey, parts, sig1));
+  EXPECT_TRUE(dilithium3::verify<true>(*prepared, parts, sig1));
+
+  payload[0] ^= 0x01;
+  EXPECT_FALSE(dilithium3::verify(pkey, parts, sig1));
+  EXPECT_FALSE(dilithium3::verify<true>(*prepared, parts, sig1));
+}